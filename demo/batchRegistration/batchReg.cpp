@@ -0,0 +1,237 @@
+/*!
+ *    \file  batchReg.cpp
+ *   \brief  App to demo registration of many swipes across a thread pool
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ */
+
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+//POSIX
+#include <dirent.h>
+#include <sys/stat.h>
+
+//Eigen
+#include <Eigen/Core>
+
+//fpTools
+#include <fpTools_utility/pgmIO.h>
+#include <fpTools_utility/pgmMap.h>
+#include <fpTools_utility/captureReader.h>
+#include <fpTools/batchRegistration.h>
+
+/*!
+ *  \brief  List the PGM files of a directory, sorted by name
+ *
+ *  \param  dirPath std::string The directory
+ *  \param[out] files std::vector<std::string> Paths of the PGM files
+ */
+static void listPGM(const std::string &dirPath, std::vector<std::string> &files)
+{
+	DIR *dir = opendir(dirPath.c_str());
+	if( dir == NULL ) return;
+
+	struct dirent *entry;
+	while( (entry = readdir(dir)) != NULL )
+	{
+		std::string name(entry->d_name);
+		if( name.size() > 4 && name.compare(name.size() - 4, 4, ".pgm") == 0 )
+		{
+			files.push_back(dirPath + "/" + name);
+		}
+	}
+	closedir(dir);
+
+	std::sort(files.begin(), files.end());
+}
+
+/*!
+ *  \brief  App to demo batch line scan registration
+ *
+ *  \param  argv Options -threads N, -phase, -pyramid N, -maxShift N and -engine fft|direct,
+ *  		as for demoReg, then the output directory,
+ *  		then input PGMs or a directory of them
+ */
+int main ( int argc, char *argv[] )
+{
+	//Define
+	int lengthOfScan = 8; //Defined by scanner hardware
+	int numThreads = 0;
+	bool phase = false;
+	int pyramidLevels = 0;
+	int maxShift = 0;
+	fpTools::registrationEngine engine = fpTools::ENGINE_AUTO;
+
+	//Options
+	int arg = 1;
+	while( arg < argc && argv[arg][0] == '-' )
+	{
+		if( std::strcmp(argv[arg], "-threads") == 0 && arg + 1 < argc ) numThreads = std::atoi(argv[++arg]);
+		if( std::strcmp(argv[arg], "-phase") == 0 ) phase = true;
+		if( std::strcmp(argv[arg], "-pyramid") == 0 && arg + 1 < argc ) pyramidLevels = std::atoi(argv[++arg]);
+		if( std::strcmp(argv[arg], "-maxShift") == 0 && arg + 1 < argc ) maxShift = std::atoi(argv[++arg]);
+		if( std::strcmp(argv[arg], "-engine") == 0 && arg + 1 < argc )
+		{
+			arg++;
+			if( std::strcmp(argv[arg], "fft") == 0 ) engine = fpTools::ENGINE_FFT;
+			if( std::strcmp(argv[arg], "direct") == 0 ) engine = fpTools::ENGINE_DIRECT;
+		}
+		arg++;
+	}
+
+	if( argc - arg < 2 )
+	{
+		std::fprintf(stderr, "Usage: %s [-threads N] [-phase] [-pyramid N] [-maxShift N] [-engine fft|direct] outputDir input.pgm|input.fpc... | inputDir\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	std::string outDir(argv[arg++]);
+
+	//Gather inputs, every capture of a container is an input of its own
+	std::vector<std::string> files;
+	std::vector<int> captures;
+	for(; arg < argc; arg++)
+	{
+		struct stat info;
+		std::string path(argv[arg]);
+		if( stat(argv[arg], &info) == 0 && S_ISDIR(info.st_mode) )
+		{
+			listPGM(path, files);
+		}else if( path.size() > 4 && path.compare(path.size() - 4, 4, ".fpc") == 0 )
+		{
+			fpTools::captureReader container(argv[arg]);
+			for(int c = 0; c < container.numCaptures(); c++)
+			{
+				files.push_back(path);
+				captures.resize(files.size(), -1);
+				captures.back() = c;
+			}
+		}else
+		{
+			files.push_back(path);
+		}
+	}
+	captures.resize(files.size(), -1);
+
+	//Create registration engine
+	fpTools::batchRegistration reg(lengthOfScan, numThreads);
+	reg.setPhaseCorrelation(phase);
+	reg.setPyramidLevels(pyramidLevels);
+	reg.setMaxShift(maxShift);
+	reg.setEngine(engine);
+
+	//Work through the files a few batches per worker at a time to bound memory
+	size_t chunk = 4*reg.getNumThreads();
+	size_t failed = 0;
+	double seconds = 0;
+
+	//Swipes keep the type they are stored in, 8-bit PGMs apart from 16-bit ones and captures
+	std::vector<fpTools::image8u> images8;
+	std::vector<fpTools::image16u> images16;
+	std::vector<size_t> slot;
+	std::vector<char> wide;
+	std::vector<bool> success8, success16;
+	for(size_t start = 0; start < files.size(); start += chunk)
+	{
+		size_t stop = std::min(files.size(), start + chunk);
+
+		//Copy the pixels straight from the mapped files, without widening them. Captures of
+		//one container are listed together, so each container is opened once a chunk
+		fpTools::captureReader container;
+		std::string containerPath;
+		images8.clear();
+		images16.clear();
+		slot.resize(stop - start);
+		wide.resize(stop - start);
+		for(size_t i = start; i < stop; i++)
+		{
+			if( captures[i] >= 0 )
+			{
+				if( files[i] != containerPath )
+				{
+					container.open(files[i].c_str());
+					containerPath = files[i];
+				}
+				wide[i - start] = (container.getCapture(captures[i]).bitDepth > 8);
+				if( wide[i - start] )
+				{
+					images16.push_back(fpTools::image16u());
+					container.readCapture(captures[i], images16.back());
+					slot[i - start] = images16.size() - 1;
+				}else
+				{
+					images8.push_back(fpTools::image8u());
+					container.readCapture(captures[i], images8.back());
+					slot[i - start] = images8.size() - 1;
+				}
+				continue;
+			}
+
+			fpTools::pgmMap map(files[i].c_str());
+			if( map.bytesPerPixel() == 1 )
+			{
+				images8.push_back(map.image8());
+				slot[i - start] = images8.size() - 1;
+				wide[i - start] = 0;
+			}else
+			{
+				images16.push_back(map.image16());
+				slot[i - start] = images16.size() - 1;
+				wide[i - start] = 1;
+			}
+		}
+
+		//Do registration
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		reg.registerBatch(images8, success8);
+		reg.registerBatch(images16, success16);
+		seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		//Write images
+		for(size_t i = start; i < stop; i++)
+		{
+			size_t k = slot[i - start];
+			if( !(wide[i - start] ? success16[k] : success8[k]) )
+			{
+				std::fprintf(stderr, "Failed to register %s\n", files[i].c_str());
+				failed++;
+				continue;
+			}
+
+			std::string name = files[i].substr(files[i].find_last_of('/') + 1);
+			if( captures[i] >= 0 )
+			{
+				//Name after the container and capture
+				char suffix[32];
+				std::snprintf(suffix, sizeof(suffix), "_%d.pgm", captures[i]);
+				name = name.substr(0, name.size() - 4) + suffix;
+			}
+			std::string outPath = outDir + "/" + name;
+			fpTools::pgmIO imgIO(outPath.c_str());
+			if( wide[i - start] )
+			{
+				imgIO.write(images16[k]);
+			}else
+			{
+				imgIO.write(images8[k]);
+			}
+		}
+	}
+
+	std::printf("Registered %zu of %zu swipes on %d threads, %.1f swipes/s\n",
+			files.size() - failed, files.size(), reg.getNumThreads(),
+			(seconds > 0) ? files.size()/seconds : 0.0);
+
+	return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}				/* ----------  end of function main  ---------- */
@@ -0,0 +1,133 @@
+/*!
+ *    \file  demoPack.cpp
+ *   \brief  App to demo packing swipes into a capture container
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ */
+
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+//Eigen
+#include <Eigen/Core>
+
+//fpTools
+#include <fpTools_utility/pgmIO.h>
+#include <fpTools_utility/pgmMap.h>
+#include <fpTools_utility/captureWriter.h>
+#include <fpTools_utility/captureReader.h>
+
+/*!
+ *  \brief  Write every capture of a container as a PGM
+ *
+ *  \param  inPath const char* The container
+ *  \param  outDir const char* The output directory
+ *
+ *  \return int Exit status
+ */
+static int unpack(const char *inPath, const char *outDir)
+{
+	fpTools::captureReader reader(inPath);
+	if( !reader.isOpen() ) return EXIT_FAILURE;
+
+	fpTools::image16u image;
+	for(int c = 0; c < reader.numCaptures(); c++)
+	{
+		if( !reader.readCapture(c, image, 0) ) return EXIT_FAILURE;
+
+		char name[32];
+		std::snprintf(name, sizeof(name), "/capture_%d.pgm", c);
+		std::string outPath = std::string(outDir) + name;
+		fpTools::pgmIO imgIO(outPath.c_str());
+
+		//Keep 8-bit captures 8-bit
+		bool ok;
+		if( reader.getCapture(c).bitDepth == 8 )
+		{
+			ok = imgIO.write(fpTools::image8u(image.cast<uint8_t>()));
+		}else
+		{
+			ok = imgIO.write(image);
+		}
+		if( !ok ) return EXIT_FAILURE;
+	}
+
+	std::printf("Unpacked %d captures\n", reader.numCaptures());
+	return EXIT_SUCCESS;
+}
+
+/*!
+ *  \brief  App to demo the capture container
+ *
+ *  \param  argv Option -raw, then the output container and the input PGMs,
+ *  		or -unpack, the input container and the output directory
+ */
+int main ( int argc, char *argv[] )
+{
+	//Define
+	int lengthOfScan = 8; //Defined by scanner hardware
+	bool compress = true;
+
+	int arg = 1;
+	if( arg < argc && std::strcmp(argv[arg], "-unpack") == 0 )
+	{
+		if( argc != 4 )
+		{
+			std::fprintf(stderr, "Usage: %s -unpack input.fpc outputDir\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		return unpack(argv[2], argv[3]);
+	}
+	if( arg < argc && std::strcmp(argv[arg], "-raw") == 0 )
+	{
+		compress = false;
+		arg++;
+	}
+
+	if( argc - arg < 2 )
+	{
+		std::fprintf(stderr, "Usage: %s [-raw] output.fpc input.pgm...\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	fpTools::captureWriter writer(argv[arg++], compress);
+	if( !writer.isOpen() ) return EXIT_FAILURE;
+
+	//One capture per PGM
+	size_t pgmBytes = 0;
+	for(; arg < argc; arg++)
+	{
+		fpTools::pgmMap map(argv[arg]);
+		bool ok = map.isOpen();
+		if( ok && map.bytesPerPixel() == 1 )
+		{
+			ok = writer.addCapture(fpTools::image8u(map.image8()), lengthOfScan);
+		}else if( ok )
+		{
+			ok = writer.addCapture(fpTools::image16u(map.image16()), lengthOfScan);
+		}
+
+		if( !ok )
+		{
+			std::fprintf(stderr, "Failed to pack %s\n", argv[arg]);
+			continue;
+		}
+		pgmBytes += static_cast<size_t>(map.rows())*map.cols()*map.bytesPerPixel();
+	}
+
+	int captures = writer.numCaptures();
+	if( !writer.close() ) return EXIT_FAILURE;
+
+	std::printf("Packed %d captures, %zu bytes of pixels into %llu bytes\n",
+			captures, pgmBytes, static_cast<unsigned long long>(writer.bytesWritten()));
+
+	return EXIT_SUCCESS;
+}				/* ----------  end of function main  ---------- */
@@ -10,36 +10,246 @@
  *      Compiler:  gcc
  */
 
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+
 //Eigen
 #include <Eigen/Core>
 
 //fpTools
 #include <fpTools_utility/pgmIO.h>
+#include <fpTools_utility/pgmMap.h>
+#include <fpTools_utility/pgmBandReader.h>
+#include <fpTools_utility/pgmBandWriter.h>
+#include <fpTools_utility/ioPipeline.h>
 #include <fpTools/lineRegistration.h>
+#include <fpTools/lineRegistrationStream.h>
+
+/*!
+ *  \brief  Load a PGM of any bit depth as ints
+ *
+ *  \param  path std::string The PGM
+ *  \param[out] image Eigen::MatrixXi The image
+ *
+ *  \return bool True on success
+ */
+static bool loadImage(const std::string &path, Eigen::MatrixXi &image)
+{
+	fpTools::pgmMap map(path.c_str());
+	if( !map.isOpen() ) return false;
+
+	if( map.bytesPerPixel() == 1 )
+	{
+		image = map.image8().cast<int>();
+	}else
+	{
+		image = map.image16().cast<int>();
+	}
+	return true;
+}
+
+/*!
+ *  \brief  Load an 8-bit PGM
+ *
+ *  \param  path std::string The PGM
+ *  \param[out] image fpTools::image8u The image
+ *
+ *  \return bool True on success, false for 16-bit files
+ */
+static bool loadImage(const std::string &path, fpTools::image8u &image)
+{
+	fpTools::pgmMap map(path.c_str());
+	if( !map.isOpen() || map.bytesPerPixel() != 1 ) return false;
+
+	image = map.image8();
+	return true;
+}
+
+/*!
+ *  \brief  Register many files, reading and writing on other threads while registering
+ *
+ *  \param  reg fpTools::lineRegistration The configured registration
+ *  \param  outDir std::string Directory to write registered files to, under the input names
+ *  \param  inputs std::vector<std::string> The input files
+ *
+ *  \return int Exit status
+ */
+template<typename Image>
+static int registerFiles(fpTools::lineRegistration &reg, const std::string &outDir,
+		const std::vector<std::string> &inputs)
+{
+	fpTools::ioPipeline<Image, Image> pipeline;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	int done = pipeline.run(static_cast<int>(inputs.size()),
+		[&](int i, Image &image)
+		{
+			if( loadImage(inputs[i], image) ) return true;
+			std::fprintf(stderr, "Failed to read %s\n", inputs[i].c_str());
+			return false;
+		},
+		[&](int i, Image &image, Image &registered)
+		{
+			//Hand the buffer to the writer, the old output comes back to be read into
+			if( !reg.registerLines(image) )
+			{
+				std::fprintf(stderr, "Failed to register %s\n", inputs[i].c_str());
+				return false;
+			}
+			registered.swap(image);
+			return true;
+		},
+		[&](int i, Image &registered)
+		{
+			std::string outPath = outDir + "/" + inputs[i].substr(inputs[i].find_last_of('/') + 1);
+			fpTools::pgmIO imgIO(outPath.c_str());
+			return imgIO.write(registered);
+		});
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	std::printf("Registered %d of %zu files, %.1f files/s\n", done, inputs.size(),
+			(seconds > 0) ? inputs.size()/seconds : 0.0);
+
+	return (done == static_cast<int>(inputs.size())) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
 /*!
  *  \brief  App to demo line scan registration
  *  
  *  \param  argv[1] Path to unregistered scans
  *  \param  argv[2] Path to write registered scans
- *
+ *  \param  argv[3...] Optional -stream to push the scanlines one at a time,
+ *  		-threads N to register with N threads (0 for all cores),
+ *  		-phase for sub-pixel phase correlation,
+ *  		-pyramid N for N coarse-to-fine levels, -maxShift N to bound the shift in X,
+ *  		-engine fft|direct|auto to pick how the shift is searched,
+ *  		-compact to register the image as 8-bit row-major
+ *  		Or -files, the output directory, then the input PGMs and the options,
+ *  		to register many files with reads and writes overlapped
  */
 int main ( int argc, char *argv[] )
 {
 	//Define
 	int lengthOfScan = 8; //Defined by scanner hardware
 	Eigen::MatrixXi testImage;
+	bool stream = false;
+	bool phase = false;
+	bool compact = false;
+	int pyramidLevels = 0;
+	int maxShift = 0;
+	int numThreads = 1;
+	fpTools::registrationEngine engine = fpTools::ENGINE_AUTO;
+	bool files = (argc > 2 && std::strcmp(argv[1], "-files") == 0);
+	std::vector<std::string> inputs;
+
+	//Options, anything else after the first two arguments is an input file
+	for(int i = 3; i < argc; i++)
+	{
+		if( std::strcmp(argv[i], "-stream") == 0 ) stream = true;
+		else if( std::strcmp(argv[i], "-phase") == 0 ) phase = true;
+		else if( std::strcmp(argv[i], "-compact") == 0 ) compact = true;
+		else if( std::strcmp(argv[i], "-pyramid") == 0 && i + 1 < argc ) pyramidLevels = std::atoi(argv[++i]);
+		else if( std::strcmp(argv[i], "-maxShift") == 0 && i + 1 < argc ) maxShift = std::atoi(argv[++i]);
+		else if( std::strcmp(argv[i], "-threads") == 0 && i + 1 < argc ) numThreads = std::atoi(argv[++i]);
+		else if( std::strcmp(argv[i], "-engine") == 0 && i + 1 < argc )
+		{
+			i++;
+			if( std::strcmp(argv[i], "fft") == 0 ) engine = fpTools::ENGINE_FFT;
+			if( std::strcmp(argv[i], "direct") == 0 ) engine = fpTools::ENGINE_DIRECT;
+		}
+		else inputs.push_back(argv[i]);
+	}
+
+	if( files )
+	{
+		//Whole images only, one registered while the next is read and the last written
+		fpTools::lineRegistration reg(lengthOfScan);
+		reg.setNumThreads(numThreads);
+		reg.setPhaseCorrelation(phase);
+		reg.setPyramidLevels(pyramidLevels);
+		reg.setMaxShift(maxShift);
+		reg.setEngine(engine);
+
+		if( compact ) return registerFiles<fpTools::image8u>(reg, argv[2], inputs);
+		return registerFiles<Eigen::MatrixXi>(reg, argv[2], inputs);
+	}
+
+	if( stream )
+	{
+		//Read a scanline at a time and write rows as they are registered
+		fpTools::pgmBandReader reader(argv[1]);
+		if( !reader.isOpen() ) return EXIT_FAILURE;
+
+		int maxDriftX = 64;
+		fpTools::lineRegistrationStream reg(lengthOfScan, reader.cols(), maxDriftX);
+		reg.setPhaseCorrelation(phase);
+		reg.setPyramidLevels(pyramidLevels);
+		reg.setMaxShift(maxShift);
+		reg.setEngine(engine);
+
+		//Rows are counted as they are written
+		fpTools::pgmBandWriter writer(argv[2], reg.getOutputCols(), 0, (reader.getMaxVal() > 255) ? 65535 : 255);
+		if( !writer.isOpen() ) return EXIT_FAILURE;
+
+		fpTools::image16u band;
+		Eigen::MatrixXi scan;
+		Eigen::RowVectorXi row;
+		for(int i = 0; i + lengthOfScan <= reader.rows(); i += lengthOfScan)
+		{
+			//Push line as it comes off the scanner
+			if( !reader.readBand(i, lengthOfScan, band) ) return EXIT_FAILURE;
+			scan = band.cast<int>();
+			reg.pushScanline(scan);
+
+			//Write finished rows
+			while( reg.popRow(row) ) writer.appendBand(fpTools::image16u(row.cast<uint16_t>()));
+		}
+		reg.finish();
+		while( reg.popRow(row) ) writer.appendBand(fpTools::image16u(row.cast<uint16_t>()));
+
+		return writer.close() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 
 	//Create IO
 	fpTools::pgmIO imgIO(argv[1]);
 
+	if( compact )
+	{
+		//Register at the bit depth of the scanner
+		fpTools::image8u compactImage;
+		if( !imgIO.read(compactImage) ) return EXIT_FAILURE;
+
+		fpTools::lineRegistration reg(lengthOfScan);
+		reg.setNumThreads(numThreads);
+		reg.setPhaseCorrelation(phase);
+		reg.setPyramidLevels(pyramidLevels);
+		reg.setMaxShift(maxShift);
+		reg.setEngine(engine);
+		if( !reg.registerLines(compactImage) ) return EXIT_FAILURE;
+
+		imgIO.setFN(argv[2]);
+		return imgIO.write(compactImage) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	//Read test image
 	imgIO.read(testImage);
 
 	//Do registration
 	fpTools::lineRegistration reg(lengthOfScan);
+	reg.setNumThreads(numThreads);
+	reg.setPhaseCorrelation(phase);
+	reg.setPyramidLevels(pyramidLevels);
+	reg.setMaxShift(maxShift);
+	reg.setEngine(engine);
 	reg.registerLines(testImage);
 
+	std::printf("Engine: %s\n", (reg.getLastEngine() == fpTools::ENGINE_DIRECT) ? "direct" : "fft");
+
 	//Write test image
 	imgIO.setFN(argv[2]);
 	imgIO.write(testImage);
@@ -10,32 +10,190 @@
  *      Compiler:  gcc
  */
 
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+
 //Eigen
 #include <Eigen/Core>
 
 //fpTools
 #include <fpTools_utility/pgmIO.h>
+#include <fpTools_utility/pgmBandReader.h>
+#include <fpTools_utility/pgmBandWriter.h>
+#include <fpTools_utility/ioPipeline.h>
 #include <fpTools/minutiaeExtraction.h>
+#include <fpTools/ridgeEnhancement.h>
+
+/*!
+ *  \brief  Binarize many files, reading and writing on other threads while binarizing
+ *
+ *  \param  extract fpTools::minutiaeExtraction The extraction
+ *  \param  enhancer fpTools::ridgeEnhancement Enhancement to run before binarizing, NULL for none
+ *  \param  outDir std::string Directory to write binarized files to, under the input names
+ *  \param  inputs std::vector<std::string> The input files
+ *  \param  thin bool True to thin the ridges after binarizing
+ *
+ *  \return int Exit status
+ */
+static int binarizeFiles(fpTools::minutiaeExtraction &extract, fpTools::ridgeEnhancement *enhancer,
+		const std::string &outDir,
+		const std::vector<std::string> &inputs, bool thin)
+{
+	fpTools::ioPipeline<fpTools::image8u, fpTools::bitImage> pipeline;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	int done = pipeline.run(static_cast<int>(inputs.size()),
+		[&](int i, fpTools::image8u &image)
+		{
+			fpTools::pgmIO imgIO(inputs[i].c_str());
+			return imgIO.read(image);
+		},
+		[&](int, fpTools::image8u &image, fpTools::bitImage &binary)
+		{
+			//Packed from the threshold on, unpacked only by the writer
+			if( enhancer != NULL && !enhancer->enhance(image) ) return false;
+			extract.binarize(image, binary);
+			if( thin ) extract.thin(binary);
+			return true;
+		},
+		[&](int i, fpTools::bitImage &binary)
+		{
+			std::string outPath = outDir + "/" + inputs[i].substr(inputs[i].find_last_of('/') + 1);
+			fpTools::pgmIO imgIO(outPath.c_str());
+			return imgIO.write(binary);
+		});
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	std::printf("Binarized %d of %zu files, %.1f files/s\n", done, inputs.size(),
+			(seconds > 0) ? inputs.size()/seconds : 0.0);
+
+	return (done == static_cast<int>(inputs.size())) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
 /*!
  *  \brief  App to demo minutiae extraction
  *  
  *  \param  argv[1] Path to scan
  *  \param  argv[2] Output pgm path for demo
+ *  \param  argv[3...] Optional -band N to binarize N rows at a time,
+ *  		-threads N to binarize with N threads (0 for all cores),
+ *  		-local niblack|sauvola to threshold each pixel by its surroundings,
+ *  		-window N for the side of the local window,
+ *  		-enhance to filter the ridges with Gabor filters before binarizing,
+ *  		-thin to thin the ridges to one pixel wide,
+ *  		-minutiae path to thin and write the minutiae found as text
+ *  		Or -files, the output directory, then the input PGMs
  */
 int main ( int argc, char *argv[] )
 {
+	//Options, anything else after the first two arguments is an input file
+	int bandRows = 0;
+	int numThreads = 1;
+	int windowSize = 0;
+	bool thin = false;
+	bool enhance = false;
+	const char *minutiaePath = NULL;
+	fpTools::thresholdMethod method = fpTools::THRESH_OTSU;
+	bool files = (argc > 2 && std::strcmp(argv[1], "-files") == 0);
+	std::vector<std::string> inputs;
+	for(int i = 3; i < argc; i++)
+	{
+		if( std::strcmp(argv[i], "-band") == 0 && i + 1 < argc ) bandRows = std::atoi(argv[++i]);
+		else if( std::strcmp(argv[i], "-threads") == 0 && i + 1 < argc ) numThreads = std::atoi(argv[++i]);
+		else if( std::strcmp(argv[i], "-thin") == 0 ) thin = true;
+		else if( std::strcmp(argv[i], "-enhance") == 0 ) enhance = true;
+		else if( std::strcmp(argv[i], "-minutiae") == 0 && i + 1 < argc ) minutiaePath = argv[++i];
+		else if( std::strcmp(argv[i], "-window") == 0 && i + 1 < argc ) windowSize = std::atoi(argv[++i]);
+		else if( std::strcmp(argv[i], "-local") == 0 && i + 1 < argc )
+		{
+			i++;
+			if( std::strcmp(argv[i], "niblack") == 0 ) method = fpTools::THRESH_NIBLACK;
+			if( std::strcmp(argv[i], "sauvola") == 0 ) method = fpTools::THRESH_SAUVOLA;
+		}
+		else inputs.push_back(argv[i]);
+	}
+
+	fpTools::minutiaeExtraction extract;
+	extract.setNumThreads(numThreads);
+	extract.setThresholdMethod(method);
+	if( windowSize > 0 ) extract.setWindowSize(windowSize);
+
+	fpTools::ridgeEnhancement enhancer;
+	enhancer.setNumThreads(numThreads);
+
+	if( files ) return binarizeFiles(extract, enhance ? &enhancer : NULL, argv[2], inputs, thin);
+
+	if( bandRows > 0 )
+	{
+		//Only one band is held in memory, one pass for the histogram and one to threshold.
+		//The threshold is always global and the ridges are not enhanced or thinned
+		fpTools::pgmBandReader reader(argv[1]);
+		if( !reader.isOpen() ) return EXIT_FAILURE;
+
+		fpTools::image8u band;
+		std::vector<int> hist;
+		for(int row = 0; row < reader.rows(); row += bandRows)
+		{
+			if( !reader.readBand(row, bandRows, band) ) return EXIT_FAILURE;
+			extract.accumulateHistogram(band, hist);
+		}
+		int thresh = extract.otsuThreshold(hist);
+
+		fpTools::pgmBandWriter writer(argv[2], reader.cols(), reader.rows());
+		for(int row = 0; row < reader.rows(); row += bandRows)
+		{
+			if( !reader.readBand(row, bandRows, band) ) return EXIT_FAILURE;
+			extract.applyThreshold(band, thresh);
+			if( !writer.appendBand(band) ) return EXIT_FAILURE;
+		}
+
+		return writer.close() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	//Create IO
 	fpTools::pgmIO imgIO(argv[1]);
 
 	//Read image
-	Eigen::MatrixXi testImage;
-	imgIO.read(testImage);
+	fpTools::image8u testImage;
+	if( !imgIO.read(testImage) ) return EXIT_FAILURE;
+	if( enhance && !enhancer.enhance(testImage) ) return EXIT_FAILURE;
 
-	//Do binarization
-	fpTools::minutiaeExtraction extract;
+	if( minutiaePath != NULL )
+	{
+		//Binarize, thin and detect, the skeleton is written as the image
+		fpTools::minutiaeSet minutiae;
+		extract.extractMinutiae(testImage, minutiae);
+
+		FILE *list = std::fopen(minutiaePath, "w");
+		if( list == NULL )
+		{
+			std::fprintf(stderr, "Cannot open file to write %s\n", minutiaePath);
+			return EXIT_FAILURE;
+		}
+		std::fprintf(list, "#x y angle type quality\n");
+		for(int k = 0; k < minutiae.size(); k++)
+		{
+			std::fprintf(list, "%d %d %.3f %d %d\n", minutiae.x()[k], minutiae.y()[k], minutiae.angle()[k],
+					minutiae.type()[k], minutiae.quality()[k]);
+		}
+		std::fclose(list);
 
-	extract.binarize(testImage);
+		std::printf("Found %d minutiae\n", minutiae.size());
+	}else
+	{
+		//Do binarization, the ridges stay packed until written
+		fpTools::bitImage ridges;
+		extract.binarize(testImage, ridges);
+		if( thin ) extract.thin(ridges);
+
+		imgIO.setFN(argv[2]);
+		return imgIO.write(ridges) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 
 	//Write test image
 	imgIO.setFN(argv[2]);
@@ -43,4 +201,3 @@ int main ( int argc, char *argv[] )
 
 	return EXIT_SUCCESS;
 }				/* ----------  end of function main  ---------- */
-
@@ -0,0 +1,341 @@
+/*!
+ *    \file  demoMatch.cpp
+ *   \brief  Demo app to show 1:N matching of minutiae templates
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ */
+
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <chrono>
+
+//POSIX
+#include <unistd.h>
+
+//fpTools
+#include <fpTools/minutiaeSet.h>
+#include <fpTools/cylinderTemplate.h>
+#include <fpTools/minutiaeMatcher.h>
+#include <fpTools/templateGallery.h>
+
+/*!
+ *  \brief  Read minutiae written by demoExtract -minutiae
+ *
+ *  \param  path const char* The text file, one "x y angle type quality" per line
+ *  \param[out] minutiae fpTools::minutiaeSet The minutiae
+ *
+ *  \return bool False if the file cannot be read
+ */
+static bool readMinutiae(const char *path, fpTools::minutiaeSet &minutiae)
+{
+	FILE *list = std::fopen(path, "r");
+	if( list == NULL )
+	{
+		std::fprintf(stderr, "Cannot open file to read %s\n", path);
+		return false;
+	}
+
+	minutiae.clear();
+	char line[256];
+	while( std::fgets(line, sizeof(line), list) != NULL )
+	{
+		int x, y, type, quality;
+		float angle;
+		if( line[0] == '#' || std::sscanf(line, "%d %d %f %d %d", &x, &y, &angle, &type, &quality) != 5 ) continue;
+		minutiae.add(x, y, angle, static_cast<fpTools::minutiaType>(type), quality);
+	}
+	std::fclose(list);
+
+	return true;
+}
+
+/*!
+ *  \brief  Random minutiae spread over a print
+ *
+ *  \param  rng std::mt19937 Random numbers
+ *  \param[out] minutiae fpTools::minutiaeSet The minutiae
+ */
+static void syntheticPrint(std::mt19937 &rng, fpTools::minutiaeSet &minutiae)
+{
+	std::uniform_int_distribution<int> count(30, 60);
+	std::uniform_real_distribution<float> x(50, 350);
+	std::uniform_real_distribution<float> y(50, 450);
+	std::uniform_real_distribution<float> angle(-M_PI, M_PI);
+
+	//Minutiae closer than a ridge or two are not found apart
+	minutiae.clear();
+	int wanted = count(rng);
+	while( minutiae.size() < wanted )
+	{
+		float px = x(rng);
+		float py = y(rng);
+		bool clear = true;
+		for(int k = 0; k < minutiae.size() && clear; k++)
+		{
+			float dx = px - minutiae.x()[k];
+			float dy = py - minutiae.y()[k];
+			clear = (dx*dx + dy*dy >= 144);
+		}
+		if( clear ) minutiae.add(static_cast<int>(px), static_cast<int>(py), angle(rng), fpTools::MINUTIA_ENDING, 100);
+	}
+}
+
+/*!
+ *  \brief  Another impression of a print, turned, moved, with minutiae lost and added
+ *
+ *  \param  rng std::mt19937 Random numbers
+ *  \param[in]  print fpTools::minutiaeSet The print
+ *  \param[out] impression fpTools::minutiaeSet The impression
+ */
+static void perturbPrint(std::mt19937 &rng, const fpTools::minutiaeSet &print, fpTools::minutiaeSet &impression)
+{
+	std::uniform_real_distribution<float> turn(-0.35f, 0.35f);
+	std::uniform_real_distribution<float> shift(-30, 30);
+	std::uniform_real_distribution<float> uniform(0, 1);
+	std::normal_distribution<float> jitter(0, 2);
+	std::normal_distribution<float> angleJitter(0, 0.1f);
+
+	float theta = turn(rng);
+	float c = std::cos(theta);
+	float s = std::sin(theta);
+	float tx = shift(rng);
+	float ty = shift(rng);
+
+	impression.clear();
+	for(int k = 0; k < print.size(); k++)
+	{
+		if( uniform(rng) < 0.2f ) continue;
+
+		float dx = print.x()[k] - 200.0f;
+		float dy = print.y()[k] - 250.0f;
+		float px = 200 + c*dx - s*dy + tx + jitter(rng);
+		float py = 250 + s*dx + c*dy + ty + jitter(rng);
+		float angle = print.angle()[k] + theta + angleJitter(rng);
+		if( angle > M_PI ) angle -= 2*M_PI;
+		if( angle < -M_PI ) angle += 2*M_PI;
+		if( px < 0 || py < 0 ) continue;
+		impression.add(static_cast<int>(px), static_cast<int>(py), angle, fpTools::MINUTIA_ENDING, 100);
+	}
+
+	//Spurious minutiae
+	fpTools::minutiaeSet spurious;
+	syntheticPrint(rng, spurious);
+	for(int k = 0; k < 5; k++)
+	{
+		impression.add(spurious.x()[k], spurious.y()[k], spurious.angle()[k], fpTools::MINUTIA_ENDING, 100);
+	}
+}
+
+/*!
+ *  \brief  Search a synthetic gallery with impressions of its prints
+ *
+ *  \param  matcher fpTools::minutiaeMatcher The matcher
+ *  \param  gallerySize int Number of prints in the gallery
+ *  \param  numQueries int Number of searches
+ *  \param  galleryPath const char* Gallery file to enroll into and search, NULL to keep
+ *  		the gallery in the matcher
+ *
+ *  \return int Exit status
+ */
+static int syntheticSearch(fpTools::minutiaeMatcher &matcher, int gallerySize, int numQueries, const char *galleryPath)
+{
+	std::mt19937 rng(1);
+	fpTools::minutiaeSet print;
+	fpTools::cylinderTemplate encoded;
+	fpTools::templateGallery file;
+	if( galleryPath != NULL && !file.create(galleryPath, matcher.getRadius()) ) return EXIT_FAILURE;
+
+	//Encode the gallery, keeping the prints to query with. The file is enrolled in batches
+	std::vector<fpTools::minutiaeSet> prints(std::min(gallerySize, numQueries));
+	std::vector<fpTools::cylinderTemplate> batch;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	for(int i = 0; i < gallerySize; i++)
+	{
+		syntheticPrint(rng, print);
+		matcher.encode(print, encoded);
+		if( galleryPath == NULL ) matcher.addToGallery(encoded);
+		else batch.push_back(encoded);
+		if( i < static_cast<int>(prints.size()) ) prints[i] = print;
+
+		if( static_cast<int>(batch.size()) == 10000 || (i == gallerySize - 1 && !batch.empty()) )
+		{
+			if( !file.enroll(batch) ) return EXIT_FAILURE;
+			batch.clear();
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	std::printf("Encoded %d prints, %.0f prints/s\n", gallerySize, gallerySize/seconds);
+
+	//Reopened as a search would find it
+	if( galleryPath != NULL )
+	{
+		begin = std::chrono::steady_clock::now();
+		if( !file.open(galleryPath) ) return EXIT_FAILURE;
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		std::printf("Opened %s, %d prints in %d segments, in %.3f ms\n", galleryPath, file.size(),
+				file.numSegments(), 1000*seconds);
+	}
+
+	//Encoding the queries is not counted
+	std::vector<fpTools::cylinderTemplate> queries(numQueries);
+	std::vector<int> truth(numQueries);
+	for(int q = 0; q < numQueries; q++)
+	{
+		truth[q] = q % prints.size();
+		perturbPrint(rng, prints[truth[q]], print);
+		matcher.encode(print, queries[q]);
+	}
+
+	int correct = 0;
+	std::vector<fpTools::matchResult> results;
+	begin = std::chrono::steady_clock::now();
+	for(int q = 0; q < numQueries; q++)
+	{
+		if( galleryPath == NULL ) matcher.search(queries[q], 1, results);
+		else file.search(matcher, queries[q], 1, results);
+		if( !results.empty() && results[0].id == truth[q] ) correct++;
+	}
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	std::printf("Searched %d queries against %d prints, %.1f queries/s, rank-1 %.1f%%\n", numQueries,
+			gallerySize, numQueries/seconds, 100.0*correct/numQueries);
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ *  \brief  Enroll minutiae files into a gallery file, creating it if there is none
+ *
+ *  \param  matcher fpTools::minutiaeMatcher The matcher
+ *  \param  galleryPath const char* The gallery file
+ *  \param  files std::vector<const char*> Minutiae files, enrolled as one segment
+ *
+ *  \return int Exit status
+ */
+static int enrollFiles(fpTools::minutiaeMatcher &matcher, const char *galleryPath, const std::vector<const char*> &files)
+{
+	fpTools::templateGallery gallery;
+	bool opened = (access(galleryPath, F_OK) == 0) ? gallery.open(galleryPath) : gallery.create(galleryPath, matcher.getRadius());
+	if( !opened ) return EXIT_FAILURE;
+
+	fpTools::minutiaeSet minutiae;
+	std::vector<fpTools::cylinderTemplate> prints(files.size());
+	for(size_t i = 0; i < files.size(); i++)
+	{
+		if( !readMinutiae(files[i], minutiae) ) return EXIT_FAILURE;
+		matcher.encode(minutiae, prints[i]);
+	}
+
+	int firstId = gallery.size();
+	if( !gallery.enroll(prints) ) return EXIT_FAILURE;
+	for(size_t i = 0; i < files.size(); i++) std::printf("%d %s\n", firstId + static_cast<int>(i), files[i]);
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ *  \brief  App to demo minutiae matching
+ *
+ *  \param  argv[1] Probe minutiae from demoExtract -minutiae, -synthetic and the gallery size,
+ *  		-enroll and a gallery file, or -search and a gallery file
+ *  \param  argv[2...] Gallery minutiae files, or with -search the probe, then optional
+ *  		-threads N to search with N threads (0 for all cores), -shortlist N to score only
+ *  		the N best candidates (0 for all), -results N for the number printed by -search
+ *  		and, with -synthetic, -queries N for the number of searches and -gallery path to
+ *  		enroll into and search a gallery file
+ */
+int main ( int argc, char *argv[] )
+{
+	if( argc < 3 )
+	{
+		std::fprintf(stderr, "Usage: %s probe.txt gallery.txt... [options]\n"
+				"       %s -synthetic galleryCount [options]\n"
+				"       %s -enroll gallery.fpg minutiae.txt...\n"
+				"       %s -search gallery.fpg probe.txt [options]\n", argv[0], argv[0], argv[0], argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	//Options, anything else after the first argument is a gallery file
+	int numThreads = 1;
+	int shortlist = -1;
+	int numQueries = 100;
+	int maxResults = 10;
+	const char *galleryPath = NULL;
+	bool synthetic = (std::strcmp(argv[1], "-synthetic") == 0);
+	bool enroll = (std::strcmp(argv[1], "-enroll") == 0);
+	bool searchFile = (std::strcmp(argv[1], "-search") == 0);
+	std::vector<const char*> gallery;
+	for(int i = 2; i < argc; i++)
+	{
+		if( std::strcmp(argv[i], "-threads") == 0 && i + 1 < argc ) numThreads = std::atoi(argv[++i]);
+		else if( std::strcmp(argv[i], "-shortlist") == 0 && i + 1 < argc ) shortlist = std::atoi(argv[++i]);
+		else if( std::strcmp(argv[i], "-queries") == 0 && i + 1 < argc ) numQueries = std::atoi(argv[++i]);
+		else if( std::strcmp(argv[i], "-results") == 0 && i + 1 < argc ) maxResults = std::atoi(argv[++i]);
+		else if( std::strcmp(argv[i], "-gallery") == 0 && i + 1 < argc ) galleryPath = argv[++i];
+		else gallery.push_back(argv[i]);
+	}
+
+	fpTools::minutiaeMatcher matcher;
+	matcher.setNumThreads(numThreads);
+	if( shortlist >= 0 ) matcher.setShortlist(shortlist);
+
+	if( synthetic )
+	{
+		int gallerySize = gallery.empty() ? 0 : std::atoi(gallery[0]);
+		if( gallerySize <= 0 || numQueries <= 0 ) return EXIT_FAILURE;
+		return syntheticSearch(matcher, gallerySize, numQueries, galleryPath);
+	}
+
+	if( enroll )
+	{
+		if( gallery.size() < 2 ) return EXIT_FAILURE;
+		return enrollFiles(matcher, gallery[0], std::vector<const char*>(gallery.begin() + 1, gallery.end()));
+	}
+
+	fpTools::minutiaeSet minutiae;
+	fpTools::cylinderTemplate probe, encoded;
+	std::vector<fpTools::matchResult> results;
+
+	//Search a gallery file, printing ids as enrollment gave them
+	if( searchFile )
+	{
+		if( gallery.size() != 2 ) return EXIT_FAILURE;
+		fpTools::templateGallery file(gallery[0]);
+		if( !file.isOpen() || !readMinutiae(gallery[1], minutiae) ) return EXIT_FAILURE;
+		matcher.setRadius(file.getRadius());
+		matcher.encode(minutiae, probe);
+
+		file.search(matcher, probe, maxResults, results);
+		for(size_t k = 0; k < results.size(); k++) std::printf("%.3f %d\n", results[k].score, results[k].id);
+		return EXIT_SUCCESS;
+	}
+
+	//Rank every gallery file against the probe
+	if( !readMinutiae(argv[1], minutiae) ) return EXIT_FAILURE;
+	matcher.encode(minutiae, probe);
+
+	for(size_t i = 0; i < gallery.size(); i++)
+	{
+		if( !readMinutiae(gallery[i], minutiae) ) return EXIT_FAILURE;
+		matcher.encode(minutiae, encoded);
+		matcher.addToGallery(encoded);
+	}
+
+	matcher.search(probe, static_cast<int>(gallery.size()), results);
+	for(size_t k = 0; k < results.size(); k++)
+	{
+		std::printf("%.3f %s\n", results[k].score, gallery[results[k].id]);
+	}
+
+	return EXIT_SUCCESS;
+}				/* ----------  end of function main  ---------- */
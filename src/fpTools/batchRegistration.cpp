@@ -0,0 +1,120 @@
+/*!
+ *    \file  batchRegistration.cpp
+ *   \brief  Implimentation of batch registration class
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+//STL
+#include <vector>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools/batchRegistration.h"
+
+namespace fpTools{
+
+//Constructor
+batchRegistration::batchRegistration(int lengthOfScan, int numThreads) : m_pool(numThreads)
+{
+	m_registrars.assign(m_pool.size(), lineRegistration(lengthOfScan));
+}
+
+//Set phase correlation
+void batchRegistration::setPhaseCorrelation(bool phaseCorrelation)
+{
+	for(size_t i = 0; i < m_registrars.size(); i++)
+	{
+		m_registrars[i].setPhaseCorrelation(phaseCorrelation);
+	}
+}
+
+//Set maximum shift
+void batchRegistration::setMaxShift(int maxShift)
+{
+	for(size_t i = 0; i < m_registrars.size(); i++)
+	{
+		m_registrars[i].setMaxShift(maxShift);
+	}
+}
+
+//Set pyramid levels
+void batchRegistration::setPyramidLevels(int pyramidLevels)
+{
+	for(size_t i = 0; i < m_registrars.size(); i++)
+	{
+		m_registrars[i].setPyramidLevels(pyramidLevels);
+	}
+}
+
+//Set engine
+void batchRegistration::setEngine(registrationEngine engine)
+{
+	for(size_t i = 0; i < m_registrars.size(); i++)
+	{
+		m_registrars[i].setEngine(engine);
+	}
+}
+
+//Register batch in place
+template<typename Image>
+bool batchRegistration::registerBatch(std::vector<Image> &images, std::vector<bool> &success)
+{
+	//Flags are kept as chars, std::vector<bool> can not be written from several threads
+	std::vector<char> ok(images.size(), 0);
+
+	for(size_t i = 0; i < images.size(); i++)
+	{
+		m_pool.submit([this, &images, &ok, i](int worker)
+		{
+			ok[i] = m_registrars[worker].registerLines(images[i]);
+		});
+	}
+	m_pool.wait();
+
+	success.assign(ok.begin(), ok.end());
+	for(size_t i = 0; i < ok.size(); i++) if( !ok[i] ) return false;
+	return true;
+}
+
+//Register batch into views
+template<typename Image>
+bool batchRegistration::registerBatch(const std::vector<Image> &images,
+		std::vector<basicRegisteredImage<Image> > &views, std::vector<bool> &success)
+{
+	std::vector<char> ok(images.size(), 0);
+	views.resize(images.size());
+
+	for(size_t i = 0; i < images.size(); i++)
+	{
+		m_pool.submit([this, &images, &views, &ok, i](int worker)
+		{
+			ok[i] = m_registrars[worker].registerLines(images[i], views[i]);
+		});
+	}
+	m_pool.wait();
+
+	success.assign(ok.begin(), ok.end());
+	for(size_t i = 0; i < ok.size(); i++) if( !ok[i] ) return false;
+	return true;
+}
+
+//Supported scan types
+template bool batchRegistration::registerBatch(std::vector<Eigen::MatrixXi> &images, std::vector<bool> &success);
+template bool batchRegistration::registerBatch(std::vector<image8u> &images, std::vector<bool> &success);
+template bool batchRegistration::registerBatch(std::vector<image16u> &images, std::vector<bool> &success);
+template bool batchRegistration::registerBatch(const std::vector<Eigen::MatrixXi> &images,
+		std::vector<registeredImage> &views, std::vector<bool> &success);
+template bool batchRegistration::registerBatch(const std::vector<image8u> &images,
+		std::vector<registeredImage8u> &views, std::vector<bool> &success);
+template bool batchRegistration::registerBatch(const std::vector<image16u> &images,
+		std::vector<registeredImage16u> &views, std::vector<bool> &success);
+
+} // End namespace fpTools
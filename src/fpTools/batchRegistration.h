@@ -0,0 +1,131 @@
+/*!
+ *    \file  batchRegistration.h
+ *   \brief  Class to register many swipes across a pool of threads
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools/lineRegistration.h"
+#include "fpTools/registeredImage.h"
+#include "fpTools/threadPool.h"
+
+#ifndef BATCHREGISTRATION_H
+#define BATCHREGISTRATION_H
+
+namespace fpTools{
+/*!
+ *  \brief  Class to register a batch of swipes, one swipe per task on a work-stealing pool
+ *
+ *  Each worker owns a lineRegistration, and with it the FFT workspace, which is reused
+ *  for every swipe that worker picks up. Results are returned in input order.
+ */
+class batchRegistration
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Constructor
+		 *
+		 *  \param  lengthOfScan int The length of the scanline in pixels, defined by the hardware
+		 *  \param  numThreads int Number of workers, 0 for all cores
+		 */
+		batchRegistration (int lengthOfScan, int numThreads);            /* constructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get number of workers
+		 */
+		int getNumThreads(){return m_pool.size();}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Set if phase correlation is used by every worker
+		 *
+		 *  \param  phaseCorrelation bool See lineRegistration::setPhaseCorrelation
+		 */
+		void setPhaseCorrelation(bool phaseCorrelation);
+
+		/*!
+		 *  \brief  Set largest shift in X considered by every worker
+		 *
+		 *  \param  maxShift int See lineRegistration::setMaxShift
+		 */
+		void setMaxShift(int maxShift);
+
+		/*!
+		 *  \brief  Set number of coarse-to-fine pyramid levels of every worker
+		 *
+		 *  \param  pyramidLevels int See lineRegistration::setPyramidLevels
+		 */
+		void setPyramidLevels(int pyramidLevels);
+
+		/*!
+		 *  \brief  Set the engine used by every worker
+		 *
+		 *  \param  engine registrationEngine See lineRegistration::setEngine
+		 */
+		void setEngine(registrationEngine engine);
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Register a batch of swipes in place
+		 *
+		 *  \param[in,out] images std::vector<Image> Unregistered scans, replaced by registered scans
+		 *  \param[out] success std::vector<bool> If each swipe registered, in input order
+		 *
+		 *  \return bool True if every swipe registered
+		 *
+		 *  Image is Eigen::MatrixXi, image8u or image16u.
+		 */
+		template<typename Image>
+		bool registerBatch(std::vector<Image> &images, std::vector<bool> &success);
+
+		/*!
+		 *  \brief  Register a batch of swipes into views, without copying them
+		 *
+		 *  \param[in]  images std::vector<Image> Unregistered scans, must outlive the views
+		 *  \param[out] views std::vector<basicRegisteredImage> Registered views, in input order
+		 *  \param[out] success std::vector<bool> If each swipe registered, in input order
+		 *
+		 *  \return bool True if every swipe registered
+		 *
+		 *  Image is Eigen::MatrixXi, image8u or image16u.
+		 */
+		template<typename Image>
+		bool registerBatch(const std::vector<Image> &images,
+				std::vector<basicRegisteredImage<Image> > &views, std::vector<bool> &success);
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		threadPool m_pool; /**< Workers */
+		std::vector<lineRegistration> m_registrars; /**< One registrar, and FFT workspace, per worker */
+
+}; /* -----  end of class batchRegistration  ----- */
+
+} // End namespace fpTools
+
+#endif //BATCHREGISTRATION_H
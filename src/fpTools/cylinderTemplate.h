@@ -0,0 +1,161 @@
+/*!
+ *    \file  cylinderTemplate.h
+ *   \brief  Bit-vector cylinder descriptors of the minutiae of one print
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+
+#ifndef CYLINDERTEMPLATE_H
+#define CYLINDERTEMPLATE_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Template of a print for matching, one cylinder per minutia
+ *
+ *  The cylinder of a minutia is a grid of cellsPerSide x cellsPerSide cells around it,
+ *  turned to its angle, each split in angleSections by the angle of the neighbours
+ *  relative to it. A bit is set where neighbours fall, so a cylinder does not change
+ *  as the print moves or turns. Cylinders are cylinderWords words each, stored one
+ *  after the other, with the other fields in arrays of their own as in minutiaeSet.
+ *  The signature has a bit for each kind of pair of nearby minutiae, by distance, turn
+ *  and bearing, and is a coarse summary of the whole template used to pick the candidates
+ *  worth scoring.
+ */
+class cylinderTemplate
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor, empty template
+		 */
+		cylinderTemplate() : m_signatureCount(0) {std::memset(m_signature, 0, sizeof(m_signature));}
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get number of cylinders
+		 */
+		int size() const {return static_cast<int>(m_angle.size());}
+
+		/*!
+		 *  \brief  Get the bits of every cylinder, cylinderWords per cylinder
+		 */
+		const uint64_t* bits() const {return m_bits.data();}
+
+		/*!
+		 *  \brief  Get the columns of the minutiae, in pixels
+		 */
+		const uint16_t* x() const {return m_x.data();}
+
+		/*!
+		 *  \brief  Get the rows of the minutiae, in pixels
+		 */
+		const uint16_t* y() const {return m_y.data();}
+
+		/*!
+		 *  \brief  Get the angles of the minutiae, in radians
+		 */
+		const float* angle() const {return m_angle.data();}
+
+		/*!
+		 *  \brief  Get the norms of the cylinders, the square root of the bits set
+		 */
+		const float* norm() const {return m_norm.data();}
+
+		/*!
+		 *  \brief  Get the signature, signatureWords words
+		 */
+		const uint64_t* signature() const {return m_signature;}
+
+		/*!
+		 *  \brief  Get the number of bits set in the signature
+		 */
+		int signatureCount() const {return m_signatureCount;}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Remove every cylinder and clear the signature, keeping the storage
+		 */
+		void clear()
+		{
+			m_bits.clear();
+			m_x.clear();
+			m_y.clear();
+			m_angle.clear();
+			m_norm.clear();
+			std::memset(m_signature, 0, sizeof(m_signature));
+			m_signatureCount = 0;
+		}
+
+		/*!
+		 *  \brief  Add a cylinder
+		 *
+		 *  \param  bits const uint64_t* The cylinderWords words of the cylinder
+		 *  \param  x int Column of the minutia
+		 *  \param  y int Row of the minutia
+		 *  \param  angle float Angle of the minutia
+		 *  \param  norm float Square root of the bits set
+		 */
+		void add(const uint64_t *bits, int x, int y, float angle, float norm)
+		{
+			m_bits.insert(m_bits.end(), bits, bits + cylinderWords);
+			m_x.push_back(static_cast<uint16_t>(x));
+			m_y.push_back(static_cast<uint16_t>(y));
+			m_angle.push_back(angle);
+			m_norm.push_back(norm);
+		}
+
+		/*!
+		 *  \brief  Set a bit of the signature
+		 *
+		 *  \param  bit int The bit, below 64*signatureWords
+		 */
+		void setSignatureBit(int bit)
+		{
+			uint64_t mask = static_cast<uint64_t>(1) << (bit & 63);
+			if( (m_signature[bit >> 6] & mask) == 0 ) m_signatureCount++;
+			m_signature[bit >> 6] |= mask;
+		}
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		static const int cellsPerSide = 8; /**< Cells along a side of a cylinder */
+		static const int angleSections = 8; /**< Angle sections of a cell */
+		static const int cylinderWords = cellsPerSide*cellsPerSide*angleSections/64; /**< Words in a cylinder */
+		static const int signatureWords = 32; /**< Words in the signature */
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		std::vector<uint64_t> m_bits; /**< Cylinders */
+		std::vector<uint16_t> m_x; /**< Columns */
+		std::vector<uint16_t> m_y; /**< Rows */
+		std::vector<float> m_angle; /**< Angles */
+		std::vector<float> m_norm; /**< Norms */
+		uint64_t m_signature[signatureWords]; /**< Pairs of minutiae found */
+		int m_signatureCount; /**< Bits set in the signature */
+
+}; /* -----  end of class cylinderTemplate  ----- */
+
+} // End namespace fpTools
+
+#endif //CYLINDERTEMPLATE_H
@@ -0,0 +1,243 @@
+/*!
+ *    \file  fftWorkspace.cpp
+ *   \brief  Implimentation of reusable FFT workspace
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <complex>
+#include <cmath>
+
+//Eigen3
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+//fpTools
+#include "fpTools/fftWorkspace.h"
+
+namespace fpTools{
+
+/*!
+ *  \brief  Twiddle factors of a transform length, exp(-2 pi i k/L) for k below L/2
+ */
+template<int L>
+struct twiddleTable
+{
+	twiddleTable()
+	{
+		for(int k = 0; k < L/2; k++)
+		{
+			double angle = -2*M_PI*k/L;
+			re[k] = static_cast<float>(std::cos(angle));
+			im[k] = static_cast<float>(std::sin(angle));
+		}
+	}
+
+	float re[L/2]; /**< Real parts */
+	float im[L/2]; /**< Imaginary parts */
+};
+
+/*!
+ *  \brief  Complex FFT of a fixed length, unrolled by the compiler
+ *
+ *  Radix-2 decimation in time down to radix-4 butterflies, which need no multiplies.
+ *  N is the length of this stage, L of the whole transform whose twiddles are used.
+ */
+template<int L, int N, bool Inverse>
+struct fixedFFT
+{
+	/*!
+	 *  \brief  Transform
+	 *
+	 *  \param[in]  in std::complex<float>* The input, N values stride apart
+	 *  \param  stride int Distance between input values
+	 *  \param[out] out std::complex<float>* The N outputs, contiguous, unscaled
+	 *  \param  w twiddleTable<L> The twiddles of the whole transform
+	 */
+	static inline void run(const std::complex<float> *in, int stride, std::complex<float> *out,
+			const twiddleTable<L> &w)
+	{
+		//Transforms of the even and the odd values, then combine
+		fixedFFT<L, N/2, Inverse>::run(in, 2*stride, out, w);
+		fixedFFT<L, N/2, Inverse>::run(in + stride, 2*stride, out + N/2, w);
+		for(int k = 0; k < N/2; k++)
+		{
+			//Written out, std::complex multiplies check for infinities
+			float wr = w.re[k*(L/N)];
+			float wi = Inverse ? -w.im[k*(L/N)] : w.im[k*(L/N)];
+			float br = out[k + N/2].real();
+			float bi = out[k + N/2].imag();
+			std::complex<float> t(br*wr - bi*wi, br*wi + bi*wr);
+			out[k + N/2] = out[k] - t;
+			out[k] += t;
+		}
+	}
+};
+
+/*!
+ *  \brief  Radix-4 butterfly, the last stage of every fixed length
+ */
+template<int L, bool Inverse>
+struct fixedFFT<L, 4, Inverse>
+{
+	static inline void run(const std::complex<float> *in, int stride, std::complex<float> *out,
+			const twiddleTable<L> &)
+	{
+		std::complex<float> s0 = in[0] + in[2*stride];
+		std::complex<float> s1 = in[0] - in[2*stride];
+		std::complex<float> s2 = in[stride] + in[3*stride];
+		std::complex<float> s3 = in[stride] - in[3*stride];
+
+		//s3 turned by -i forward, by i inverse
+		std::complex<float> turned = Inverse ? std::complex<float>(-s3.imag(), s3.real()) :
+			std::complex<float>(s3.imag(), -s3.real());
+
+		out[0] = s0 + s2;
+		out[1] = s1 + turned;
+		out[2] = s0 - s2;
+		out[3] = s1 - turned;
+	}
+};
+
+/*!
+ *  \brief  Transform every column of a spectrum in place with a fixed length FFT
+ *
+ *  \param[in,out] matCF Eigen::MatrixXcf The spectrum, L rows
+ *  \param  cols int Columns to transform
+ *
+ *  Scaled by 1/L inverse, as Eigen::FFT is.
+ */
+template<int L, bool Inverse>
+static void fixedColumns(Eigen::MatrixXcf &matCF, int cols)
+{
+	static const twiddleTable<L> twiddles;
+	const float scale = Inverse ? 1.0f/L : 1.0f;
+
+	std::complex<float> out[L];
+	for(int k = 0; k < cols; k++)
+	{
+		std::complex<float> *col = matCF.col(k).data();
+		fixedFFT<L, L, Inverse>::run(col, 1, out, twiddles);
+		for(int i = 0; i < L; i++) col[i] = Inverse ? out[i]*scale : out[i];
+	}
+}
+
+/*!
+ *  \brief  Transform the columns with a fixed length FFT if there is one for the length
+ *
+ *  \param[in,out] matCF Eigen::MatrixXcf The spectrum
+ *  \param  cols int Columns to transform
+ *  \param  inverse bool True for the inverse transform
+ *
+ *  \return bool False if the length has no fixed FFT, the columns are left as they were
+ */
+static bool fixedColumns(Eigen::MatrixXcf &matCF, int cols, bool inverse)
+{
+	switch( matCF.rows() )
+	{
+		case 4: inverse ? fixedColumns<4, true>(matCF, cols) : fixedColumns<4, false>(matCF, cols); return true;
+		case 8: inverse ? fixedColumns<8, true>(matCF, cols) : fixedColumns<8, false>(matCF, cols); return true;
+		case 16: inverse ? fixedColumns<16, true>(matCF, cols) : fixedColumns<16, false>(matCF, cols); return true;
+		case 32: inverse ? fixedColumns<32, true>(matCF, cols) : fixedColumns<32, false>(matCF, cols); return true;
+		default: return false;
+	}
+}
+
+//Constructor
+fftWorkspace::fftWorkspace(int rows, int cols) : m_rows(0), m_cols(0)
+{
+	resize(rows, cols);
+}
+
+//Size plans and buffers
+void fftWorkspace::resize(int rows, int cols)
+{
+	if( rows == m_rows && cols == m_cols ) return;
+
+	m_rows = rows;
+	m_cols = cols;
+
+	//Only half of the spectrum of a real row is kept
+	m_rowFFT.SetFlag(Eigen::FFT<float>::HalfSpectrum);
+
+	m_rowReal.resize(cols);
+	m_rowCF.resize(cols);
+	m_colCF.resize(rows);
+	m_spectrum.resize(rows, spectrumCols());
+	m_real.resize(rows, cols);
+
+	//Run once to build the plans and size the scratch inside the FFT
+	rowMatrixXf mat = rowMatrixXf::Zero(rows, cols);
+	forward(mat, m_spectrum);
+	inverse(m_spectrum, m_real);
+}
+
+//Forward 2d FFT
+void fftWorkspace::forward(const rowMatrixXf &mat, Eigen::MatrixXcf &matCF)
+{
+	int nCols = spectrumCols();
+
+	//Real to complex along the rows
+	for(int k = 0; k < m_rows; k++)
+	{
+		m_rowFFT.fwd(m_rowCF.data(), mat.data() + k*m_cols, m_cols);
+		matCF.row(k) = m_rowCF.head(nCols);
+	}
+
+	//Complex along the cols, unrolled for the common scan lengths
+	if( fixedColumns(matCF, nCols, false) ) return;
+	for(int k = 0; k < nCols; k++)
+	{
+		m_colFFT.fwd(m_colCF.data(), matCF.col(k).data(), m_rows);
+		matCF.col(k) = m_colCF;
+	}
+}
+
+//Inverse 2d FFT
+void fftWorkspace::inverse(Eigen::MatrixXcf &matCF, Eigen::MatrixXf &mat)
+{
+	int nCols = spectrumCols();
+
+	//Complex along the cols, unrolled for the common scan lengths
+	if( !fixedColumns(matCF, nCols, true) )
+	{
+		for(int k = 0; k < nCols; k++)
+		{
+			m_colFFT.inv(m_colCF.data(), matCF.col(k).data(), m_rows);
+			matCF.col(k) = m_colCF;
+		}
+	}
+
+	//Complex to real along the rows
+	for(int k = 0; k < m_rows; k++)
+	{
+		m_rowCF.head(nCols) = matCF.row(k);
+		m_rowFFT.inv(m_rowReal.data(), m_rowCF.data(), m_cols);
+		mat.row(k) = m_rowReal;
+	}
+}
+
+//Whiten an image
+void fftWorkspace::whiten(rowMatrixXf &mat)
+{
+	forward(mat, m_spectrum);
+
+	//Unit magnitude, bins with none are left out
+	for(int k = 0; k < m_spectrum.size(); k++)
+	{
+		float mag = std::abs(m_spectrum(k));
+		m_spectrum(k) = (mag > 1e-12f) ? m_spectrum(k) / mag : std::complex<float>(0, 0);
+	}
+
+	inverse(m_spectrum, m_real);
+	mat = m_real;
+}
+
+} // End namespace fpTools
@@ -0,0 +1,137 @@
+/*!
+ *    \file  fftWorkspace.h
+ *   \brief  Reusable workspace for 2d real FFTs
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//Eigen3
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+#ifndef FFTWORKSPACE_H
+#define FFTWORKSPACE_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Row-major float matrix, rows of a scanline are contiguous
+ */
+typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> rowMatrixXf;
+
+/*!
+ *  \brief  Class holding FFT plans and scratch buffers for one 2d real transform size
+ *
+ *  Spectra are stored as half spectra, rows x (cols/2 + 1), since the input is real.
+ *  Once sized, forward and inverse transforms do not allocate. The rows are scanlines, so
+ *  the column transforms are short: 4, 8, 16 and 32 rows, the common scan lengths, use
+ *  unrolled transforms of that fixed length, any other length the general plans.
+ */
+class fftWorkspace
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor
+		 */
+		fftWorkspace() : m_rows(0), m_cols(0) {}
+
+		/*!
+		 *  \brief  Constructor
+		 *
+		 *  \param  rows int Number of rows of the real input
+		 *  \param  cols int Number of cols of the real input
+		 */
+		fftWorkspace (int rows, int cols);                             /* constructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get number of rows of the real input
+		 */
+		int rows(){return m_rows;}
+
+		/*!
+		 *  \brief  Get number of cols of the real input
+		 */
+		int cols(){return m_cols;}
+
+		/*!
+		 *  \brief  Get number of cols of the half spectrum
+		 */
+		int spectrumCols(){return m_cols/2 + 1;}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Size the plans and buffers, does nothing if the size is unchanged
+		 *
+		 *  \param  rows int Number of rows of the real input
+		 *  \param  cols int Number of cols of the real input
+		 */
+		void resize(int rows, int cols);
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Performs forward real to complex 2d FFT
+		 *
+		 *  \param[in]  mat rowMatrixXf Input real matrix, rows x cols
+		 *  \param[out] matCF Eigen::MatrixXcf Output half spectrum, rows x spectrumCols()
+		 *
+		 *  User responsible for sizing matCF
+		 */
+		void forward(const rowMatrixXf &mat, Eigen::MatrixXcf &matCF);
+
+		/*!
+		 *  \brief  Performs inverse complex to real 2d FFT
+		 *
+		 *  \param[in]  matCF Eigen::MatrixXcf Input half spectrum, used as scratch
+		 *  \param[out] mat Eigen::MatrixXf Output real matrix, rows x cols
+		 *
+		 *  User responsible for sizing mat
+		 */
+		void inverse(Eigen::MatrixXcf &matCF, Eigen::MatrixXf &mat);
+
+		/*!
+		 *  \brief  Keep only the phase of the spectrum of an image, in place
+		 *
+		 *  The circular cross-correlation of two whitened images is their phase correlation,
+		 *  the inverse of the normalized cross-power spectrum.
+		 *
+		 *  \param[in,out] mat rowMatrixXf Real matrix, rows x cols
+		 */
+		void whiten(rowMatrixXf &mat);
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		int m_rows; /**< Rows of the real input */
+		int m_cols; /**< Cols of the real input */
+
+		Eigen::FFT<float> m_rowFFT; /**< Half spectrum plans along the rows */
+		Eigen::FFT<float> m_colFFT; /**< Complex plans along the cols */
+
+		Eigen::VectorXf m_rowReal; /**< Contiguous real row for the inverse */
+		Eigen::VectorXcf m_rowCF; /**< Contiguous half spectrum row */
+		Eigen::VectorXcf m_colCF; /**< Contiguous spectrum col */
+		Eigen::MatrixXcf m_spectrum; /**< Half spectrum for whiten */
+		Eigen::MatrixXf m_real; /**< Real output for whiten */
+}; /* -----  end of class fftWorkspace  ----- */
+
+} // End namespace fpTools
+
+#endif //FFTWORKSPACE_H
@@ -0,0 +1,103 @@
+/*!
+ *    \file  galleryFormat.h
+ *   \brief  On-disk layout of template gallery files
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ *  A gallery file holds cylinder templates, in segments appended one after the other,
+ *  each the templates of one enrollment and the index of their triplet keys. Nothing is
+ *  written twice, a new enrollment only adds a segment at the end. The layout, all fields
+ *  little-endian and every part starting on a 64-byte cache line:
+ *
+ *  - galleryFileHeader
+ *  - The segments, each:
+ *    - gallerySegmentHeader
+ *    - The first cylinder of each template then one past the last, numTemplates + 1 uint32_t
+ *    - The bits set in each signature, numTemplates uint32_t
+ *    - The signatures, numTemplates x signatureWords uint64_t
+ *    - The cylinders, numCylinders x cylinderWords uint64_t
+ *    - The angles of the cylinders, numCylinders float
+ *    - The norms of the cylinders, numCylinders float
+ *    - The keys, numKeys galleryKey sorted by key then template
+ *    - The key directory, 2^directoryBits + 1 uint32_t, the first key whose top
+ *      directoryBits bits are at least the index
+ *
+ *  A segment header is written after the rest of its segment is on disk, so a segment
+ *  cut short by a crash has no valid header and is dropped by the next enrollment.
+ *
+ *  The gallery is mapped and searched in place, so only little-endian hosts can build it.
+ */
+
+//STL
+#include <stdint.h>
+
+#ifndef GALLERYFORMAT_H
+#define GALLERYFORMAT_H
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Gallery files are little-endian and are searched in place without byte swapping"
+#endif
+
+namespace fpTools{
+
+/*!
+ *  \brief  Magic number at the start of a gallery file
+ */
+static const char galleryMagic[8] = {'F', 'P', 'G', 'A', 'L', 'L', '0', '1'};
+
+/*!
+ *  \brief  Magic number at the start of each segment
+ */
+static const char segmentMagic[8] = {'F', 'P', 'G', 'S', 'E', 'G', '0', '1'};
+
+/*!
+ *  \brief  Alignment of every part of the file, a cache line
+ */
+static const int galleryAlignment = 64;
+
+/*!
+ *  \brief  Start of a gallery file, one cache line
+ */
+struct galleryFileHeader
+{
+	char magic[8]; /**< galleryMagic */
+	uint32_t version; /**< Format version, 1 */
+	uint32_t cylinderWords; /**< Words in a cylinder */
+	uint32_t signatureWords; /**< Words in a signature */
+	uint32_t keyBits; /**< Bits in a triplet key */
+	float radius; /**< Radius the cylinders were encoded with, in pixels */
+	uint32_t reserved[9]; /**< 0 */
+};
+
+/*!
+ *  \brief  Start of a segment, one cache line
+ */
+struct gallerySegmentHeader
+{
+	char magic[8]; /**< segmentMagic */
+	uint32_t numTemplates; /**< Templates in the segment */
+	uint32_t numCylinders; /**< Cylinders of all of them */
+	uint32_t numKeys; /**< Entries in the key index */
+	uint32_t directoryBits; /**< Top bits of a key used by the directory */
+	uint64_t firstId; /**< Id of the first template, the templates in every segment before */
+	uint64_t size; /**< Bytes in the segment with this header, a multiple of galleryAlignment */
+	uint64_t reserved[3]; /**< 0 */
+};
+
+/*!
+ *  \brief  Entry of the key index of a segment
+ */
+struct galleryKey
+{
+	uint32_t key; /**< Triplet key */
+	uint32_t index; /**< Template with the key, counted from the start of the segment */
+};
+
+} // End namespace fpTools
+
+#endif //GALLERYFORMAT_H
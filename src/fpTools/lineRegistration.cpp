@@ -13,26 +13,103 @@
 //STL
 #include <iostream>
 #include <vector>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include <limits>
 
 //Eigen3
 #include <Eigen/Core>
-#include <unsupported/Eigen/FFT>
 
 //fpTools
 #include "fpTools/lineRegistration.h"
+#include "fpTools_utility/parallelFor.h"
+#include "fpTools/simdKernels.h"
 
 namespace fpTools{
 
+//Cost model weights, measured with -O2 on SSE2
+const double lineRegistration::fftCostFactor = 4.0;
+const double lineRegistration::directCostFactor = 1.0;
+
 //Constructor
-lineRegistration::lineRegistration(int lengthOfScan){
+lineRegistration::lineRegistration(int lengthOfScan) :
+	m_numThreads(1), m_phaseCorrelation(false), m_maxShift(0), m_pyramidLevels(0),
+	m_engine(ENGINE_AUTO), m_lastEngine(ENGINE_FFT)
+{
 	setLengthOfScan(lengthOfScan);
 }
 
 //Register scanlines
-bool lineRegistration::registerLines(Eigen::MatrixXi &image)
+template<typename Image>
+bool lineRegistration::registerLines(Image &image)
+{
+	//Register into a view of the scans
+	basicRegisteredImage<Image> view;
+	if( !registerLines(image, view, m_workspace) ) return false;
+
+	//Replace image
+	Image regImage;
+	view.materialize(regImage);
+	image.swap(regImage);
+	return true;
+}
+
+//Pick the engine for a scanline width
+registrationEngine lineRegistration::selectEngine(int cols)
+{
+	//The direct search needs a bounded window
+	if( m_maxShift <= 0 ) return ENGINE_FFT;
+	if( m_engine != ENGINE_AUTO ) return m_engine;
+
+	//FFT path: one forward and one inverse transform at the coarsest level,
+	//then a 3x3 search at each finer level, whitened first for phase correlation
+	int levels = pyramidLevels(cols);
+	double topSize = static_cast<double>(m_lengthOfScan)*(cols >> levels);
+	double fftCost = fftCostFactor*topSize*std::log2(topSize);
+	for(int l = 0; l < levels; l++)
+	{
+		double size = static_cast<double>(m_lengthOfScan)*(cols >> l);
+		fftCost += 9.0*size;
+		if( m_phaseCorrelation ) fftCost += fftCostFactor*size*std::log2(size);
+	}
+
+	//Direct path: every lag in Y and X over the whole scanline, a vector at a time
+	double window = static_cast<double>(m_lengthOfScan)*(2*directWindow(cols) + 1);
+	double directCost = directCostFactor*window*m_lengthOfScan*cols/simdFloatWidth();
+
+	return (directCost < fftCost) ? ENGINE_DIRECT : ENGINE_FFT;
+}
+
+//Shift window of the direct search
+int lineRegistration::directWindow(int cols)
+{
+	//Lags overlapping only a few columns can win on noise, or on nothing at all
+	int minOverlap = (cols/2 > minOverlapCols) ? cols/2 : minOverlapCols;
+	return std::max(0, std::min(m_maxShift, cols - minOverlap));
+}
+
+//Effective number of pyramid levels
+int lineRegistration::pyramidLevels(int cols)
+{
+	int levels = 0;
+	while( levels < m_pyramidLevels && (cols >> (levels + 1)) >= minPyramidCols ) levels++;
+	return levels;
+}
+
+//Register scanlines into a view
+template<typename Image>
+bool lineRegistration::registerLines(const Image &image, basicRegisteredImage<Image> &view)
+{
+	return registerLines(image, view, m_workspace);
+}
+
+//Register scanlines into a view, in a workspace
+template<typename Image>
+bool lineRegistration::registerLines(const Image &image, basicRegisteredImage<Image> &view, workspace &work)
 {
 	//Check bounds
-	if( image.rows() % m_lengthOfScan != 0)
+	if( image.rows() % m_lengthOfScan != 0 || image.rows() == 0 )
 	{
 		std::cerr << "LineReg: Scan length incorrect" << std::endl;
 		return false;
@@ -40,194 +117,482 @@ bool lineRegistration::registerLines(Eigen::MatrixXi &image)
 
 	//Calculate number of scan lines and shifts
 	int scanLines = image.rows()/m_lengthOfScan;
-	std::vector<int> vShiftX(scanLines-1);
-	std::vector<int> vShiftY(scanLines-1);
-
-	/**<TODO: This is the part that uses too much memory */
-	//Preallocate mats for fft
-	Eigen::MatrixXf subCurrent(m_lengthOfScan, image.cols());
-	Eigen::MatrixXf subNext(m_lengthOfScan, image.cols());
-	Eigen::MatrixXf correlation(m_lengthOfScan, image.cols());
-	Eigen::MatrixXcf currentLine(m_lengthOfScan, image.cols());
-	Eigen::MatrixXcf nextLine(m_lengthOfScan, image.cols());
+	m_shifts.resize(scanLines-1);
 
-	//Subset first line and do fft
-	subsetImage(0,0,m_lengthOfScan, image.cols(),image, subCurrent);
-	fft2dFwd(subCurrent, currentLine);
+	//Find shift between each pair of neighbouring lines
+	m_lastEngine = selectEngine(image.cols());
+	if( m_numThreads != 1 && scanLines > 2 )
+	{
+		computeShiftsParallel(image, work, m_shifts);
+	}else
+	{
+		computeShifts(image, work, m_shifts);
+	}
 
-	//Vars for shifts
-	int halfRow = m_lengthOfScan/2;
-	int halfCol = image.cols()/2;
-	
 	//Track deviations and total translation 
 	//to calculate nominal composite size
-	int maxXShift = 0; //For tracking max deviation in X
-	int maxYShift = 0; //For tracking max deviation in Y
-	int minXShift = 10000; //For tracking min deviation in X
-	int minYShift = 10000; //For tracking min deviation in Y
+	int minXShift = 0; //For tracking min deviation in X
+	int minYShift = 0; //For tracking min deviation in Y
+
+	float totalShiftX = 0;
+	float totalShiftY = 0;
+
+	//Position of each line, rounded from the running total so sub-pixel shifts do not drift
+	std::vector<int> &vPosX = work.posX;
+	std::vector<int> &vPosY = work.posY;
+	vPosX.assign(scanLines, 0);
+	vPosY.assign(scanLines, 0);
+	for(size_t i = 0; i < m_shifts.size(); i++)
+	{
+		//Track total shift
+		totalShiftX += m_shifts[i].x;
+		totalShiftY += m_shifts[i].y;
+
+		vPosX[i+1] = static_cast<int>(std::lround(totalShiftX));
+		vPosY[i+1] = static_cast<int>(std::lround(totalShiftY));
+
+		//Track shift deviation
+		if( vPosX[i+1] < minXShift ) minXShift = vPosX[i+1];
+		if( vPosY[i+1] < minYShift ) minYShift = vPosY[i+1];
+	}
+
+	//Make sure we start at 0,0
+	for(int i = 0; i < scanLines; i++)
+	{
+		vPosX[i] -= minXShift;
+		vPosY[i] -= minYShift;
+	}
+
+	view.assign(image, m_lengthOfScan, vPosX, vPosY);
+	return true;
+}
+
+//Shifts between neighbouring lines, one line at a time
+template<typename Image>
+void lineRegistration::computeShifts(const Image &image, workspace &work, std::vector<lineShift> &shifts)
+{
+	int scanLines = image.rows()/m_lengthOfScan;
+
+	//Buffers are sized on first use and kept in the workspace
+	reserveWorkspace(work, 1, 2);
+	std::vector<fftWorkspace> &fft = work.fft[0];
+	lineData &currentLine = work.lines[0];
+	lineData &nextLine = work.lines[1];
 
-	int totalShiftX = 0;
-	int totalShiftY = 0;
+	//Prepare first line
+	prepareLine(fft, image, 0, currentLine);
 
-	for(size_t i = 1; i < scanLines; i++)
+	for(int i = 1; i < scanLines; i++)
 	{
-		//Shifts
-		int shiftX, shiftY;
+		//Prepare next line
+		prepareLine(fft, image, i, nextLine);
 
-		//Subset next line and do fft
-		subsetImage(i*m_lengthOfScan, 0, m_lengthOfScan, image.cols(), image, subNext);
-		fft2dFwd(subNext, nextLine);
+		//Correlate with current line
+		matchLines(fft, currentLine, nextLine, work.product[0], work.correlation[0], shifts[i-1]);
 
-		//Do correlation
-		currentLine = currentLine.cwiseProduct( nextLine.conjugate() ); // CC = A*conj(B)
-		currentLine *= (currentLine.rows() * currentLine.cols()); // Scale
-		
-		//Do inverse fft
-		fft2dInv(currentLine, correlation);
+		//Set next line to current line
+		std::swap(currentLine, nextLine);
+	}
+}
+
+//Shifts between neighbouring lines, all lines at once
+template<typename Image>
+void lineRegistration::computeShiftsParallel(const Image &image, workspace &work, std::vector<lineShift> &shifts)
+{
+	int scanLines = image.rows()/m_lengthOfScan;
+	int numThreads = resolveThreads(m_numThreads);
 
-		//Peak value will correspond to match
-		//Shift can be caculated assuming scans are shifted from center
-		Eigen::MatrixXf::Index rowM, colM;
-		correlation.maxCoeff( &rowM, &colM);
+	//Every thread gets its own plans and scratch
+	reserveWorkspace(work, numThreads, scanLines);
+	std::vector< std::vector<fftWorkspace> > &workspaces = work.fft;
+	std::vector<lineData> &lines = work.lines;
 
-		//Calculate Shift
-		if( rowM > halfRow )
+	//Prepare every line
+	parallelFor(0, scanLines, numThreads, [&](int t, int begin, int end)
+	{
+		for(int i = begin; i < end; i++)
 		{
-			shiftY = rowM - m_lengthOfScan;
-		}else
-		{	
-			shiftY = rowM;
+			prepareLine(workspaces[t], image, i, lines[i]);
 		}
+	});
 
-		if( colM > halfCol )
+	//Correlate every neighbouring pair
+	parallelFor(1, scanLines, numThreads, [&](int t, int begin, int end)
+	{
+		for(int i = begin; i < end; i++)
 		{
-			shiftX = colM - image.cols();
-		}else
+			matchLines(workspaces[t], lines[i-1], lines[i], work.product[t], work.correlation[t], shifts[i-1]);
+		}
+	});
+}
+
+//Size workspace buffers
+void lineRegistration::reserveWorkspace(workspace &work, int numThreads, int numLines)
+{
+	//Only grow, so buffers sized by an earlier image are kept
+	if( static_cast<int>(work.fft.size()) < numThreads ) work.fft.resize(numThreads);
+	if( static_cast<int>(work.product.size()) < numThreads ) work.product.resize(numThreads);
+	if( static_cast<int>(work.correlation.size()) < numThreads ) work.correlation.resize(numThreads);
+	if( static_cast<int>(work.lines.size()) < numLines ) work.lines.resize(numLines);
+}
+
+//Prepare a line for matching
+template<typename Image>
+void lineRegistration::prepareLine(std::vector<fftWorkspace> &fft, const Image &image, int line, lineData &data)
+{
+	//Halve the width for each level, down to a minimum width
+	int levels = (m_lastEngine == ENGINE_DIRECT) ? 0 : pyramidLevels(image.cols());
+	data.pyramid.resize(levels + 1);
+	if( static_cast<int>(fft.size()) < levels + 1 ) fft.resize(levels + 1);
+
+	//Subset line
+	data.pyramid[0].resize(m_lengthOfScan, image.cols());
+	subsetImage(line*m_lengthOfScan, 0, m_lengthOfScan, image.cols(), image, data.pyramid[0]);
+
+	//The direct search works on the scanline itself
+	if( m_lastEngine == ENGINE_DIRECT ) return;
+
+	//Average neighbouring columns into the next level
+	for(int l = 1; l <= levels; l++)
+	{
+		const rowMatrixXf &fine = data.pyramid[l-1];
+		rowMatrixXf &coarse = data.pyramid[l];
+		coarse.resize(m_lengthOfScan, fine.cols()/2);
+
+		for(int i = 0; i < coarse.rows(); i++)
 		{
-			shiftX = colM;
+			for(int j = 0; j < coarse.cols(); j++)
+			{
+				coarse(i,j) = 0.5f*(fine(i,2*j) + fine(i,2*j+1));
+			}
 		}
-	
-		//Track shift
-		vShiftX[i-1] = shiftX; 
-		vShiftY[i-1] = shiftY;
+	}
 
-		//Track total shift
-		totalShiftX += shiftX;
-		totalShiftY += shiftY;
+	//Spectrum of the coarsest level
+	const rowMatrixXf &top = data.pyramid[levels];
+	fft[levels].resize(top.rows(), top.cols());
+	data.spectrum.resize(top.rows(), fft[levels].spectrumCols());
+	fft[levels].forward(top, data.spectrum);
 
-		//Track shift deviation
-		if( totalShiftX > maxXShift ) maxXShift = totalShiftX;
-		if( totalShiftX < minXShift ) minXShift = totalShiftX;
-		
-		if( totalShiftY > maxYShift ) maxYShift = totalShiftY;
-		if( totalShiftY < minYShift ) minYShift = totalShiftY;
-		//Set next line to current line
-		currentLine = nextLine;
+	//The cross-power spectrum of whitened levels is already normalized
+	if( m_phaseCorrelation )
+	{
+		for(int l = 0; l < levels; l++)
+		{
+			fft[l].resize(data.pyramid[l].rows(), data.pyramid[l].cols());
+			fft[l].whiten(data.pyramid[l]);
+		}
 	}
+}
 
-	//Make sure we start at 0,0
-	if (minYShift > 0) minYShift = 0;
-	if (minXShift > 0) minXShift = 0;
+//Match two prepared lines
+void lineRegistration::matchLines(std::vector<fftWorkspace> &fft, const lineData &current, const lineData &next,
+		Eigen::MatrixXcf &product, Eigen::MatrixXf &correlation, lineShift &shift)
+{
+	//Search the shift window directly
+	if( m_lastEngine == ENGINE_DIRECT )
+	{
+		directShift(current.pyramid[0], next.pyramid[0], correlation, shift);
+		return;
+	}
 
-	//Calculate nominal size
-	int nomY = m_lengthOfScan + (maxYShift - minYShift);
-	int nomX = image.cols() + (maxXShift - minXShift);
+	int levels = static_cast<int>(next.pyramid.size()) - 1;
+	const rowMatrixXf &top = next.pyramid[levels];
+
+	//Coarse estimate from the spectra, with the shift limit scaled to the level
+	int maxShift = (m_maxShift > 0) ? (m_maxShift + (1 << levels) - 1) >> levels : 0;
+	product.resize(current.spectrum.rows(), current.spectrum.cols());
+	correlation.resize(top.rows(), top.cols());
+	estimateShift(fft[levels], current.spectrum, next.spectrum, product, correlation, maxShift, shift);
+	if( levels == 0 ) return;
+
+	//Refine at each finer level with a local search around twice the coarser shift
+	int shiftX = static_cast<int>(std::lround(shift.x));
+	int shiftY = static_cast<int>(std::lround(shift.y));
+	float scores[3][3];
+	for(int l = levels - 1; l >= 0; l--)
+	{
+		shiftX *= 2;
+		maxShift = (m_maxShift > 0) ? (m_maxShift + (1 << l) - 1) >> l : 0;
+		refineShift(current.pyramid[l], next.pyramid[l], maxShift, shiftX, shiftY, scores);
+	}
 
-	/**TODO: There must be a better way to do this without making a 
-	 * new matrix */
-	//Register image using shifts
-	Eigen::MatrixXi regImage = Eigen::MatrixXi::Zero(nomY, nomX);
-	
-	//Determine starting position in X (assuming 0 for y)
-	int posX, posY;
-	(minXShift > 0) ? posX = 0 : posX = -1*minXShift; 
-	(minYShift > 0) ? posY = 0 : posY = -1*minYShift; 
+	//Keep Y within the lag range of the spectra
+	int halfRow = m_lengthOfScan/2;
+	if( shiftY > halfRow ) shiftY -= m_lengthOfScan;
+	if( shiftY < halfRow + 1 - m_lengthOfScan ) shiftY += m_lengthOfScan;
+
+	shift.x = shiftX;
+	shift.y = shiftY;
 
-	//Copy data
-	regImage.block(posY, posX, m_lengthOfScan, image.cols()) =
-		image.block( 0, 0, m_lengthOfScan, image.cols());
-	for(size_t i = 0; i < vShiftX.size(); i++)
+	if( m_phaseCorrelation )
 	{
-		//Update pos
-		posY += vShiftY[i];
-		posX += vShiftX[i];
+		//Fit the peak from the scores around it, confidence is kept from the coarse peak
+		shift.y += subPixelOffset(scores[0][1], scores[1][1], scores[2][1]);
+		shift.x += subPixelOffset(scores[1][0], scores[1][1], scores[1][2]);
+	}
+}
 
-		//Copy data
-		regImage.block(posY, posX, m_lengthOfScan, image.cols()) = 
-			image.block( m_lengthOfScan*(i+1), 0, m_lengthOfScan, image.cols());
+//Direct search of the shift window
+void lineRegistration::directShift(const rowMatrixXf &current, const rowMatrixXf &next, Eigen::MatrixXf &costs, lineShift &shift)
+{
+	int rows = current.rows();
+	int cols = current.cols();
+	int minShiftY = m_lengthOfScan/2 + 1 - m_lengthOfScan;
+	int maxShiftY = m_lengthOfScan/2;
+	int maxShift = directWindow(cols);
+
+	//Mean absolute difference of current(r + dy, c + dx) and next(r, c) over the overlap
+	costs.resize(maxShiftY - minShiftY + 1, 2*maxShift + 1);
+	Eigen::MatrixXf::Index rowM = 0, colM = 0;
+	for(int dy = minShiftY; dy <= maxShiftY; dy++)
+	{
+		int startRow = std::max(0, -dy);
+		int endRow = std::min(rows, rows - dy);
 
+		for(int dx = -maxShift; dx <= maxShift; dx++)
+		{
+			int startCol = std::max(0, -dx);
+			int endCol = std::min(cols, cols - dx);
+
+			float sum = 0;
+			for(int r = startRow; r < endRow; r++)
+			{
+				sum += sumAbsDiff(current.data() + (r + dy)*cols + startCol + dx,
+						next.data() + r*cols + startCol, endCol - startCol);
+			}
+
+			float cost = sum/(static_cast<float>(endRow - startRow)*(endCol - startCol));
+			costs(dy - minShiftY, dx + maxShift) = cost;
+
+			if( cost < costs(rowM, colM) )
+			{
+				rowM = dy - minShiftY;
+				colM = dx + maxShift;
+			}
+		}
 	}
 
-	//Replace image
-	image = regImage;
-	return true;
+	shift.x = colM - maxShift;
+	shift.y = rowM + minShiftY;
+	shift.confidence = 0;
+
+	if( m_phaseCorrelation )
+	{
+		//Fit the lowest cost from its neighbours, where the window has them
+		if( rowM > 0 && rowM + 1 < costs.rows() )
+		{
+			shift.y += subPixelOffset(-costs(rowM-1, colM), -costs(rowM, colM), -costs(rowM+1, colM));
+		}
+		if( colM > 0 && colM + 1 < costs.cols() )
+		{
+			shift.x += subPixelOffset(-costs(rowM, colM-1), -costs(rowM, colM), -costs(rowM, colM+1));
+		}
+
+		//How far the best cost stands below the average of the window
+		float mean = costs.mean();
+		shift.confidence = (mean > 0) ? std::max(0.0f, 1.0f - costs(rowM, colM)/mean) : 0;
+	}
 }
 
-/**<TODO: This subsetting method uses too much memory, need to find a better way */
-//Private functions
-void lineRegistration::subsetImage(int startRow, int startCol, int rows, int cols, Eigen::MatrixXi &image, Eigen::MatrixXf &sub)
+//Local search for the best shift
+void lineRegistration::refineShift(const rowMatrixXf &current, const rowMatrixXf &next, int maxShift,
+		int &shiftX, int &shiftY, float scores[3][3])
 {
-	//Subset image
-	for(int i = 0; i < rows; i++)
+	//Climb until the best score is in the middle of the window
+	const int maxSteps = 8;
+	for(int step = 0; step < maxSteps; step++)
 	{
-		for( int j = 0; j < cols; j++)
+		int bestI = 1, bestJ = 1;
+		for(int i = 0; i < 3; i++)
 		{
-			sub(i,j) = static_cast<float>(image(startRow+i,startCol+j));
+			for(int j = 0; j < 3; j++)
+			{
+				int dx = shiftX + j - 1;
+				int dy = shiftY + i - 1;
+
+				if( maxShift > 0 && std::abs(dx) > maxShift )
+				{
+					scores[i][j] = -std::numeric_limits<float>::max();
+				}else
+				{
+					scores[i][j] = correlateAt(current, next, dy, dx);
+				}
+			}
 		}
+
+		//Find best, ties go to the middle
+		for(int i = 0; i < 3; i++)
+		{
+			for(int j = 0; j < 3; j++)
+			{
+				if( scores[i][j] > scores[bestI][bestJ] )
+				{
+					bestI = i;
+					bestJ = j;
+				}
+			}
+		}
+
+		if( bestI == 1 && bestJ == 1 ) return;
+		shiftX += bestJ - 1;
+		shiftY += bestI - 1;
 	}
 }
 
-/**<TODO: Better memory management with this function */
-//Foward 2d FFT
-void lineRegistration::fft2dFwd(Eigen::MatrixXf &mat, Eigen::MatrixXcf &matCF)
+//Circular cross-correlation at one lag
+float lineRegistration::correlateAt(const rowMatrixXf &current, const rowMatrixXf &next, int shiftY, int shiftX)
 {
-	//Define FFT function
-	Eigen::FFT<float> fft;
+	int rows = current.rows();
+	int cols = current.cols();
 
-	int nRows = mat.rows();
-	int nCols = mat.cols();
+	//Wrap the lag as the spectra do
+	int sy = ((shiftY % rows) + rows) % rows;
+	int sx = ((shiftX % cols) + cols) % cols;
 
-	//Perform ft on rows then cols
-	for(size_t k = 0; k < mat.rows(); k++)
+	//Sum of current(r + sy, c + sx) * next(r, c), split where the columns wrap
+	float sum = 0;
+	for(int r = 0; r < rows; r++)
 	{
-		Eigen::VectorXcf tmpOut(nCols);
-		fft.fwd(tmpOut, mat.row(k));
-		matCF.row(k) = tmpOut;
+		const float *rowCurrent = current.data() + ((r + sy) % rows)*cols;
+		const float *rowNext = next.data() + r*cols;
+
+		sum += Eigen::Map<const Eigen::VectorXf>(rowCurrent + sx, cols - sx).dot(
+				Eigen::Map<const Eigen::VectorXf>(rowNext, cols - sx));
+		sum += Eigen::Map<const Eigen::VectorXf>(rowCurrent, sx).dot(
+				Eigen::Map<const Eigen::VectorXf>(rowNext + cols - sx, sx));
 	}
 
-	for(size_t k=0; k < mat.cols(); k++)
+	//Weigh out the overlap in Y as the phase correlation surface does
+	if( m_phaseCorrelation )
 	{
-		Eigen::VectorXcf tmpOut(nRows);
-		fft.fwd(tmpOut, matCF.col(k));
-		matCF.col(k) = tmpOut;
+		int lag = (sy > m_lengthOfScan/2) ? sy - m_lengthOfScan : sy;
+		sum *= static_cast<float>(rows)/(rows - std::abs(lag));
 	}
-}
 
-/**<TODO: Better memory management with this function */
-//Inverse 2d FFT
+	return sum;
+}
 
-void lineRegistration::fft2dInv(Eigen::MatrixXcf &matCF, Eigen::MatrixXf &mat)
+//Estimate shift between neighbouring lines
+void lineRegistration::estimateShift(fftWorkspace &fft, const Eigen::MatrixXcf &current, const Eigen::MatrixXcf &next,
+		Eigen::MatrixXcf &product, Eigen::MatrixXf &correlation, int maxShiftX, lineShift &shift)
 {
-	//Define FFT function
-	Eigen::FFT<float> fft;
+	//Vars for shifts
+	int halfRow = m_lengthOfScan/2;
+	int halfCol = correlation.cols()/2;
+
+	//Do correlation
+	product = current.cwiseProduct( next.conjugate() ); // CC = A*conj(B)
+
+	if( m_phaseCorrelation )
+	{
+		//Keep only the phase of the cross-power spectrum
+		for(int k = 0; k < product.size(); k++)
+		{
+			float mag = std::abs(product(k));
+			product(k) = (mag > 1e-12f) ? product(k) / mag : std::complex<float>(0, 0);
+		}
+	}else
+	{
+		product *= static_cast<float>(correlation.size()); // Scale
+	}
 	
-	int nRows = mat.rows();
-	int nCols = mat.cols();
+	//Do inverse fft
+	fft.resize(correlation.rows(), correlation.cols());
+	fft.inverse(product, correlation);
 
-	//Perform ft on rows then cols
-	for(size_t k = 0; k < mat.rows(); k++)
+	if( m_phaseCorrelation )
 	{
-		Eigen::VectorXcf tmpOut(nCols);
-		fft.inv(tmpOut, matCF.row(k));
-		matCF.row(k) = tmpOut;
+		//Only L - |dy| rows overlap at a lag of dy, weigh that out so short lags are not favoured
+		for(int k = 0; k < correlation.rows(); k++)
+		{
+			int lag = (k > halfRow) ? k - m_lengthOfScan : k;
+			correlation.row(k) *= static_cast<float>(m_lengthOfScan)/(m_lengthOfScan - std::abs(lag));
+		}
 	}
 
-	for(size_t k=0; k < mat.cols(); k++)
+	//Peak value will correspond to match
+	//Shift can be caculated assuming scans are shifted from center
+	Eigen::MatrixXf::Index rowM, colM;
+	float peak;
+	if( maxShiftX > 0 && 2*maxShiftX + 1 < correlation.cols() )
 	{
-		Eigen::VectorXf tmpOut(nRows);
-		fft.inv(tmpOut, matCF.col(k));
-		mat.col(k) = tmpOut;
+		//Only search the columns within the shift limit, either side of 0
+		Eigen::MatrixXf::Index rowH, colH;
+		peak = correlation.leftCols(maxShiftX + 1).maxCoeff( &rowM, &colM);
+		float peakH = correlation.rightCols(maxShiftX).maxCoeff( &rowH, &colH);
+		if( peakH > peak )
+		{
+			peak = peakH;
+			rowM = rowH;
+			colM = colH + correlation.cols() - maxShiftX;
+		}
+	}else
+	{
+		peak = correlation.maxCoeff( &rowM, &colM);
+	}
+
+	//Calculate Shift
+	if( rowM > halfRow )
+	{
+		shift.y = rowM - m_lengthOfScan;
+	}else
+	{	
+		shift.y = rowM;
+	}
+
+	if( colM > halfCol )
+	{
+		shift.x = colM - correlation.cols();
+	}else
+	{
+		shift.x = colM;
+	}
+
+	shift.confidence = 0;
+	if( m_phaseCorrelation )
+	{
+		//Fit a parabola through the peak and its (wrapped) neighbours in each direction
+		int rows = correlation.rows();
+		int cols = correlation.cols();
+		shift.y += subPixelOffset(correlation((rowM + rows - 1) % rows, colM), peak,
+				correlation((rowM + 1) % rows, colM));
+		shift.x += subPixelOffset(correlation(rowM, (colM + cols - 1) % cols), peak,
+				correlation(rowM, (colM + 1) % cols));
+
+		//A pure shift gives a unit peak, noise spreads it out
+		shift.confidence = std::max(0.0f, std::min(1.0f, peak));
 	}
 }
 
+//Sub-pixel offset of a peak
+float lineRegistration::subPixelOffset(float before, float peak, float after)
+{
+	float denom = before - 2*peak + after;
+	if( denom >= 0 ) return 0;
+
+	float offset = 0.5f*(before - after)/denom;
+	return std::max(-0.5f, std::min(0.5f, offset));
+}
+
+//Private functions
+template<typename Image>
+void lineRegistration::subsetImage(int startRow, int startCol, int rows, int cols, const Image &image, rowMatrixXf &sub)
+{
+	//Subset image, a contiguous run per row for row-major images
+	sub = image.block(startRow, startCol, rows, cols).template cast<float>();
+}
+
+//Supported scan types
+template bool lineRegistration::registerLines(Eigen::MatrixXi &image);
+template bool lineRegistration::registerLines(image8u &image);
+template bool lineRegistration::registerLines(image16u &image);
+template bool lineRegistration::registerLines(const Eigen::MatrixXi &image, registeredImage &view);
+template bool lineRegistration::registerLines(const image8u &image, registeredImage8u &view);
+template bool lineRegistration::registerLines(const image16u &image, registeredImage16u &view);
+template bool lineRegistration::registerLines(const Eigen::MatrixXi &image, registeredImage &view, workspace &work);
+template bool lineRegistration::registerLines(const image8u &image, registeredImage8u &view, workspace &work);
+template bool lineRegistration::registerLines(const image16u &image, registeredImage16u &view, workspace &work);
+template void lineRegistration::prepareLine(std::vector<fftWorkspace> &fft, const Eigen::MatrixXi &image, int line, lineData &data);
+
 } // End namespace fpTools
@@ -14,22 +14,77 @@
 //Eigen3
 #include <Eigen/Core>
 
+//fpTools
+#include "fpTools/fftWorkspace.h"
+#include "fpTools/registeredImage.h"
+
+//STL
+#include <vector>
+
 #ifndef LINEREGISTRATION_H
 #define LINEREGISTRATION_H
 
 namespace fpTools{
+/*!
+ *  \brief  Shift of a scanline relative to the one before it
+ */
+struct lineShift
+{
+	float x; /**< Shift in X in pixels */
+	float y; /**< Shift in Y in pixels */
+	float confidence; /**< Height of the phase correlation peak, 0 to 1, 0 when not measured */
+};
+
+/*!
+ *  \brief  Method used to find the shift between neighbouring scanlines
+ */
+enum registrationEngine
+{
+	ENGINE_AUTO = 0, /**< Pick by the cost model, needs a maximum shift to consider ENGINE_DIRECT */
+	ENGINE_FFT, /**< Correlation by FFT, optionally coarse-to-fine */
+	ENGINE_DIRECT /**< Vectorized absolute difference search over the shift window */
+};
+
 /*!
  *  \brief  Class to handle registration of scanlines
  */
 class lineRegistration
 {
+	protected:
+		/*!
+		 *  \brief  Scanline prepared for matching
+		 */
+		struct lineData
+		{
+			std::vector<rowMatrixXf> pyramid; /**< Scanline as float, halving in width per level */
+			Eigen::MatrixXcf spectrum; /**< Half spectrum of the coarsest level */
+		};
+
 	public:
+		/*!
+		 *  \brief  Buffers used while registering, kept by the caller between images
+		 *
+		 *  Each buffer is sized on first use and reused after, so once warmed up registering
+		 *  scans of the same size does not allocate. Threads started for the parallel path
+		 *  still allocate their stacks. A workspace serves one registration at a time.
+		 */
+		struct workspace
+		{
+			std::vector< std::vector<fftWorkspace> > fft; /**< FFT plans and scratch, one per pyramid level for each thread */
+			std::vector<lineData> lines; /**< Prepared scanlines, the current and next when serial, all of them when parallel */
+			std::vector<Eigen::MatrixXcf> product; /**< Cross-power spectrum, one per thread */
+			std::vector<Eigen::MatrixXf> correlation; /**< Correlation surface or lag costs, one per thread */
+			std::vector<int> posX; /**< Column of each scanline */
+			std::vector<int> posY; /**< Row of each scanline */
+		};
+
 		/* ====================  LIFECYCLE     ======================================= */
 		
 		/*!
 		 *  \brief  Default constructor
 		 */
-		lineRegistration(){}
+		lineRegistration() : m_numThreads(1), m_phaseCorrelation(false), m_maxShift(0), m_pyramidLevels(0),
+			m_engine(ENGINE_AUTO), m_lastEngine(ENGINE_FFT) {}
 
 		/*!
 		 *  \brief  Constructor
@@ -47,6 +102,64 @@ class lineRegistration
 		 */
 		int getLengthOfScan(){return m_lengthOfScan;}
 
+		/*!
+		 *  \brief  Get number of threads used by registerLines
+		 *  
+		 *  \return Number of threads, 0 for all cores
+		 */
+		int getNumThreads(){return m_numThreads;}
+
+		/*!
+		 *  \brief  Get if phase correlation is used
+		 *  
+		 *  \return True for normalized, sub-pixel phase correlation
+		 */
+		bool getPhaseCorrelation(){return m_phaseCorrelation;}
+
+		/*!
+		 *  \brief  Get the shifts found by the last call to registerLines
+		 *  
+		 *  \return One shift per scanline after the first
+		 */
+		const std::vector<lineShift>& getShifts(){return m_shifts;}
+
+		/*!
+		 *  \brief  Get largest shift in X considered between neighbouring scanlines
+		 *  
+		 *  \return Shift in pixels, 0 for any
+		 */
+		int getMaxShift(){return m_maxShift;}
+
+		/*!
+		 *  \brief  Get number of coarse-to-fine pyramid levels
+		 *  
+		 *  \return Levels, 0 for an exhaustive search at full resolution
+		 */
+		int getPyramidLevels(){return m_pyramidLevels;}
+
+		/*!
+		 *  \brief  Get the requested engine
+		 *  
+		 *  \return The engine, ENGINE_AUTO to let the cost model pick
+		 */
+		registrationEngine getEngine(){return m_engine;}
+
+		/*!
+		 *  \brief  Get the engine used by the last registration
+		 *  
+		 *  \return ENGINE_FFT or ENGINE_DIRECT
+		 */
+		registrationEngine getLastEngine(){return m_lastEngine;}
+
+		/*!
+		 *  \brief  Get the engine that would be used for a scanline width
+		 *  
+		 *  \param  cols int Width of the scanlines
+		 *
+		 *  \return ENGINE_FFT or ENGINE_DIRECT
+		 */
+		registrationEngine selectEngine(int cols);
+
 		/* ====================  MUTATORS      ======================================= */
 
 		/*!
@@ -55,66 +168,291 @@ class lineRegistration
 		 *  \param  lengthOfScan int The scanlength in pixels
 		 */
 		void setLengthOfScan(int lengthOfScan){m_lengthOfScan = lengthOfScan;}
+
+		/*!
+		 *  \brief  Set number of threads used by registerLines
+		 *  
+		 *  \param  numThreads int Number of threads, 1 for serial, 0 for all cores
+		 *
+		 *  With more than one thread the spectra of all scanlines are computed first,
+		 *  then all neighbouring pairs are correlated. The result is identical to the
+		 *  serial path, at the cost of holding every spectrum at once.
+		 */
+		void setNumThreads(int numThreads){m_numThreads = numThreads;}
+
+		/*!
+		 *  \brief  Set if phase correlation is used
+		 *  
+		 *  \param  phaseCorrelation bool True to normalize the cross-power spectrum and fit
+		 *  		the peak to sub-pixel accuracy, false for plain cross-correlation
+		 *
+		 *  Sub-pixel shifts are summed before rounding the scanline positions, and each
+		 *  shift reports the peak height as its confidence.
+		 */
+		void setPhaseCorrelation(bool phaseCorrelation){m_phaseCorrelation = phaseCorrelation;}
+
+		/*!
+		 *  \brief  Set largest shift in X considered between neighbouring scanlines
+		 *  
+		 *  \param  maxShift int Shift in pixels, 0 for any
+		 *
+		 *  The direct engine limits it further so every lag overlaps enough of the
+		 *  scanlines, see directWindow().
+		 */
+		void setMaxShift(int maxShift){m_maxShift = maxShift;}
+
+		/*!
+		 *  \brief  Set number of coarse-to-fine pyramid levels
+		 *  
+		 *  \param  pyramidLevels int Levels, 0 for an exhaustive search at full resolution
+		 *
+		 *  Each level halves the scanline width. The shift is found by FFT on the coarsest
+		 *  level, then refined at every finer level by a local search of the spatial
+		 *  correlation, which costs a handful of dot products rather than a full size FFT.
+		 */
+		void setPyramidLevels(int pyramidLevels){m_pyramidLevels = pyramidLevels;}
+
+		/*!
+		 *  \brief  Set the engine used to find the shifts
+		 *  
+		 *  \param  engine registrationEngine The engine, ENGINE_AUTO to let the cost model pick
+		 *
+		 *  The direct engine searches every lag in Y and every lag in X up to the maximum
+		 *  shift for the lowest mean absolute difference over the overlap. It needs a
+		 *  maximum shift, without one the FFT engine is always used. The cost model weighs
+		 *  the size of that window against the FFT size and pyramid levels.
+		 */
+		void setEngine(registrationEngine engine){m_engine = engine;}
 		/* ====================  OPERATORS     ======================================= */
 		
 		/*!
 		 *  \brief  Function to register multiple line scans contained in a single 2D array
 		 *		in which the scans are stacked in a column
 		 *  
-		 *  \param[in,out]  image Eigen::MatrixXi The 2d array which contains the unregistered scans,
+		 *  \param[in,out]  image Image The 2d array which contains the unregistered scans,
 		 *  					will be replaced by registered scans
 		 *
 		 *  \return bool If the registration was succesful, 
 		 *  		will return false if one scanline fails to register well.
+		 *
+		 *  Image is Eigen::MatrixXi, image8u or image16u. The registered image and the view of
+		 *  it are allocated on every call, only the overload with a workspace and a view kept
+		 *  by the caller runs without allocating.
 		 */
-		bool registerLines(Eigen::MatrixXi &image);
+		template<typename Image>
+		bool registerLines(Image &image);
+
+		/*!
+		 *  \brief  Function to register multiple line scans without copying them
+		 *  
+		 *  \param[in]  image Image The 2d array which contains the unregistered scans,
+		 *  					must outlive the view
+		 *  \param[out] view basicRegisteredImage View of the registered scans, the offset of each
+		 *  					scanline into the original buffer
+		 *
+		 *  \return bool If the registration was succesful
+		 *
+		 *  Image is Eigen::MatrixXi, image8u or image16u.
+		 */
+		template<typename Image>
+		bool registerLines(const Image &image, basicRegisteredImage<Image> &view);
+
+		/*!
+		 *  \brief  Function to register multiple line scans without copying them, in a workspace
+		 *
+		 *  \param[in]  image Image The 2d array which contains the unregistered scans,
+		 *  					must outlive the view
+		 *  \param[out] view basicRegisteredImage View of the registered scans, its buffers are reused
+		 *  \param  work workspace Buffers for the registration, reused from call to call
+		 *
+		 *  \return bool If the registration was succesful
+		 *
+		 *  With the view and the workspace kept from the last image, and the registered image
+		 *  materialized into a buffer of the same size, nothing is allocated on one thread.
+		 */
+		template<typename Image>
+		bool registerLines(const Image &image, basicRegisteredImage<Image> &view, workspace &work);
 
 	protected:
 		/* ====================  METHODS       ======================================= */
 
-		/* ====================  DATA MEMBERS  ======================================= */
+		/*!
+		 *  \brief  Shifts between neighbouring scanlines, one scanline at a time
+		 *  
+		 *  \param[in]  image Image The stacked scanlines
+		 *  \param  work workspace Buffers for the shifts
+		 *  \param[out] shifts std::vector<lineShift> Shift of each scanline to the one before, sized by caller
+		 */
+		template<typename Image>
+		void computeShifts(const Image &image, workspace &work, std::vector<lineShift> &shifts);
 
-	private:
-		/* ====================  METHODS       ======================================= */
-	
-		
 		/*!
-		 *  \brief  Subset eigen matrix into another matrix (because block is prohibitive to addtional operations)
+		 *  \brief  Shifts between neighbouring scanlines, spread over m_numThreads threads
 		 *  
-		 *  \param  startRow int The starting row to subset
-		 *  \param  startCol int The starting column to subset
-		 *  \param  rows int The number of rows to subset
-		 *  \param  cols int The number of cols to subset
-		 *  \param[in] image Eigen::MatrixXi The image to subset
-		 *  \param[out] sub Eigen::MatrixXi The subsetted part of the image
+		 *  \param[in]  image Image The stacked scanlines
+		 *  \param  work workspace Buffers for the shifts
+		 *  \param[out] shifts std::vector<lineShift> Shift of each scanline to the one before, sized by caller
+		 */
+		template<typename Image>
+		void computeShiftsParallel(const Image &image, workspace &work, std::vector<lineShift> &shifts);
+
+		/*!
+		 *  \brief  Size the per-thread buffers of a workspace, never shrinking them
 		 *
-		 *  User needs to init sub size
+		 *  \param  work workspace The workspace
+		 *  \param  numThreads int Threads that will use it
+		 *  \param  numLines int Prepared scanlines needed
 		 */
-		void subsetImage(int startRow, int startCol, int rows, int cols, Eigen::MatrixXi &image, Eigen::MatrixXf &sub);
+		static void reserveWorkspace(workspace &work, int numThreads, int numLines);
 
 		/*!
-		 *  \brief  Performs foward 2d FFT
+		 *  \brief  Prepare a scanline for matching, subset, pyramid and spectrum
 		 *  
-		 *  \param[in]  mat Eigen::Block<int> Input int matrix (subset from mat)
-		 *  \param[out] matCF Eigen::MatrixXcf Output complex float matrix 
+		 *  With phase correlation the levels finer than the coarsest are whitened, so the
+		 *  local search scores the same normalized correlation as the spectra.
 		 *
-		 *  User responsible for sizing matCF
+		 *  \param  fft std::vector<fftWorkspace> Workspace for the transforms of each level,
+		 *  		grown to the levels used
+		 *  \param[in]  image Image The stacked scanlines
+		 *  \param  line int The scanline to prepare
+		 *  \param[out] data lineData The prepared scanline, buffers are reused
 		 */
-		void fft2dFwd(Eigen::MatrixXf &mat, Eigen::MatrixXcf &matCF);
+		template<typename Image>
+		void prepareLine(std::vector<fftWorkspace> &fft, const Image &image, int line, lineData &data);
 
+		/*!
+		 *  \brief  Find the shift between two prepared neighbouring scanlines
+		 *  
+		 *  \param  fft std::vector<fftWorkspace> Workspaces the scanlines were prepared with
+		 *  \param[in]  current lineData The current scanline
+		 *  \param[in]  next lineData The next scanline
+		 *  \param  product Eigen::MatrixXcf Scratch for the cross-power spectrum
+		 *  \param  correlation Eigen::MatrixXf Scratch for the correlation surface
+		 *  \param[out] shift lineShift Shift of the next scanline
+		 *
+		 *  With pyramid levels the spectra give a coarse shift which is refined level by
+		 *  level with a local search.
+		 */
+		void matchLines(std::vector<fftWorkspace> &fft, const lineData &current, const lineData &next,
+				Eigen::MatrixXcf &product, Eigen::MatrixXf &correlation, lineShift &shift);
 
 		/*!
-		 *  \brief  Performs inverse 2d FFT
+		 *  \brief  Estimate the shift between two neighbouring scanlines from their spectra
 		 *  
-		 *  \param[in]  matCF Eigen::MatrixXcf Input complex matrix
-		 *  \param[out] mat Eigen::MatrixXo Output int matrix 
+		 *  \param  fft fftWorkspace Workspace for the inverse transform
+		 *  \param[in]  current Eigen::MatrixXcf Half spectrum of the current scanline
+		 *  \param[in]  next Eigen::MatrixXcf Half spectrum of the next scanline
+		 *  \param[out] product Eigen::MatrixXcf Cross-power spectrum, sized as the spectra
+		 *  \param[out] correlation Eigen::MatrixXf Correlation surface, sized as a scanline
+		 *  \param  maxShiftX int Largest shift in X to consider, 0 for any
+		 *  \param[out] shift lineShift Shift of the next scanline
+		 */
+		void estimateShift(fftWorkspace &fft, const Eigen::MatrixXcf &current, const Eigen::MatrixXcf &next, 
+				Eigen::MatrixXcf &product, Eigen::MatrixXf &correlation, int maxShiftX, lineShift &shift);
+
+		/*!
+		 *  \brief  Find the shift by searching the shift window directly
+		 *  
+		 *  \param[in]  current rowMatrixXf The current scanline
+		 *  \param[in]  next rowMatrixXf The next scanline
+		 *  \param  costs Eigen::MatrixXf Scratch for the cost of every lag
+		 *  \param[out] shift lineShift Shift of the next scanline
+		 */
+		void directShift(const rowMatrixXf &current, const rowMatrixXf &next, Eigen::MatrixXf &costs, lineShift &shift);
+
+		/*!
+		 *  \brief  Largest shift in X the direct search considers for a scanline width
+		 *  
+		 *  \param  cols int Width of the scanlines
+		 *
+		 *  \return int The maximum shift, limited so every lag overlaps at least half the
+		 *  		scanline and minOverlapCols columns
+		 */
+		int directWindow(int cols);
+
+		/*!
+		 *  \brief  Number of pyramid levels used for a scanline width
+		 *  
+		 *  \param  cols int Width of the scanlines
+		 *
+		 *  \return int Levels, limited so the coarsest level is at least minPyramidCols wide
+		 */
+		int pyramidLevels(int cols);
+
+		/*!
+		 *  \brief  Move a shift to the best score of its 3x3 neighbourhood until it is a local peak
+		 *  
+		 *  \param[in]  current rowMatrixXf The current scanline
+		 *  \param[in]  next rowMatrixXf The next scanline
+		 *  \param  maxShift int Largest shift in X to consider, 0 for any
+		 *  \param[in,out] shiftX int Shift in X
+		 *  \param[in,out] shiftY int Shift in Y
+		 *  \param[out] scores float[3][3] Scores around the final shift, rows are Y
+		 */
+		void refineShift(const rowMatrixXf &current, const rowMatrixXf &next, int maxShift,
+				int &shiftX, int &shiftY, float scores[3][3]);
+
+		/*!
+		 *  \brief  Circular cross-correlation of two scanlines at a single lag
+		 *  
+		 *  \param[in]  current rowMatrixXf The current scanline
+		 *  \param[in]  next rowMatrixXf The next scanline
+		 *  \param  shiftY int Lag in Y
+		 *  \param  shiftX int Lag in X
+		 *
+		 *  \return float The same value the inverse FFT gives at that lag, the phase correlation
+		 *  		when the scanlines are whitened
+		 */
+		float correlateAt(const rowMatrixXf &current, const rowMatrixXf &next, int shiftY, int shiftX);
+
+		/*!
+		 *  \brief  Sub-pixel offset of a correlation peak from a parabola through three samples
+		 *  
+		 *  \param  before float Sample before the peak
+		 *  \param  peak float Peak sample
+		 *  \param  after float Sample after the peak
 		 *
-		 *  User responsible for sizing matCF
+		 *  \return float Offset from the peak sample, -0.5 to 0.5
 		 */
-		void fft2dInv(Eigen::MatrixXcf &matCF, Eigen::MatrixXf &mat);
+		static float subPixelOffset(float before, float peak, float after);
+
+		/*!
+		 *  \brief  Subset eigen matrix into another matrix (because block is prohibitive to addtional operations)
+		 *  
+		 *  \param  startRow int The starting row to subset
+		 *  \param  startCol int The starting column to subset
+		 *  \param  rows int The number of rows to subset
+		 *  \param  cols int The number of cols to subset
+		 *  \param[in] image Image The image to subset
+		 *  \param[out] sub rowMatrixXf The subsetted part of the image
+		 *
+		 *  User needs to init sub size
+		 */
+		template<typename Image>
+		void subsetImage(int startRow, int startCol, int rows, int cols, const Image &image, rowMatrixXf &sub);
 
 		/* ====================  DATA MEMBERS  ======================================= */
 		int m_lengthOfScan; /**< Length of scan */
+		std::vector<fftWorkspace> m_fft; /**< FFT plans and scratch for each pyramid level of the scanline size */
+		workspace m_workspace; /**< Buffers of registerLines when the caller gives none */
+		int m_numThreads; /**< Threads used by registerLines */
+		bool m_phaseCorrelation; /**< Normalize the cross-power spectrum and fit sub-pixel peaks */
+		int m_maxShift; /**< Largest shift in X between neighbouring scanlines, 0 for any */
+		int m_pyramidLevels; /**< Levels of coarse-to-fine search, 0 for exhaustive */
+		std::vector<lineShift> m_shifts; /**< Shifts found by the last registration */
+
+		registrationEngine m_engine; /**< Requested engine */
+		registrationEngine m_lastEngine; /**< Engine used by the last registration */
+
+		static const int minPyramidCols = 16; /**< Narrowest pyramid level */
+		static const int minOverlapCols = 16; /**< Fewest columns a direct search lag overlaps */
+		static const double fftCostFactor; /**< Cost of the FFT path per sample per log2 of the size */
+		static const double directCostFactor; /**< Cost of the direct path per vector of samples per lag */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
 }; /* -----  end of class LineRegistration  ----- */
 
 } // End namespace fpTools
@@ -0,0 +1,155 @@
+/*!
+ *    \file  lineRegistrationStream.cpp
+ *   \brief  Implimentation of streaming line registration class
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+//STL
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools/lineRegistrationStream.h"
+
+namespace fpTools{
+
+//Constructor
+lineRegistrationStream::lineRegistrationStream(int lengthOfScan, int cols, int maxDriftX) :
+	lineRegistration(lengthOfScan), m_cols(cols), m_maxDriftX(maxDriftX)
+{
+	reset();
+}
+
+//Reset for a new swipe
+void lineRegistrationStream::reset()
+{
+	//Output geometry
+	m_outCols = m_cols + 2*m_maxDriftX;
+	m_minStepY = m_lengthOfScan/2 + 1 - m_lengthOfScan;
+
+	//Positions
+	m_lines = 0;
+	m_posX = m_maxDriftX;
+	m_posY = 0;
+	m_totalX = 0;
+	m_totalY = 0;
+	m_lastShift.x = 0;
+	m_lastShift.y = 0;
+	m_lastShift.confidence = 0;
+	m_emitted = 0;
+	m_committed = 0;
+	m_written = 0;
+
+	//Ring, the line buffers are sized by the first scanline
+	m_ring = Eigen::MatrixXi::Zero(2*m_lengthOfScan, m_outCols);
+}
+
+//Push next scanline
+bool lineRegistrationStream::pushScanline(const Eigen::MatrixXi &scan)
+{
+	//Check bounds
+	if( scan.rows() != m_lengthOfScan || scan.cols() != m_cols )
+	{
+		std::cerr << "LineRegStream: Scanline size incorrect" << std::endl;
+		return false;
+	}
+
+	//Make sure the furthest the scanline can land still fits in the ring
+	if( m_lines > 0 && m_posY + m_lengthOfScan/2 + m_lengthOfScan - m_emitted > m_ring.rows() )
+	{
+		std::cerr << "LineRegStream: Registered rows not popped" << std::endl;
+		return false;
+	}
+
+	//Engine for this swipe, settings may change between swipes
+	if( m_lines == 0 ) m_lastEngine = selectEngine(m_cols);
+
+	//Spectrum of the incoming line
+	prepareLine(m_fft, scan, 0, m_nextLine);
+
+	//Correlate with previous line
+	if( m_lines > 0 )
+	{
+		matchLines(m_fft, m_prevLine, m_nextLine, m_product, m_correlation, m_lastShift);
+
+		//Round the running total so sub-pixel shifts do not drift
+		m_totalX += m_lastShift.x;
+		m_totalY += m_lastShift.y;
+		m_posX = m_maxDriftX + static_cast<int>(std::lround(m_totalX));
+
+		//A sub-pixel peak at the edge of the lag range can round one row past it, keep each
+		//step within the range the ring and the released rows are sized for
+		int stepY = static_cast<int>(std::lround(m_totalY)) - m_posY;
+		m_posY += std::max(m_minStepY, std::min(m_lengthOfScan/2, stepY));
+	}
+
+	//Copy data
+	placeScanline(scan);
+
+	//Keep only this line's spectrum
+	std::swap(m_prevLine, m_nextLine);
+	m_lines++;
+
+	//Release the rows no following line can reach
+	int reach = std::min(m_posY + m_minStepY, m_written);
+	if( reach > m_committed ) m_committed = reach;
+
+	return true;
+}
+
+//Pop next registered row
+bool lineRegistrationStream::popRow(Eigen::RowVectorXi &row)
+{
+	if( m_emitted >= m_committed ) return false;
+
+	row = m_ring.row(m_emitted % m_ring.rows());
+	m_emitted++;
+
+	return true;
+}
+
+//End of swipe
+void lineRegistrationStream::finish()
+{
+	m_committed = m_written;
+}
+
+//Place scanline in ring
+void lineRegistrationStream::placeScanline(const Eigen::MatrixXi &scan)
+{
+	int ringRows = m_ring.rows();
+
+	//Clear rows entering the ring
+	for(int y = m_written; y < m_posY + m_lengthOfScan; y++)
+	{
+		m_ring.row(y % ringRows).setZero();
+	}
+	if( m_posY + m_lengthOfScan > m_written ) m_written = m_posY + m_lengthOfScan;
+
+	//Crop columns that drifted outside of the output
+	int startCol = std::max(0, -m_posX);
+	int endCol = std::min(m_cols, m_outCols - m_posX);
+	if( endCol <= startCol ) return;
+
+	for(int i = 0; i < m_lengthOfScan; i++)
+	{
+		//Skip rows that were already released
+		int y = m_posY + i;
+		if( y < m_committed ) continue;
+
+		m_ring.row(y % ringRows).segment(m_posX + startCol, endCol - startCol) =
+			scan.row(i).segment(startCol, endCol - startCol);
+	}
+}
+
+} // End namespace fpTools
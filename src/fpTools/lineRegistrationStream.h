@@ -0,0 +1,146 @@
+/*!
+ *    \file  lineRegistrationStream.h
+ *   \brief  Class to handle push-style registration of scanlines as they arrive
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools/lineRegistration.h"
+
+#ifndef LINEREGISTRATIONSTREAM_H
+#define LINEREGISTRATIONSTREAM_H
+
+namespace fpTools{
+/*!
+ *  \brief  Class to register scanlines one at a time with bounded memory
+ *
+ *  Scanlines are pushed as they come off the sensor. Only the previous scanline,
+ *  prepared for matching, and a ring of 2*lengthOfScan output rows are kept. A registered row is
+ *  released once no following scanline can be placed over it, which is one worst-case
+ *  backward shift above the most recent scanline. Rows released this way are final,
+ *  a swipe that later backs up further is clipped against them.
+ *
+ *  The output has a fixed width of cols + 2*maxDriftX with the first scanline centred,
+ *  columns drifting outside of it are cropped.
+ */
+class lineRegistrationStream : public lineRegistration
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Constructor
+		 *
+		 *  \param  lengthOfScan int The length of the scanline in pixels, defined by the hardware
+		 *  \param  cols int The width of the scanline in pixels
+		 *  \param  maxDriftX int The maximum total drift in X kept on either side of the first scanline
+		 */
+		lineRegistrationStream (int lengthOfScan, int cols, int maxDriftX);   /* constructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get the width of the registered output rows
+		 *
+		 *  \return Output width in pixels
+		 */
+		int getOutputCols(){return m_outCols;}
+
+		/*!
+		 *  \brief  Get the number of registered rows ready to be popped
+		 *
+		 *  \return Number of rows
+		 */
+		int rowsAvailable(){return m_committed - m_emitted;}
+
+		/*!
+		 *  \brief  Get the shift of the last scanline pushed relative to the one before
+		 *
+		 *  \return The shift and its confidence
+		 */
+		const lineShift& getLastShift(){return m_lastShift;}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Reset the stream to start a new swipe
+		 */
+		void reset();
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Push the next scanline of the swipe
+		 *
+		 *  \param[in]  scan Eigen::MatrixXi The scanline, lengthOfScan x cols
+		 *
+		 *  \return bool False if the scanline has the wrong size or the available
+		 *  		rows have not been popped
+		 */
+		bool pushScanline(const Eigen::MatrixXi &scan);
+
+		/*!
+		 *  \brief  Pop the next registered row
+		 *
+		 *  \param[out] row Eigen::RowVectorXi The registered row, sized to getOutputCols()
+		 *
+		 *  \return bool False if no row is ready
+		 */
+		bool popRow(Eigen::RowVectorXi &row);
+
+		/*!
+		 *  \brief  Mark the end of the swipe, releasing all remaining rows
+		 */
+		void finish();
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/*!
+		 *  \brief  Copy a scanline into the ring of pending rows at the current position
+		 *
+		 *  \param[in]  scan Eigen::MatrixXi The scanline to place
+		 */
+		void placeScanline(const Eigen::MatrixXi &scan);
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		int m_cols; /**< Width of the scanlines */
+		int m_maxDriftX; /**< Drift in X kept on either side */
+		int m_outCols; /**< Width of the output rows */
+		int m_minStepY; /**< Most negative shift in Y between two scanlines */
+		int m_lines; /**< Number of scanlines pushed */
+		int m_posX; /**< Position of the last scanline in X */
+		int m_posY; /**< Position of the last scanline in Y */
+		float m_totalX; /**< Running total of the shifts in X */
+		float m_totalY; /**< Running total of the shifts in Y */
+		lineShift m_lastShift; /**< Shift of the last scanline */
+		int m_emitted; /**< Rows popped so far */
+		int m_committed; /**< Rows released so far */
+		int m_written; /**< Rows touched so far */
+
+		Eigen::MatrixXi m_ring; /**< Ring of pending output rows */
+		Eigen::MatrixXcf m_product; /**< Cross-power spectrum */
+		Eigen::MatrixXf m_correlation; /**< Correlation surface */
+		lineData m_prevLine; /**< Previous scanline, prepared for matching */
+		lineData m_nextLine; /**< Incoming scanline, prepared for matching */
+
+}; /* -----  end of class lineRegistrationStream  ----- */
+
+} // End namespace fpTools
+
+#endif //LINEREGISTRATIONSTREAM_H
@@ -13,44 +13,635 @@
 #include <vector>
 #include <cmath>
 #include <numeric>
-#include <iostream>
+#include <algorithm>
+#include <stdint.h>
 
 //Eigen3
 #include <Eigen/Core>
 
 //fpTools
 #include "fpTools/minutiaeExtraction.h"
+#include "fpTools/simdKernels.h"
+#include "fpTools_utility/parallelFor.h"
 
 namespace fpTools{
 
+/*!
+ *  \brief  Histogram bin of a value, 8-bit values are their own bin
+ */
+static inline int histogramBin(uint8_t value)
+{
+	return value;
+}
+
+/*!
+ *  \brief  Histogram bin of a value, saturated to 0 to 255
+ */
+static inline int histogramBin(int value)
+{
+	return (value < 0) ? 0 : ((value > 255) ? 255 : value);
+}
+
+/*!
+ *  \brief  Add values to a 256 bin histogram
+ *
+ *  \param  data const Scalar* The values, saturated to 0 to 255
+ *  \param  n size_t Number of values
+ *  \param[in,out] histogram int* The 256 bins
+ *
+ *  Counts go to four interleaved sub-histograms so runs of one value, common in
+ *  fingerprint backgrounds, do not wait on the increment before.
+ */
+template<typename Scalar>
+static void addToHistogram(const Scalar *data, size_t n, int *histogram)
+{
+	int sub[4*256] = {0};
+
+	size_t k = 0;
+	for(; k + 4 <= n; k += 4)
+	{
+		sub[histogramBin(data[k])]++;
+		sub[256 + histogramBin(data[k+1])]++;
+		sub[512 + histogramBin(data[k+2])]++;
+		sub[768 + histogramBin(data[k+3])]++;
+	}
+	for(; k < n; k++) sub[histogramBin(data[k])]++;
+
+	for(int b = 0; b < 256; b++)
+	{
+		histogram[b] += sub[b] + sub[256 + b] + sub[512 + b] + sub[768 + b];
+	}
+}
+
+/*!
+ *  \brief  Histogram of rows of contiguous values, one private histogram per thread
+ *
+ *  \param  data const Scalar* The values, rows x cols
+ *  \param  rows int Number of rows, split between threads
+ *  \param  cols int Values per row
+ *  \param  numThreads int Number of threads
+ *  \param[in,out] histogram std::vector<int> The 256 bins, added to
+ *  \param  local std::vector<int> Scratch for the private histograms
+ */
+template<typename Scalar>
+static void parallelHistogram(const Scalar *data, int rows, int cols, int numThreads, std::vector<int> &histogram,
+		std::vector<int> &local)
+{
+	//Threads never write the same bins, the private histograms are summed after
+	local.assign(static_cast<size_t>(numThreads)*256, 0);
+	parallelFor(0, rows, numThreads, [&](int thread, int begin, int end)
+	{
+		addToHistogram(data + static_cast<size_t>(begin)*cols, static_cast<size_t>(end - begin)*cols,
+				&local[static_cast<size_t>(thread)*256]);
+	});
+
+	for(int t = 0; t < numThreads; t++)
+	{
+		for(int b = 0; b < 256; b++) histogram[b] += local[t*256 + b];
+	}
+}
+
+/*!
+ *  \brief  Add a bit-plane to a bit-sliced counter, four bits per lane
+ *
+ *  \param  x uint64_t The bit-plane
+ *  \param[in,out] count uint64_t[4] The counter, least significant plane first
+ */
+static inline void addPlane(uint64_t x, uint64_t count[4])
+{
+	uint64_t carry0 = count[0] & x;
+	count[0] ^= x;
+	uint64_t carry1 = count[1] & carry0;
+	count[1] ^= carry0;
+	uint64_t carry2 = count[2] & carry1;
+	count[2] ^= carry1;
+	count[3] ^= carry2;
+}
+
+/*!
+ *  \brief  The eight neighbours of a word of a row, as words
+ *
+ *  \param  up const uint64_t* The row above
+ *  \param  mid const uint64_t* The row
+ *  \param  down const uint64_t* The row below
+ *  \param  w int The word
+ *  \param  words int Words in a row
+ *  \param[out] p uint64_t[8] Bit c is the neighbour of pixel c, north then clockwise
+ *
+ *  Each neighbour is a shifted copy of a row, the carry comes from the word next to it.
+ */
+static inline void neighbourPlanes(const uint64_t *up, const uint64_t *mid, const uint64_t *down, int w, int words,
+		uint64_t p[8])
+{
+	bool last = (w + 1 == words);
+	p[0] = up[w];
+	p[1] = (up[w] >> 1) | (last ? 0 : up[w + 1] << 63);
+	p[2] = (mid[w] >> 1) | (last ? 0 : mid[w + 1] << 63);
+	p[3] = (down[w] >> 1) | (last ? 0 : down[w + 1] << 63);
+	p[4] = down[w];
+	p[5] = (down[w] << 1) | ((w > 0) ? down[w - 1] >> 63 : 0);
+	p[6] = (mid[w] << 1) | ((w > 0) ? mid[w - 1] >> 63 : 0);
+	p[7] = (up[w] << 1) | ((w > 0) ? up[w - 1] >> 63 : 0);
+}
+
+/*!
+ *  \brief  Mark the pixels of a row one Zhang-Suen sub-iteration removes
+ *
+ *  \param  ridges bitImage The image
+ *  \param  r int The row
+ *  \param  step int 0 for the first sub-iteration, 1 for the second
+ *  \param  zeros const uint64_t* A row of clear words, used past the top and bottom
+ *  \param[out] remove uint64_t* The pixels to remove, one word per word of the row
+ *
+ *  \return bool True if any pixel is to be removed
+ *
+ *  The tests run on 64 pixels at a time.
+ */
+static bool thinRow(const bitImage &ridges, int r, int step, const uint64_t *zeros, uint64_t *remove)
+{
+	int words = ridges.wordsPerRow();
+	const uint64_t *up = (r > 0) ? ridges.row(r - 1) : zeros;
+	const uint64_t *mid = ridges.row(r);
+	const uint64_t *down = (r + 1 < ridges.rows()) ? ridges.row(r + 1) : zeros;
+
+	uint64_t any = 0;
+	for(int w = 0; w < words; w++)
+	{
+		//Neighbours in Zhang-Suen order, p2 north round to p9 north-west
+		uint64_t p[8];
+		neighbourPlanes(up, mid, down, w, words, p);
+		uint64_t p2 = p[0], p3 = p[1], p4 = p[2], p5 = p[3], p6 = p[4], p7 = p[5], p8 = p[6], p9 = p[7];
+
+		//Between 2 and 6 neighbours set, not 0, 1, 7 (0111) or 8 (1000)
+		uint64_t count[4] = {0, 0, 0, 0};
+		addPlane(p2, count);
+		addPlane(p3, count);
+		addPlane(p4, count);
+		addPlane(p5, count);
+		addPlane(p6, count);
+		addPlane(p7, count);
+		addPlane(p8, count);
+		addPlane(p9, count);
+		uint64_t neighbours = (count[1] | count[2] | count[3]) & ~(count[3] | (count[2] & count[1] & count[0]));
+
+		//Exactly one clear to set transition going round p2, p3, ... p9, p2
+		uint64_t t[8] = {~p2 & p3, ~p3 & p4, ~p4 & p5, ~p5 & p6, ~p6 & p7, ~p7 & p8, ~p8 & p9, ~p9 & p2};
+		uint64_t once = 0;
+		uint64_t twice = 0;
+		for(int k = 0; k < 8; k++)
+		{
+			twice |= once & t[k];
+			once |= t[k];
+		}
+
+		uint64_t corner;
+		if( step == 0 )
+		{
+			corner = ~(p2 & p4 & p6) & ~(p4 & p6 & p8);
+		}else
+		{
+			corner = ~(p2 & p4 & p8) & ~(p2 & p6 & p8);
+		}
+
+		remove[w] = mid[w] & neighbours & once & ~twice & corner;
+		any |= remove[w];
+	}
+
+	return any != 0;
+}
+
+/*!
+ *  \brief  Steps to the eight neighbours, north then clockwise
+ */
+static const int stepX[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const int stepY[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+/*!
+ *  \brief  Check a skeleton pixel, clear outside the image
+ */
+static inline bool ridgeAt(const bitImage &skeleton, int x, int y)
+{
+	return x >= 0 && y >= 0 && x < skeleton.cols() && y < skeleton.rows() && skeleton.get(y, x);
+}
+
+/*!
+ *  \brief  Crossing number of a skeleton pixel, the clear to set transitions around it
+ */
+static int crossingNumber(const bitImage &skeleton, int x, int y)
+{
+	int transitions = 0;
+	for(int k = 0; k < 8; k++)
+	{
+		if( !ridgeAt(skeleton, x + stepX[k], y + stepY[k]) &&
+				ridgeAt(skeleton, x + stepX[(k + 1) % 8], y + stepY[(k + 1) % 8]) ) transitions++;
+	}
+	return transitions;
+}
+
+/*!
+ *  \brief  Follows a skeleton ridge one pixel at a time
+ *
+ *  The pixels stepped over are remembered for a few steps, so the trace never turns back
+ *  and the corners of a staircase are not taken for branches.
+ */
+struct ridgeTracer
+{
+	/*!
+	 *  \brief  Constructor
+	 *
+	 *  \param  skeleton bitImage The skeleton
+	 *  \param  x int Column to start from
+	 *  \param  y int Row to start from
+	 */
+	ridgeTracer(const bitImage &skeleton, int x, int y) : skeleton(skeleton), x(x), y(y), seenCount(0) {see(x, y);}
+
+	/*!
+	 *  \brief  Remember a pixel as visited
+	 */
+	void see(int px, int py)
+	{
+		seenX[seenCount % 16] = px;
+		seenY[seenCount % 16] = py;
+		seenCount++;
+	}
+
+	/*!
+	 *  \brief  Check a pixel is ridge and not visited
+	 */
+	bool open(int px, int py) const
+	{
+		if( !ridgeAt(skeleton, px, py) ) return false;
+		for(int i = 0; i < std::min(seenCount, 16); i++) if( seenX[i] == px && seenY[i] == py ) return false;
+		return true;
+	}
+
+	/*!
+	 *  \brief  Follow the ridge
+	 *
+	 *  \param  maxSteps int Steps to take at most
+	 *  \param[out] end int 0 if every step was taken, else the minutiaType the ridge stopped at
+	 *
+	 *  \return int Steps taken, x and y are left on the last pixel reached
+	 */
+	int trace(int maxSteps, int &end)
+	{
+		int fromX = x;
+		int fromY = y;
+		for(int step = 0; step < maxSteps; step++)
+		{
+			//The ridge goes on if the open pixels around form a single run
+			bool isOpen[8];
+			for(int k = 0; k < 8; k++) isOpen[k] = open(x + stepX[k], y + stepY[k]);
+
+			int runs = 0;
+			int any = 0;
+			for(int k = 0; k < 8; k++)
+			{
+				if( isOpen[k] && !isOpen[(k + 7) % 8] ) runs++;
+				any += isOpen[k];
+			}
+			if( runs == 0 && any == 8 ) runs = 1;
+
+			if( runs != 1 )
+			{
+				end = (runs == 0) ? MINUTIA_ENDING : MINUTIA_BIFURCATION;
+				return step;
+			}
+
+			//Step to the pixel of the run furthest from the last one, stepping over the rest.
+			//A branch joining there is reached even if it is not the pixel stepped to.
+			int next = -1;
+			int furthest = -1;
+			bool branch = false;
+			for(int k = 0; k < 8; k++)
+			{
+				if( !isOpen[k] ) continue;
+				branch |= crossingNumber(skeleton, x + stepX[k], y + stepY[k]) >= 3;
+
+				int dx = x + stepX[k] - fromX;
+				int dy = y + stepY[k] - fromY;
+				if( dx*dx + dy*dy > furthest )
+				{
+					furthest = dx*dx + dy*dy;
+					next = k;
+				}
+			}
+			for(int k = 0; k < 8; k++) if( isOpen[k] && k != next ) see(x + stepX[k], y + stepY[k]);
+
+			fromX = x;
+			fromY = y;
+			x += stepX[next];
+			y += stepY[next];
+			see(x, y);
+
+			if( branch )
+			{
+				end = MINUTIA_BIFURCATION;
+				return step + 1;
+			}
+		}
+
+		end = 0;
+		return maxSteps;
+	}
+
+	const bitImage &skeleton; /**< The skeleton */
+	int x; /**< Column reached */
+	int y; /**< Row reached */
+	int seenX[16]; /**< Columns of the last pixels visited */
+	int seenY[16]; /**< Rows of the last pixels visited */
+	int seenCount; /**< Pixels visited */
+};
+
+/*!
+ *  \brief  Measure a ridge ending
+ *
+ *  \param  skeleton bitImage The skeleton
+ *  \param  x int Column
+ *  \param  y int Row
+ *  \param  traceLength int Pixels to follow the ridge for
+ *  \param  spurLength int Ridge pieces up to this long are spurs
+ *  \param[out] angle float Angle, away from the ridge
+ *  \param[out] quality int How far the ridge was followed, 100 for traceLength
+ *
+ *  \return bool False if the ending is on a spur or a short piece of ridge
+ */
+static bool measureEnding(const bitImage &skeleton, int x, int y, int traceLength, int spurLength,
+		float &angle, int &quality)
+{
+	ridgeTracer tracer(skeleton, x, y);
+	int end;
+	int steps = tracer.trace(traceLength, end);
+	if( steps == 0 || (end != 0 && steps <= spurLength) ) return false;
+
+	angle = std::atan2(static_cast<float>(y - tracer.y), static_cast<float>(x - tracer.x));
+	quality = 100*steps/traceLength;
+	return true;
+}
+
+/*!
+ *  \brief  Measure a ridge bifurcation
+ *
+ *  \param  skeleton bitImage The skeleton
+ *  \param  x int Column
+ *  \param  y int Row
+ *  \param  traceLength int Pixels to follow each branch for
+ *  \param  spurLength int Branches ending within this many pixels are spurs
+ *  \param[out] angle float Angle, away from the ridge that splits
+ *  \param[out] quality int How far the shortest branch was followed, 100 for traceLength
+ *
+ *  \return bool False if a branch is a spur
+ */
+static bool measureBifurcation(const bitImage &skeleton, int x, int y, int traceLength, int spurLength,
+		float &angle, int &quality)
+{
+	bool around[8];
+	for(int k = 0; k < 8; k++) around[k] = ridgeAt(skeleton, x + stepX[k], y + stepY[k]);
+
+	//A branch starts at each run of ridge pixels around the bifurcation
+	float dirX[3];
+	float dirY[3];
+	int branches = 0;
+	int shortest = traceLength;
+	for(int k = 0; k < 8 && branches < 3; k++)
+	{
+		if( !around[k] || around[(k + 7) % 8] ) continue;
+
+		//Follow this run only, the other branches are visited already
+		int runEnd = k;
+		while( around[(runEnd + 1) % 8] && (runEnd + 1) % 8 != k ) runEnd++;
+
+		ridgeTracer tracer(skeleton, x, y);
+		for(int n = 0; n < 8; n++)
+		{
+			bool inRun = ((n - k + 8) % 8) <= runEnd - k;
+			if( around[n] && !inRun ) tracer.see(x + stepX[n], y + stepY[n]);
+		}
+
+		int end;
+		int steps = tracer.trace(traceLength, end);
+		if( end == MINUTIA_ENDING && steps <= spurLength ) return false;
+
+		float length = std::sqrt(static_cast<float>((tracer.x - x)*(tracer.x - x) + (tracer.y - y)*(tracer.y - y)));
+		if( length == 0 ) return false;
+		dirX[branches] = (tracer.x - x)/length;
+		dirY[branches] = (tracer.y - y)/length;
+		shortest = std::min(shortest, steps);
+		branches++;
+	}
+	if( branches < 3 ) return false;
+
+	//The ridge that splits points away from the other two branches
+	int trunk = 0;
+	float lowest = 2;
+	for(int i = 0; i < 3; i++)
+	{
+		int j = (i + 1) % 3;
+		int k = (i + 2) % 3;
+		float closeness = dirX[i]*dirX[j] + dirY[i]*dirY[j] + dirX[i]*dirX[k] + dirY[i]*dirY[k];
+		if( closeness < lowest )
+		{
+			lowest = closeness;
+			trunk = i;
+		}
+	}
+
+	angle = std::atan2(-dirY[trunk], -dirX[trunk]);
+	quality = 100*shortest/traceLength;
+	return true;
+}
+
 //Constructor
-minutiaeExtraction::minutiaeExtraction()
+minutiaeExtraction::minutiaeExtraction() : m_numThreads(1), m_method(THRESH_OTSU), m_windowSize(15),
+	m_localWeight(0.2f), m_minContrast(8.0f), m_spurLength(8)
 {
 }
 
 //Binarize image
 void minutiaeExtraction::binarize(Eigen::MatrixXi &image)
 {
+	//Local thresholds work on the 8-bit row-major copy
+	if( m_method != THRESH_OTSU )
+	{
+		//Saturate rather than wrap values outside 8 bits
+		image8u compact = image.cwiseMax(0).cwiseMin(255).cast<uint8_t>();
+		this->binarize(compact);
+		image = compact.cast<int>();
+		return;
+	}
+
 	//Compute histogram (using 256 bins)
-	std::vector<int> hist = this->computeHistogram(image);
+	this->computeHistogram(image, m_workspace);
 
 	//Calculate threshold
+	int thresh = this->otsuThreshCalc(m_workspace.histogram);
+
+	//Threshold the image in storage order, a band of columns per thread
+	int rows = image.rows();
+	int *data = image.data();
+	parallelFor(0, image.cols(), resolveThreads(m_numThreads), [&](int, int begin, int end)
+	{
+		int *col = data + static_cast<size_t>(begin)*rows;
+		size_t count = static_cast<size_t>(end - begin)*rows;
+		for(size_t k = 0; k < count; k++)
+		{
+			col[k] = (col[k] < thresh) ? 0 : 255;
+		}
+	});
+}
+
+//Binarize 8-bit image
+void minutiaeExtraction::binarize(image8u &image)
+{
+	//Compute histogram (using 256 bins)
+	std::vector<int> &hist = m_workspace.histogram;
+	hist.clear();
+	this->accumulateHistogram(image, hist, m_workspace);
+
+	//Calculate threshold
+	int thresh = this->otsuThreshCalc(hist);
+
+	//Threshold the image, the global threshold stays the fallback of the local methods
+	if( m_method != THRESH_OTSU )
+	{
+		this->localThreshold(image, thresh, m_workspace.ridges, m_workspace);
+		m_workspace.ridges.toImage(image);
+	}else
+	{
+		this->applyThreshold(image, thresh);
+	}
+}
+
+//Binarize 8-bit image to bits
+void minutiaeExtraction::binarize(const image8u &image, bitImage &ridges)
+{
+	this->binarize(image, ridges, m_workspace);
+}
+
+//Binarize 8-bit image to bits, in a workspace
+void minutiaeExtraction::binarize(const image8u &image, bitImage &ridges, workspace &work)
+{
+	std::vector<int> &hist = work.histogram;
+	hist.clear();
+	this->accumulateHistogram(image, hist, work);
 	int thresh = this->otsuThreshCalc(hist);
 
-	//Threshold the image
-	for(size_t i = 0; i < image.rows(); i++)
+	//Pixels below the threshold are the ridges
+	if( m_method != THRESH_OTSU )
 	{
-		for(size_t j = 0; j < image.cols(); j++)
+		this->localThreshold(image, thresh, ridges, work);
+	}else
+	{
+		ridges.fromImage(image, thresh);
+	}
+}
+
+//Threshold by local windows
+void minutiaeExtraction::localThreshold(const image8u &image, int globalThresh, bitImage &ridges, workspace &work)
+{
+	int rows = image.rows();
+	int cols = image.cols();
+	int half = m_windowSize/2;
+	size_t stride = static_cast<size_t>(cols) + 1;
+
+	//Bands a few windows high, so the margin each band adds is small
+	int bandRows = std::max(64, 4*m_windowSize);
+	int numBands = (rows + bandRows - 1)/bandRows;
+
+	//Bands write whole rows of words, so never the same word
+	ridges.resize(rows, cols);
+	const uint8_t *src = image.data();
+
+	//Integral images of each thread, kept from image to image
+	int numThreads = resolveThreads(m_numThreads);
+	if( static_cast<int>(work.sum.size()) < numThreads )
+	{
+		work.sum.resize(numThreads);
+		work.sumSq.resize(numThreads);
+	}
+
+	parallelFor(0, numBands, numThreads, [&](int thread, int bandBegin, int bandEnd)
+	{
+		std::vector<int64_t> &sum = work.sum[thread];
+		std::vector<int64_t> &sumSq = work.sumSq[thread];
+		for(int b = bandBegin; b < bandEnd; b++)
 		{
-			if(image(i,j) < thresh)
+			int r0 = b*bandRows;
+			int r1 = std::min(rows, r0 + bandRows);
+			int top = std::max(0, r0 - half);
+			int height = std::min(rows, r1 + half) - top;
+
+			//Integral images of the band and its margin, with a row and column of zeros in front
+			sum.assign((height + 1)*stride, 0);
+			sumSq.assign((height + 1)*stride, 0);
+			for(int y = 0; y < height; y++)
 			{
-				image(i,j) = 0;
-			}else
+				const uint8_t *in = src + static_cast<size_t>(top + y)*cols;
+				int64_t rowSum = 0;
+				int64_t rowSq = 0;
+				for(int x = 0; x < cols; x++)
+				{
+					rowSum += in[x];
+					rowSq += in[x]*in[x];
+					sum[(y + 1)*stride + x + 1] = sum[y*stride + x + 1] + rowSum;
+					sumSq[(y + 1)*stride + x + 1] = sumSq[y*stride + x + 1] + rowSq;
+				}
+			}
+
+			//Four lookups per pixel for the window statistics, windows are clipped at the edges
+			for(int r = r0; r < r1; r++)
 			{
-				image(i,j) = 255;
+				size_t y0 = (std::max(0, r - half) - top)*stride;
+				size_t y1 = (std::min(rows, r + half + 1) - top)*stride;
+				int windowRows = static_cast<int>((y1 - y0)/stride);
+
+				const uint8_t *in = src + static_cast<size_t>(r)*cols;
+				uint64_t *words = ridges.row(r);
+				uint64_t word = 0;
+				for(int c = 0; c < cols; c++)
+				{
+					int x0 = std::max(0, c - half);
+					int x1 = std::min(cols, c + half + 1);
+					double count = static_cast<double>(windowRows)*(x1 - x0);
+
+					double mean = (sum[y1 + x1] - sum[y1 + x0] - sum[y0 + x1] + sum[y0 + x0])/count;
+					double var = (sumSq[y1 + x1] - sumSq[y1 + x0] - sumSq[y0 + x1] + sumSq[y0 + x0])/count - mean*mean;
+					double dev = (var > 0) ? std::sqrt(var) : 0;
+
+					double thresh = globalThresh;
+					if( dev >= m_minContrast )
+					{
+						if( m_method == THRESH_NIBLACK )
+						{
+							thresh = mean - m_localWeight*dev;
+						}else
+						{
+							thresh = mean*(1 + m_localWeight*(dev/128 - 1));
+						}
+					}
+
+					word |= static_cast<uint64_t>(in[c] < thresh) << (c & 63);
+					if( (c & 63) == 63 || c + 1 == cols )
+					{
+						words[c >> 6] = word;
+						word = 0;
+					}
+				}
 			}
 		}
-	}
+	});
+}
+
+//Threshold 8-bit image
+void minutiaeExtraction::applyThreshold(image8u &image, int thresh)
+{
+	//The pixels are contiguous, a band of rows per thread
+	uint8_t *data = image.data();
+	int cols = image.cols();
+	parallelFor(0, image.rows(), resolveThreads(m_numThreads), [&](int, int begin, int end)
+	{
+		thresholdBytes(data + static_cast<size_t>(begin)*cols, static_cast<size_t>(end - begin)*cols, thresh);
+	});
 }
 
 //Compute threshold
@@ -60,20 +651,20 @@ int minutiaeExtraction::otsuThreshCalc(std::vector<int> &histogram)
 	int thresh = 0;
 
 	//Compute total and sum
-	int total = std::accumulate(histogram.begin(), histogram.end(), 0);
-	float sum = 0;
+	int64_t total = std::accumulate(histogram.begin(), histogram.end(), static_cast<int64_t>(0));
+	double sum = 0;
 
 	//Compute sum weight
 	for(size_t i = 0; i < histogram.size(); i++)
 	{
-		sum += (float)i*histogram[i];
+		sum += (double)i*histogram[i];
 	}
 
-	//Init for computation
-	float varMax = 0;
-	float sumB = 0;
-	int weightB = 0;
-	int weightF = 0;
+	//Init for computation, a single pass over the bins
+	double varMax = 0;
+	double sumB = 0;
+	int64_t weightB = 0;
+	int64_t weightF = 0;
 
 	//Run Otsu thresholding computation
 	for( size_t i = 0; i < histogram.size(); i++)
@@ -84,15 +675,15 @@ int minutiaeExtraction::otsuThreshCalc(std::vector<int> &histogram)
 		weightF = total - weightB; //Foreground weight
 		if(weightF == 0) break; // Stopping condition
 
-		sumB += (float)( i*histogram[i]); //Background summation
+		sumB += (double)i*histogram[i]; //Background summation
 
 		//Compute means
-		float meanBackground = sumB/weightB;
-		float meanForground = (sum - sumB)/weightF;
+		double meanBackground = sumB/weightB;
+		double meanForground = (sum - sumB)/weightF;
 
 		//Compute interclas variance
-		float interVar = (float)weightB * (float)weightF * (meanBackground - meanForground) * (meanBackground  - meanForground);
-		std::cout << interVar << std::endl;
+		double interVar = (double)weightB * (double)weightF * (meanBackground - meanForground) * (meanBackground  - meanForground);
+
 		//Check if new max
 		if( interVar > varMax)
 		{
@@ -107,23 +698,249 @@ int minutiaeExtraction::otsuThreshCalc(std::vector<int> &histogram)
 }
 
 //Compute histogram
-std::vector<int> minutiaeExtraction::computeHistogram(Eigen::MatrixXi &image)
+void minutiaeExtraction::computeHistogram(Eigen::MatrixXi &image, workspace &work)
 {
-	//Create histogram vector
-	std::vector<int> hist(256, 0);
+	//Clear histogram
+	work.histogram.assign(256, 0);
+
+	//Calculate histogram in storage order, columns are contiguous
+	parallelHistogram(image.data(), image.cols(), image.rows(), resolveThreads(m_numThreads), work.histogram,
+			work.threadHistograms);
+}
 
-	//Calculate histogram
-	for(int i = 0; i < image.rows(); i++)
+//Accumulate histogram of 8-bit image
+void minutiaeExtraction::accumulateHistogram(const image8u &image, std::vector<int> &histogram)
+{
+	this->accumulateHistogram(image, histogram, m_workspace);
+}
+
+//Accumulate histogram of 8-bit image, in a workspace
+void minutiaeExtraction::accumulateHistogram(const image8u &image, std::vector<int> &histogram, workspace &work)
+{
+	if( histogram.empty() ) histogram.assign(256, 0);
+
+	parallelHistogram(image.data(), image.rows(), image.cols(), resolveThreads(m_numThreads), histogram,
+			work.threadHistograms);
+}
+
+//Thin 8-bit image
+void minutiaeExtraction::thin(image8u &image)
+{
+	//Ridges are the dark pixels
+	bitImage &ridges = m_workspace.ridges;
+	ridges.fromImage(image);
+	this->thin(ridges, m_workspace);
+	ridges.toImage(image);
+}
+
+//Thin binary image
+void minutiaeExtraction::thin(bitImage &ridges)
+{
+	this->thin(ridges, m_workspace);
+}
+
+//Thin binary image, in a workspace
+void minutiaeExtraction::thin(bitImage &ridges, workspace &work)
+{
+	int rows = ridges.rows();
+	int words = ridges.wordsPerRow();
+	if( rows == 0 || words == 0 ) return;
+
+	//Small bands, so the parts of the print already thin are skipped early
+	const int bandRows = 16;
+	int numBands = (rows + bandRows - 1)/bandRows;
+	int numThreads = resolveThreads(m_numThreads);
+
+	std::vector<uint64_t> &zeros = work.zeros;
+	std::vector<uint64_t> &remove = work.remove;
+	std::vector<char> &changed = work.changed;
+	std::vector<char> &changedBefore = work.changedBefore;
+	std::vector<char> &active = work.active;
+	zeros.assign(words, 0);
+	remove.assign(static_cast<size_t>(rows)*words, 0);
+	changed.assign(numBands, 1);
+	changedBefore.assign(numBands, 1);
+	active.assign(numBands, 0);
+
+	for(int step = 0; ; step ^= 1)
 	{
-		for(int j = 0; j < image.cols(); j++)
+		//A band can only change if it or a band next to it changed in the last two sub-iterations
+		bool any = false;
+		for(int b = 0; b < numBands; b++)
 		{
-			//increment
-			hist[image(i,j)] += 1;	
+			int first = std::max(0, b - 1);
+			int last = std::min(numBands - 1, b + 1);
+			active[b] = 0;
+			for(int n = first; n <= last; n++) active[b] |= changed[n] | changedBefore[n];
+			any |= (active[b] != 0);
 		}
+		if( !any ) break;
+		changedBefore = changed;
+
+		//Mark from the image as it was at the start of the sub-iteration
+		parallelFor(0, numBands, numThreads, [&](int, int bandBegin, int bandEnd)
+		{
+			for(int b = bandBegin; b < bandEnd; b++)
+			{
+				changed[b] = 0;
+				if( !active[b] ) continue;
+
+				int end = std::min(rows, (b + 1)*bandRows);
+				for(int r = b*bandRows; r < end; r++)
+				{
+					if( thinRow(ridges, r, step, zeros.data(), &remove[static_cast<size_t>(r)*words]) ) changed[b] = 1;
+				}
+			}
+		});
+
+		//Then remove
+		parallelFor(0, numBands, numThreads, [&](int, int bandBegin, int bandEnd)
+		{
+			for(int b = bandBegin; b < bandEnd; b++)
+			{
+				if( !changed[b] ) continue;
+
+				int end = std::min(rows, (b + 1)*bandRows);
+				for(int r = b*bandRows; r < end; r++)
+				{
+					uint64_t *row = ridges.row(r);
+					const uint64_t *marked = &remove[static_cast<size_t>(r)*words];
+					for(int w = 0; w < words; w++) row[w] &= ~marked[w];
+				}
+			}
+		});
 	}
-	//Return histogram
-	return hist;
 }
 
-} //End namespace fpTools
+//Find minutiae
+void minutiaeExtraction::detectMinutiae(const bitImage &skeleton, minutiaeSet &minutiae)
+{
+	this->detectMinutiae(skeleton, minutiae, m_workspace);
+}
+
+//Find minutiae, in a workspace
+void minutiaeExtraction::detectMinutiae(const bitImage &skeleton, minutiaeSet &minutiae, workspace &work)
+{
+	minutiae.clear();
 
+	int rows = skeleton.rows();
+	int cols = skeleton.cols();
+	int words = skeleton.wordsPerRow();
+	int traceLength = std::max(12, m_spurLength + 1);
+	std::vector<uint64_t> &zeros = work.zeros;
+	zeros.assign(words, 0);
+
+	//Blocks with little skeleton are outside the print, counted as the scan reaches them.
+	//16 columns is a quarter word.
+	const int blockSize = 16;
+	int blockRows = (rows + blockSize - 1)/blockSize;
+	int blockCols = (cols + blockSize - 1)/blockSize;
+	std::vector<int> &blockCount = work.blockCount;
+	std::vector<char> &blockCounted = work.blockCounted;
+	blockCount.assign(static_cast<size_t>(blockRows)*blockCols, 0);
+	blockCounted.assign(blockRows, 0);
+
+	//Minutiae with a block outside the print or the image around them are dropped
+	auto nearBorder = [&](int x, int y)
+	{
+		int bx = x/blockSize;
+		int by = y/blockSize;
+		for(int ny = by - 1; ny <= by + 1; ny++)
+		{
+			if( ny < 0 || ny >= blockRows ) return true;
+			if( !blockCounted[ny] )
+			{
+				int end = std::min(rows, (ny + 1)*blockSize);
+				for(int r = ny*blockSize; r < end; r++)
+				{
+					const uint64_t *row = skeleton.row(r);
+					for(int b = 0; b < blockCols; b++)
+					{
+						blockCount[ny*blockCols + b] += __builtin_popcountll((row[b/4] >> (16*(b % 4))) & 0xFFFF);
+					}
+				}
+				blockCounted[ny] = 1;
+			}
+
+			for(int nx = bx - 1; nx <= bx + 1; nx++)
+			{
+				if( nx < 0 || nx >= blockCols || blockCount[ny*blockCols + nx] < blockSize/2 ) return true;
+			}
+		}
+		return false;
+	};
+
+	for(int r = 0; r < rows; r++)
+	{
+		const uint64_t *up = (r > 0) ? skeleton.row(r - 1) : zeros.data();
+		const uint64_t *mid = skeleton.row(r);
+		const uint64_t *down = (r + 1 < rows) ? skeleton.row(r + 1) : zeros.data();
+
+		for(int w = 0; w < words; w++)
+		{
+			if( mid[w] == 0 ) continue;
+
+			//Crossing number of 64 pixels at once, 1 for an ending and 3 for a bifurcation
+			uint64_t p[8];
+			neighbourPlanes(up, mid, down, w, words, p);
+			uint64_t count[4] = {0, 0, 0, 0};
+			for(int k = 0; k < 8; k++) addPlane(~p[k] & p[(k + 1) % 8], count);
+
+			uint64_t low = mid[w] & ~count[2] & ~count[3];
+			uint64_t endings = low & count[0] & ~count[1];
+			uint64_t forks = low & count[0] & count[1];
+
+			//Look at the candidates one by one
+			uint64_t candidates = endings | forks;
+			while( candidates != 0 )
+			{
+				int bit = __builtin_ctzll(candidates);
+				candidates &= candidates - 1;
+				int x = w*64 + bit;
+
+				if( nearBorder(x, r) ) continue;
+
+				float angle;
+				int quality;
+				if( (endings >> bit) & 1 )
+				{
+					if( !measureEnding(skeleton, x, r, traceLength, m_spurLength, angle, quality) ) continue;
+					minutiae.add(x, r, angle, MINUTIA_ENDING, quality);
+				}else
+				{
+					//One bifurcation can cover neighbouring pixels, keep the first in raster order
+					static const int earlier[4] = {6, 7, 0, 1};
+					bool seen = false;
+					for(int k = 0; k < 4 && !seen; k++)
+					{
+						int nx = x + stepX[earlier[k]];
+						int ny = r + stepY[earlier[k]];
+						seen = ridgeAt(skeleton, nx, ny) && crossingNumber(skeleton, nx, ny) >= 3;
+					}
+					if( seen ) continue;
+
+					if( !measureBifurcation(skeleton, x, r, traceLength, m_spurLength, angle, quality) ) continue;
+					minutiae.add(x, r, angle, MINUTIA_BIFURCATION, quality);
+				}
+			}
+		}
+	}
+}
+
+//Binarize, thin and find minutiae
+void minutiaeExtraction::extractMinutiae(image8u &image, minutiaeSet &minutiae)
+{
+	this->extractMinutiae(image, minutiae, m_workspace);
+}
+
+//Binarize, thin and find minutiae, in a workspace
+void minutiaeExtraction::extractMinutiae(image8u &image, minutiaeSet &minutiae, workspace &work)
+{
+	bitImage &skeleton = work.ridges;
+	this->binarize(image, skeleton, work);
+	this->thin(skeleton, work);
+	this->detectMinutiae(skeleton, minutiae, work);
+	skeleton.toImage(image);
+}
+
+} //End namespace fpTools
@@ -11,15 +11,30 @@
  */
 //STL
 #include <vector>
+#include <stdint.h>
 
 //Eigen3
 #include <Eigen/Core>
 
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+#include "fpTools_utility/bitImage.h"
+#include "fpTools/minutiaeSet.h"
+
 #ifndef MINUTIAEEXTRACTION_H
 #define MINUTIAEEXTRACTION_H
 
 namespace fpTools{
 
+	/*!
+	 *  \brief  How binarize picks the threshold of each pixel
+	 */
+	enum thresholdMethod
+	{
+		THRESH_OTSU = 0, /**< One global threshold by Otsu's method */
+		THRESH_NIBLACK, /**< Local mean less k local standard deviations */
+		THRESH_SAUVOLA /**< Local mean scaled by 1 + k(local standard deviation/128 - 1) */
+	};
 
 	/*!
 	 *  \brief  Class to handle the extraction of minutiae from fingerprints
@@ -27,6 +42,30 @@ namespace fpTools{
 	class minutiaeExtraction
 	{
 		public:
+			/*!
+			 *  \brief  Buffers used while extracting, kept by the caller between images
+			 *
+			 *  Each buffer is sized on first use and reused after, so once warmed up an image of
+			 *  the same size is binarized, thinned and its minutiae found without allocating,
+			 *  apart from the stacks of the threads started with more than one thread. A
+			 *  workspace serves one image at a time.
+			 */
+			struct workspace
+			{
+				std::vector<int> histogram; /**< Histogram of the image, 256 bins */
+				std::vector<int> threadHistograms; /**< A histogram per thread, summed into histogram */
+				std::vector<std::vector<int64_t> > sum; /**< Integral image of a band, per thread */
+				std::vector<std::vector<int64_t> > sumSq; /**< Integral image of the squares of a band, per thread */
+				bitImage ridges; /**< Ridges, thinned to the skeleton by extractMinutiae */
+				std::vector<uint64_t> zeros; /**< A row of clear words, past the top and bottom */
+				std::vector<uint64_t> remove; /**< Pixels a thinning sub-iteration removes */
+				std::vector<char> changed; /**< Bands the last sub-iteration changed */
+				std::vector<char> changedBefore; /**< Bands the sub-iteration before changed */
+				std::vector<char> active; /**< Bands that can still change */
+				std::vector<int> blockCount; /**< Skeleton pixels in each block */
+				std::vector<char> blockCounted; /**< Rows of blocks counted so far */
+			};
+
 			/* ====================  LIFECYCLE     ======================================= */
 			
 			/*!
@@ -36,17 +75,219 @@ namespace fpTools{
 
 			/* ====================  ACCESSORS     ======================================= */
 
+			/*!
+			 *  \brief  Get number of threads used to binarize
+			 *  
+			 *  \return Number of threads, 0 for all cores
+			 */
+			int getNumThreads(){return m_numThreads;}
+
+			/*!
+			 *  \brief  Get the thresholding method
+			 */
+			thresholdMethod getThresholdMethod(){return m_method;}
+
+			/*!
+			 *  \brief  Get the side of the local window in pixels
+			 */
+			int getWindowSize(){return m_windowSize;}
+
+			/*!
+			 *  \brief  Get the weight k of the local standard deviation
+			 */
+			float getLocalWeight(){return m_localWeight;}
+
+			/*!
+			 *  \brief  Get the local standard deviation below which the global threshold is used
+			 */
+			float getMinContrast(){return m_minContrast;}
+
+			/*!
+			 *  \brief  Get the length below which a ridge piece is a spur
+			 */
+			int getSpurLength(){return m_spurLength;}
+
 			/* ====================  MUTATORS      ======================================= */
 
+			/*!
+			 *  \brief  Set number of threads used to binarize
+			 *  
+			 *  \param  numThreads int Number of threads, 1 for serial, 0 for all cores
+			 *
+			 *  Each thread builds its own histogram of a band of rows, the histograms are
+			 *  summed, then each thread thresholds its band.
+			 */
+			void setNumThreads(int numThreads){m_numThreads = numThreads;}
+
+			/*!
+			 *  \brief  Set the thresholding method
+			 *  
+			 *  \param  method thresholdMethod THRESH_OTSU, the default, or a local method
+			 *
+			 *  The local methods hold up on swipes of uneven pressure where one global
+			 *  threshold loses the light or the heavy parts of the print.
+			 */
+			void setThresholdMethod(thresholdMethod method){m_method = method;}
+
+			/*!
+			 *  \brief  Set the side of the local window
+			 *  
+			 *  \param  windowSize int Side in pixels, made odd, about two ridge periods works well
+			 */
+			void setWindowSize(int windowSize){m_windowSize = windowSize | 1;}
+
+			/*!
+			 *  \brief  Set the weight k of the local standard deviation
+			 *  
+			 *  \param  localWeight float k, 0.2 by default, larger values give thinner ridges
+			 */
+			void setLocalWeight(float localWeight){m_localWeight = localWeight;}
+
+			/*!
+			 *  \brief  Set the contrast needed to threshold a pixel locally
+			 *  
+			 *  \param  minContrast float Local standard deviation in grey levels, below it
+			 *  		the global Otsu threshold is used so flat background is not turned to noise
+			 */
+			void setMinContrast(float minContrast){m_minContrast = minContrast;}
+
+			/*!
+			 *  \brief  Set the length below which a ridge piece is a spur
+			 *  
+			 *  \param  spurLength int Pixels along the skeleton, an ending this close to another
+			 *  		ending or to a bifurcation is dropped, with the bifurcation
+			 */
+			void setSpurLength(int spurLength){m_spurLength = spurLength;}
+
 			/* ====================  OPERATORS     ======================================= */
 			
 			/*!
-			 *  \brief  Binarizes the input image using the Otsu thresholding method
+			 *  \brief  Binarizes the input image using the thresholding method set
 			 *  
-			 *  \param[in,out] image Eigen::MatrixXi The input image
+			 *  \param[in,out] image Eigen::MatrixXi The input image, values outside 0 to 255
+			 *  		are taken as 0 or 255
 			 */
 			void binarize(Eigen::MatrixXi &image);
 
+			/*!
+			 *  \brief  Binarizes an 8-bit image using the thresholding method set
+			 *  
+			 *  \param[in,out] image image8u The input image
+			 */
+			void binarize(image8u &image);
+
+			/*!
+			 *  \brief  Binarizes an 8-bit image straight into bits using the thresholding method set
+			 *  
+			 *  \param[in]  image image8u The input image
+			 *  \param[out] ridges bitImage The ridges, the pixels below the threshold, resized to fit
+			 *
+			 *  Every stage after binarizing works on the packed ridges, a bit per pixel.
+			 */
+			void binarize(const image8u &image, bitImage &ridges);
+
+			/*!
+			 *  \brief  Binarizes an 8-bit image straight into bits, in a workspace
+			 *  
+			 *  \param[in]  image image8u The input image
+			 *  \param[out] ridges bitImage The ridges, resized to fit
+			 *  \param  work workspace Buffers for the histogram and local statistics
+			 */
+			void binarize(const image8u &image, bitImage &ridges, workspace &work);
+
+			/*!
+			 *  \brief  Add the pixels of an image, or a band of one, to a histogram
+			 *  
+			 *  \param[in]  image image8u The image or band
+			 *  \param[in,out] histogram std::vector<int> The histogram, sized to 256 bins if empty
+			 *
+			 *  With otsuThreshold() and applyThreshold() an image read a band at a time can be
+			 *  binarized in two passes, the first building the histogram of every band.
+			 */
+			void accumulateHistogram(const image8u &image, std::vector<int> &histogram);
+
+			/*!
+			 *  \brief  Otsu threshold of a histogram
+			 *  
+			 *  \param  histogram std::vector<int> The histogram, 256 bins
+			 *
+			 *  \return int The threshold, pixels below it are background
+			 */
+			int otsuThreshold(std::vector<int> &histogram){return otsuThreshCalc(histogram);}
+
+			/*!
+			 *  \brief  Threshold an image, or a band of one
+			 *  
+			 *  \param[in,out] image image8u The image or band, set to 0 below thresh and 255 otherwise
+			 *  \param  thresh int The threshold
+			 */
+			void applyThreshold(image8u &image, int thresh);
+
+			/*!
+			 *  \brief  Thin the ridges of a binarized image to one pixel wide
+			 *  
+			 *  \param[in,out] image image8u The binarized image, ridges 0 and valleys 255
+			 */
+			void thin(image8u &image);
+
+			/*!
+			 *  \brief  Thin the set pixels of a binary image to one pixel wide lines
+			 *  
+			 *  \param[in,out] ridges bitImage The ridge pixels
+			 *
+			 *  Zhang-Suen thinning, whole words of pixels at a time. Each sub-iteration marks
+			 *  the pixels to remove over bands of rows on the threads set, then removes them.
+			 *  A band is only revisited while it or a band next to it is still changing.
+			 */
+			void thin(bitImage &ridges);
+
+			/*!
+			 *  \brief  Thin the set pixels of a binary image, in a workspace
+			 *  
+			 *  \param[in,out] ridges bitImage The ridge pixels
+			 *  \param  work workspace Buffers for the pixels to remove and the bands to visit
+			 */
+			void thin(bitImage &ridges, workspace &work);
+
+			/*!
+			 *  \brief  Find the ridge endings and bifurcations of a skeleton
+			 *  
+			 *  \param[in]  skeleton bitImage The thinned ridges
+			 *  \param[out] minutiae minutiaeSet The minutiae, in raster order
+			 *
+			 *  Pixels are classified by crossing number a word at a time, only the candidates
+			 *  are looked at one by one. As each is found the ridges around it are followed to
+			 *  measure its angle and to drop it if it is on a spur, and it is dropped if it is
+			 *  near the edge of the image or of the print, so no second pass is needed.
+			 */
+			void detectMinutiae(const bitImage &skeleton, minutiaeSet &minutiae);
+
+			/*!
+			 *  \brief  Find the ridge endings and bifurcations of a skeleton, in a workspace
+			 *  
+			 *  \param[in]  skeleton bitImage The thinned ridges
+			 *  \param[out] minutiae minutiaeSet The minutiae, in raster order, its buffers are reused
+			 *  \param  work workspace Buffers for the counts of the blocks
+			 */
+			void detectMinutiae(const bitImage &skeleton, minutiaeSet &minutiae, workspace &work);
+
+			/*!
+			 *  \brief  Binarize, thin and find the minutiae of an image
+			 *  
+			 *  \param[in,out] image image8u The image, replaced by the skeleton, ridges 0
+			 *  \param[out] minutiae minutiaeSet The minutiae
+			 */
+			void extractMinutiae(image8u &image, minutiaeSet &minutiae);
+
+			/*!
+			 *  \brief  Binarize, thin and find the minutiae of an image, in a workspace
+			 *  
+			 *  \param[in,out] image image8u The image, replaced by the skeleton, ridges 0
+			 *  \param[out] minutiae minutiaeSet The minutiae
+			 *  \param  work workspace Buffers of every stage, the skeleton is left in its ridges
+			 */
+			void extractMinutiae(image8u &image, minutiaeSet &minutiae, workspace &work);
+
 		protected:
 			/* ====================  METHODS       ======================================= */
 
@@ -55,12 +296,20 @@ namespace fpTools{
 			 *  \brief  Compute image histogram
 			 *  
 			 *  \param[in]  image Eigen::MatrixXi The image to compute the histogram of
+			 *  \param  work workspace Holds the histogram, in its histogram
 			 *
-			 *  \return std::vector<int> The histogram
-			 *
-			 *  Assumes image values range from 0 to 255
+			 *  Values outside 0 to 255 are counted in the first or last bin
 			 */
-			std::vector<int> computeHistogram(Eigen::MatrixXi &image);
+			void computeHistogram(Eigen::MatrixXi &image, workspace &work);
+
+			/*!
+			 *  \brief  Add the pixels of an 8-bit image to a histogram
+			 *  
+			 *  \param[in]  image image8u The image or band
+			 *  \param[in,out] histogram std::vector<int> The histogram, sized to 256 bins if empty
+			 *  \param  work workspace Holds the histogram of each thread
+			 */
+			void accumulateHistogram(const image8u &image, std::vector<int> &histogram, workspace &work);
 
 
 			/*!
@@ -74,7 +323,28 @@ namespace fpTools{
 			 */
 			int otsuThreshCalc(std::vector<int> &histogram);
 
+			/*!
+			 *  \brief  Threshold each pixel by the mean and deviation of the window around it
+			 *  
+			 *  \param[in]  image image8u The image
+			 *  \param  globalThresh int Threshold used where the window has too little contrast
+			 *  \param[out] ridges bitImage The pixels below their threshold, resized to fit
+			 *  \param  work workspace Holds the integral images of each thread
+			 *
+			 *  The image is split in bands of rows, each thresholded on its own thread from
+			 *  integral images of the band and its margin, so the cost of a pixel does not
+			 *  depend on the window size.
+			 */
+			void localThreshold(const image8u &image, int globalThresh, bitImage &ridges, workspace &work);
+
 			/* ====================  DATA MEMBERS  ======================================= */
+			int m_numThreads; /**< Threads used to binarize */
+			thresholdMethod m_method; /**< How the threshold is picked */
+			int m_windowSize; /**< Side of the local window */
+			float m_localWeight; /**< Weight k of the local standard deviation */
+			float m_minContrast; /**< Local standard deviation needed to use the local threshold */
+			int m_spurLength; /**< Length below which a ridge piece is a spur */
+			workspace m_workspace; /**< Buffers of the stages when the caller gives none */
 
 		private:
 			/* ====================  METHODS       ======================================= */
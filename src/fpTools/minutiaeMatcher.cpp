@@ -0,0 +1,357 @@
+/*!
+ *    \file  minutiaeMatcher.cpp
+ *   \brief  Implimentation of cylinder code matching
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+//fpTools
+#include "fpTools/minutiaeMatcher.h"
+#include "fpTools/simdKernels.h"
+#include "fpTools_utility/parallelFor.h"
+
+namespace fpTools{
+
+/*!
+ *  \brief  Contribution a cell and section needs for its bit to be set
+ */
+static const float cellThreshold = 0.3f;
+
+/*!
+ *  \brief  Fewest and most pairs of cylinders averaged for the score of two templates
+ */
+static const int minPairs = 4;
+static const int maxPairs = 12;
+
+/*!
+ *  \brief  Pairs of minutiae closer than this, in pixels, are put in the signature
+ */
+static const float pairRadius = 120.0f;
+
+/*!
+ *  \brief  Bins of the signature by distance, turn and bearing of a pair, 2048 in all
+ */
+static const int distanceBins = 8;
+static const int turnBins = 16;
+static const int bearingBins = 16;
+
+/*!
+ *  \brief  Difference of two angles, 0 to pi
+ *
+ *  \param  a float First angle, -pi to pi
+ *  \param  b float Second angle, -pi to pi
+ *
+ *  \return float The difference
+ */
+static inline float angleDifference(float a, float b)
+{
+	float diff = std::fabs(a - b);
+	return (diff > static_cast<float>(M_PI)) ? 2*static_cast<float>(M_PI) - diff : diff;
+}
+
+/*!
+ *  \brief  Angle b less angle a, wrapped to -pi to pi
+ */
+static inline float relativeAngle(float a, float b)
+{
+	float diff = b - a;
+	if( diff < -static_cast<float>(M_PI) ) diff += 2*static_cast<float>(M_PI);
+	if( diff >= static_cast<float>(M_PI) ) diff -= 2*static_cast<float>(M_PI);
+	return diff;
+}
+
+//Add template
+int minutiaeMatcher::addToGallery(const cylinderTemplate &print)
+{
+	m_galleryBits.insert(m_galleryBits.end(), print.bits(), print.bits() + print.size()*cylinderTemplate::cylinderWords);
+	m_galleryAngle.insert(m_galleryAngle.end(), print.angle(), print.angle() + print.size());
+	m_galleryNorm.insert(m_galleryNorm.end(), print.norm(), print.norm() + print.size());
+	m_gallerySignature.insert(m_gallerySignature.end(), print.signature(),
+			print.signature() + cylinderTemplate::signatureWords);
+	m_gallerySignatureCount.push_back(print.signatureCount());
+	m_galleryStart.push_back(m_galleryStart.back() + print.size());
+
+	return gallerySize() - 1;
+}
+
+//Clear gallery
+void minutiaeMatcher::clearGallery()
+{
+	m_galleryBits.clear();
+	m_galleryAngle.clear();
+	m_galleryNorm.clear();
+	m_gallerySignature.clear();
+	m_gallerySignatureCount.clear();
+	m_galleryStart.assign(1, 0);
+}
+
+//Encode minutiae
+void minutiaeMatcher::encode(const minutiaeSet &minutiae, cylinderTemplate &print) const
+{
+	const int side = cylinderTemplate::cellsPerSide;
+	const int sections = cylinderTemplate::angleSections;
+	const float cellSize = 2*m_radius/side;
+	const float sigmaSpace = 0.5f*cellSize;
+	const float sigmaAngle = 0.5f*2*static_cast<float>(M_PI)/sections;
+	const float reach = 3*sigmaSpace;
+	const float centre = 0.5f*(side - 1);
+
+	print.clear();
+	int count = minutiae.size();
+	const uint16_t *mx = minutiae.x();
+	const uint16_t *my = minutiae.y();
+	const float *ma = minutiae.angle();
+
+	//Only cells with their centre inside the radius are used
+	bool inside[side*side];
+	for(int i = 0; i < side; i++)
+	{
+		for(int j = 0; j < side; j++)
+		{
+			float u = (i - centre)*cellSize;
+			float v = (j - centre)*cellSize;
+			inside[i*side + j] = (u*u + v*v <= m_radius*m_radius);
+		}
+	}
+
+	std::vector<float> contribution(side*side*sections);
+	uint64_t bits[cylinderTemplate::cylinderWords];
+	float sectionWeight[sections];
+
+	for(int m = 0; m < count; m++)
+	{
+		float c = std::cos(ma[m]);
+		float s = std::sin(ma[m]);
+		std::fill(contribution.begin(), contribution.end(), 0.0f);
+
+		int neighbours = 0;
+		for(int t = 0; t < count; t++)
+		{
+			if( t == m ) continue;
+
+			//Position of the neighbour in the frame of the minutia
+			float dx = static_cast<float>(mx[t]) - mx[m];
+			float dy = static_cast<float>(my[t]) - my[m];
+			float dist2 = dx*dx + dy*dy;
+			if( dist2 > (m_radius + reach)*(m_radius + reach) ) continue;
+			if( dist2 <= m_radius*m_radius ) neighbours++;
+
+			float u = c*dx + s*dy;
+			float v = -s*dx + c*dy;
+
+			float turn = relativeAngle(ma[m], ma[t]);
+			for(int k = 0; k < sections; k++)
+			{
+				float diff = relativeAngle(turn, -static_cast<float>(M_PI) + (k + 0.5f)*2*static_cast<float>(M_PI)/sections);
+				sectionWeight[k] = std::exp(-diff*diff/(2*sigmaAngle*sigmaAngle));
+			}
+
+			//Only the cells within reach of the neighbour
+			int i0 = std::max(0, static_cast<int>(std::ceil((u - reach)/cellSize + centre)));
+			int i1 = std::min(side - 1, static_cast<int>(std::floor((u + reach)/cellSize + centre)));
+			int j0 = std::max(0, static_cast<int>(std::ceil((v - reach)/cellSize + centre)));
+			int j1 = std::min(side - 1, static_cast<int>(std::floor((v + reach)/cellSize + centre)));
+			for(int i = i0; i <= i1; i++)
+			{
+				for(int j = j0; j <= j1; j++)
+				{
+					if( !inside[i*side + j] ) continue;
+
+					float du = u - (i - centre)*cellSize;
+					float dv = v - (j - centre)*cellSize;
+					float weight = std::exp(-(du*du + dv*dv)/(2*sigmaSpace*sigmaSpace));
+					float *cell = &contribution[(i*side + j)*sections];
+					for(int k = 0; k < sections; k++) cell[k] += weight*sectionWeight[k];
+				}
+			}
+		}
+
+		//Too few neighbours to say anything about the minutia
+		if( neighbours < 2 ) continue;
+
+		int setBits = 0;
+		std::fill(bits, bits + cylinderTemplate::cylinderWords, 0);
+		for(size_t b = 0; b < contribution.size(); b++)
+		{
+			if( contribution[b] < cellThreshold ) continue;
+			bits[b >> 6] |= static_cast<uint64_t>(1) << (b & 63);
+			setBits++;
+		}
+
+		print.add(bits, mx[m], my[m], ma[m], std::sqrt(static_cast<float>(setBits)));
+	}
+
+	//Signature of the whole print, a bit for each kind of pair of nearby minutiae
+	for(int a = 0; a < count; a++)
+	{
+		for(int b = 0; b < count; b++)
+		{
+			float dx = static_cast<float>(mx[b]) - mx[a];
+			float dy = static_cast<float>(my[b]) - my[a];
+			float dist2 = dx*dx + dy*dy;
+			if( b == a || dist2 >= pairRadius*pairRadius ) continue;
+
+			float turn = relativeAngle(ma[a], ma[b]) + static_cast<float>(M_PI);
+			float bearing = relativeAngle(ma[a], std::atan2(dy, dx)) + static_cast<float>(M_PI);
+			int distanceBin = static_cast<int>(std::sqrt(dist2)*distanceBins/pairRadius);
+			int turnBin = std::min(turnBins - 1, static_cast<int>(turn*turnBins/(2*static_cast<float>(M_PI))));
+			int bearingBin = std::min(bearingBins - 1, static_cast<int>(bearing*bearingBins/(2*static_cast<float>(M_PI))));
+			print.setSignatureBit((distanceBin*turnBins + turnBin)*bearingBins + bearingBin);
+		}
+	}
+}
+
+//Similarity of templates
+float minutiaeMatcher::similarity(const cylinderTemplate &a, const cylinderTemplate &b) const
+{
+	return scoreCylinders(a.bits(), a.angle(), a.norm(), a.size(), b.bits(), b.angle(), b.norm(), b.size());
+}
+
+//Search the gallery
+void minutiaeMatcher::search(const cylinderTemplate &query, int maxResults, std::vector<matchResult> &results) const
+{
+	results.clear();
+	int count = gallerySize();
+	if( count == 0 || maxResults <= 0 ) return;
+
+	int numThreads = resolveThreads(m_numThreads);
+	int shortlist = (m_shortlist <= 0) ? count : std::min(m_shortlist, count);
+	shortlist = std::max(shortlist, std::min(maxResults, count));
+
+	//First pass, every template by the pairs its signature shares with the query, each
+	//thread keeping the best of its range in a heap with the worst on top
+	std::vector<int> candidates;
+	if( shortlist < count )
+	{
+		std::vector<std::vector<std::pair<float, int> > > best(numThreads);
+		parallelFor(0, count, numThreads, [&](int thread, int begin, int end)
+		{
+			std::vector<std::pair<float, int> > &heap = best[thread];
+			heap.reserve(shortlist);
+			for(int i = begin; i < end; i++)
+			{
+				//|a & b| from |a|, |b| and |a ^ b|, scaled like a cosine
+				int both = query.signatureCount() + m_gallerySignatureCount[i];
+				int differ = popcountXor(query.signature(), &m_gallerySignature[static_cast<size_t>(i)*cylinderTemplate::signatureWords],
+						cylinderTemplate::signatureWords);
+				float score = (both > differ) ? 0.5f*(both - differ)/std::sqrt(static_cast<float>(query.signatureCount())*m_gallerySignatureCount[i]) : 0;
+
+				std::pair<float, int> entry(-score, i);
+				if( static_cast<int>(heap.size()) == shortlist )
+				{
+					if( !(entry < heap.front()) ) continue;
+					std::pop_heap(heap.begin(), heap.end());
+					heap.back() = entry;
+				}else
+				{
+					heap.push_back(entry);
+				}
+				std::push_heap(heap.begin(), heap.end());
+			}
+		});
+
+		std::vector<std::pair<float, int> > merged;
+		for(int t = 0; t < numThreads; t++) merged.insert(merged.end(), best[t].begin(), best[t].end());
+		std::nth_element(merged.begin(), merged.begin() + shortlist, merged.end());
+		merged.resize(shortlist);
+
+		candidates.resize(shortlist);
+		for(int k = 0; k < shortlist; k++) candidates[k] = merged[k].second;
+	}else
+	{
+		candidates.resize(count);
+		for(int k = 0; k < count; k++) candidates[k] = k;
+	}
+
+	//Second pass, the shortlist in full
+	results.resize(candidates.size());
+	parallelFor(0, static_cast<int>(candidates.size()), numThreads, [&](int, int begin, int end)
+	{
+		for(int k = begin; k < end; k++)
+		{
+			int id = candidates[k];
+			int first = m_galleryStart[id];
+			results[k].id = id;
+			results[k].score = scoreCylinders(query.bits(), query.angle(), query.norm(), query.size(),
+					&m_galleryBits[static_cast<size_t>(first)*cylinderTemplate::cylinderWords], &m_galleryAngle[first],
+					&m_galleryNorm[first], m_galleryStart[id + 1] - first);
+		}
+	});
+
+	//Best first, ties by id
+	int keep = std::min(maxResults, static_cast<int>(results.size()));
+	std::partial_sort(results.begin(), results.begin() + keep, results.end(),
+		[](const matchResult &a, const matchResult &b)
+		{
+			return (a.score != b.score) ? a.score > b.score : a.id < b.id;
+		});
+	results.resize(keep);
+}
+
+//Similarity of cylinder sets
+float minutiaeMatcher::scoreCylinders(const uint64_t *bitsA, const float *angleA, const float *normA, int countA,
+		const uint64_t *bitsB, const float *angleB, const float *normB, int countB) const
+{
+	if( countA == 0 || countB == 0 ) return 0;
+
+	//More pairs are averaged for larger templates, rising smoothly from minPairs around 20 minutiae
+	int smaller = std::min(countA, countB);
+	int wanted = minPairs + static_cast<int>(std::lround((maxPairs - minPairs)/(1 + std::exp(-0.4*(smaller - 20)))));
+
+	//Best pairs so far, in descending order
+	float best[maxPairs];
+	int found = 0;
+	int differ[64];
+	float similar[64];
+	for(int a = 0; a < countA; a++)
+	{
+		const uint64_t *cylA = bitsA + static_cast<size_t>(a)*cylinderTemplate::cylinderWords;
+		for(int b0 = 0; b0 < countB; b0 += 64)
+		{
+			//Bits that differ from a run of cylinders at once
+			int run = std::min(64, countB - b0);
+			popcountXorMany(cylA, bitsB + static_cast<size_t>(b0)*cylinderTemplate::cylinderWords, run,
+					cylinderTemplate::cylinderWords, differ);
+
+			//Without branches, so the loop vectorizes. Cylinders of minutiae turned too far
+			//from each other never match
+			for(int r = 0; r < run; r++)
+			{
+				int b = b0 + r;
+				float norms = normA[a] + normB[b];
+				float sim = 1 - std::sqrt(static_cast<float>(differ[r]))/std::max(norms, 1.0f);
+				bool turned = angleDifference(angleA[a], angleB[b]) > static_cast<float>(M_PI)/2;
+				similar[r] = (turned || norms == 0) ? 0.0f : sim;
+			}
+
+			for(int r = 0; r < run; r++)
+			{
+				float sim = similar[r];
+				if( sim <= 0 || (found == wanted && sim <= best[found - 1]) ) continue;
+
+				//Insert in order, dropping the worst when full
+				int k = (found < wanted) ? found++ : found - 1;
+				for(; k > 0 && best[k - 1] < sim; k--) best[k] = best[k - 1];
+				best[k] = sim;
+			}
+		}
+	}
+
+	float sum = 0;
+	for(int k = 0; k < found; k++) sum += best[k];
+	return sum/wanted;
+}
+
+} // End namespace fpTools
@@ -0,0 +1,185 @@
+/*!
+ *    \file  minutiaeMatcher.h
+ *   \brief  1:N matching of minutiae templates by cylinder codes
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+#include <stdint.h>
+
+//fpTools
+#include "fpTools/minutiaeSet.h"
+#include "fpTools/cylinderTemplate.h"
+
+#ifndef MINUTIAEMATCHER_H
+#define MINUTIAEMATCHER_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  A gallery template and its score against a query
+ */
+struct matchResult
+{
+	int id; /**< Index of the template in the gallery */
+	float score; /**< Similarity, 0 to 1 */
+};
+
+/*!
+ *  \brief  Class to encode minutiae as cylinder codes and search a gallery of them
+ *
+ *  Two cylinders are compared by the bits that differ, 1 - sqrt(|a ^ b|)/(sqrt|a| + sqrt|b|),
+ *  so a comparison is a handful of popcounts. Two templates score the mean of their best
+ *  matching pairs of cylinders. A search first ranks the whole gallery by the pairs of
+ *  minutiae in its signature, then scores only the shortlist in full. Both passes are spread over
+ *  the threads set.
+ */
+class minutiaeMatcher
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor
+		 */
+		minutiaeMatcher () : m_radius(70.0f), m_shortlist(100), m_numThreads(1), m_galleryStart(1, 0) {}  /* constructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get the radius of a cylinder in pixels
+		 */
+		float getRadius() const {return m_radius;}
+
+		/*!
+		 *  \brief  Get the number of candidates scored in full by search
+		 */
+		int getShortlist() const {return m_shortlist;}
+
+		/*!
+		 *  \brief  Get number of threads used by search
+		 */
+		int getNumThreads() const {return m_numThreads;}
+
+		/*!
+		 *  \brief  Get number of templates in the gallery
+		 */
+		int gallerySize() const {return static_cast<int>(m_galleryStart.size()) - 1;}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Set the radius of a cylinder
+		 *
+		 *  \param  radius float Radius in pixels, 70 suits 500 dpi. Templates encoded with
+		 *  		different radii do not match
+		 */
+		void setRadius(float radius){m_radius = radius;}
+
+		/*!
+		 *  \brief  Set the number of candidates scored in full by search
+		 *
+		 *  \param  shortlist int Candidates kept by the signature pass, 0 to score the whole gallery
+		 */
+		void setShortlist(int shortlist){m_shortlist = shortlist;}
+
+		/*!
+		 *  \brief  Set number of threads used by search
+		 *
+		 *  \param  numThreads int Number of threads, 1 for serial, 0 for all cores
+		 */
+		void setNumThreads(int numThreads){m_numThreads = numThreads;}
+
+		/*!
+		 *  \brief  Add a template to the gallery
+		 *
+		 *  \param[in]  print cylinderTemplate The template
+		 *
+		 *  \return int Id of the template, its index in the gallery
+		 */
+		int addToGallery(const cylinderTemplate &print);
+
+		/*!
+		 *  \brief  Remove every template from the gallery
+		 */
+		void clearGallery();
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Encode the minutiae of a print
+		 *
+		 *  \param[in]  minutiae minutiaeSet The minutiae
+		 *  \param[out] print cylinderTemplate The template, one cylinder per minutia with at
+		 *  		least two neighbours in its radius
+		 */
+		void encode(const minutiaeSet &minutiae, cylinderTemplate &print) const;
+
+		/*!
+		 *  \brief  Similarity of two templates
+		 *
+		 *  \param[in]  a cylinderTemplate First template
+		 *  \param[in]  b cylinderTemplate Second template
+		 *
+		 *  \return float 0 to 1
+		 */
+		float similarity(const cylinderTemplate &a, const cylinderTemplate &b) const;
+
+		/*!
+		 *  \brief  Find the gallery templates most similar to a query
+		 *
+		 *  \param[in]  query cylinderTemplate The query
+		 *  \param  maxResults int Number of results wanted
+		 *  \param[out] results std::vector<matchResult> Best first
+		 */
+		void search(const cylinderTemplate &query, int maxResults, std::vector<matchResult> &results) const;
+
+		/*!
+		 *  \brief  Similarity of two sets of cylinders, such as the templates of a templateGallery
+		 *
+		 *  \param  bitsA const uint64_t* Cylinders of the first set
+		 *  \param  angleA const float* Angles of the first set
+		 *  \param  normA const float* Norms of the first set
+		 *  \param  countA int Cylinders in the first set
+		 *  \param  bitsB const uint64_t* Cylinders of the second set
+		 *  \param  angleB const float* Angles of the second set
+		 *  \param  normB const float* Norms of the second set
+		 *  \param  countB int Cylinders in the second set
+		 *
+		 *  \return float 0 to 1
+		 */
+		float scoreCylinders(const uint64_t *bitsA, const float *angleA, const float *normA, int countA,
+				const uint64_t *bitsB, const float *angleB, const float *normB, int countB) const;
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		float m_radius; /**< Radius of a cylinder */
+		int m_shortlist; /**< Candidates scored in full */
+		int m_numThreads; /**< Threads used by search */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		std::vector<uint64_t> m_galleryBits; /**< Cylinders of every template, one after the other */
+		std::vector<float> m_galleryAngle; /**< Angles of every cylinder */
+		std::vector<float> m_galleryNorm; /**< Norms of every cylinder */
+		std::vector<int> m_galleryStart; /**< First cylinder of each template, and one past the last */
+		std::vector<uint64_t> m_gallerySignature; /**< Signatures of every template */
+		std::vector<int> m_gallerySignatureCount; /**< Bits set in each signature */
+
+}; /* -----  end of class minutiaeMatcher  ----- */
+
+} // End namespace fpTools
+
+#endif //MINUTIAEMATCHER_H
@@ -0,0 +1,149 @@
+/*!
+ *    \file  minutiaeSet.h
+ *   \brief  Structure-of-arrays container of minutiae
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+#include <stdint.h>
+
+#ifndef MINUTIAESET_H
+#define MINUTIAESET_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Kind of minutia, the crossing number of the skeleton pixel
+ */
+enum minutiaType
+{
+	MINUTIA_ENDING = 1, /**< A ridge ends */
+	MINUTIA_BIFURCATION = 3 /**< A ridge splits in two */
+};
+
+/*!
+ *  \brief  Minutiae of one print, each field in an array of its own
+ *
+ *  Every field is contiguous, so a matcher streams only the fields it needs and the set
+ *  can be written or read with one copy per field. Minutiae are kept in the order they
+ *  were added, which for the detector is raster order.
+ */
+class minutiaeSet
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor, empty set
+		 */
+		minutiaeSet() {}
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get number of minutiae
+		 */
+		int size() const {return static_cast<int>(m_x.size());}
+
+		/*!
+		 *  \brief  Get the columns, in pixels
+		 */
+		const uint16_t* x() const {return m_x.data();}
+
+		/*!
+		 *  \brief  Get the rows, in pixels
+		 */
+		const uint16_t* y() const {return m_y.data();}
+
+		/*!
+		 *  \brief  Get the angles in radians, -pi to pi, x to the right and y down
+		 *
+		 *  An ending points away from its ridge, a bifurcation into the fork, away from the
+		 *  ridge that splits.
+		 */
+		const float* angle() const {return m_angle.data();}
+
+		/*!
+		 *  \brief  Get the types, as minutiaType
+		 */
+		const uint8_t* type() const {return m_type.data();}
+
+		/*!
+		 *  \brief  Get the qualities, 0 to 100
+		 */
+		const uint8_t* quality() const {return m_quality.data();}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Remove every minutia, keeping the storage
+		 */
+		void clear()
+		{
+			m_x.clear();
+			m_y.clear();
+			m_angle.clear();
+			m_type.clear();
+			m_quality.clear();
+		}
+
+		/*!
+		 *  \brief  Reserve storage
+		 *
+		 *  \param  count int Number of minutiae
+		 */
+		void reserve(int count)
+		{
+			m_x.reserve(count);
+			m_y.reserve(count);
+			m_angle.reserve(count);
+			m_type.reserve(count);
+			m_quality.reserve(count);
+		}
+
+		/*!
+		 *  \brief  Add a minutia
+		 *
+		 *  \param  x int Column
+		 *  \param  y int Row
+		 *  \param  angle float Angle in radians
+		 *  \param  type minutiaType Type
+		 *  \param  quality int Quality, 0 to 100
+		 */
+		void add(int x, int y, float angle, minutiaType type, int quality)
+		{
+			m_x.push_back(static_cast<uint16_t>(x));
+			m_y.push_back(static_cast<uint16_t>(y));
+			m_angle.push_back(angle);
+			m_type.push_back(static_cast<uint8_t>(type));
+			m_quality.push_back(static_cast<uint8_t>(quality));
+		}
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		std::vector<uint16_t> m_x; /**< Columns */
+		std::vector<uint16_t> m_y; /**< Rows */
+		std::vector<float> m_angle; /**< Angles */
+		std::vector<uint8_t> m_type; /**< Types */
+		std::vector<uint8_t> m_quality; /**< Qualities */
+
+}; /* -----  end of class minutiaeSet  ----- */
+
+} // End namespace fpTools
+
+#endif //MINUTIAESET_H
@@ -0,0 +1,228 @@
+/*!
+ *    \file  orientationField.cpp
+ *   \brief  Implimentation of block-wise orientation and frequency estimation
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools/orientationField.h"
+#include "fpTools/simdKernels.h"
+#include "fpTools_utility/parallelFor.h"
+
+namespace fpTools{
+
+//Estimate orientation and frequency
+bool orientationField::compute(const image8u &image)
+{
+	m_rows = image.rows();
+	m_cols = image.cols();
+	if( m_blockSize <= 0 || m_rows < m_blockSize || m_cols < m_blockSize ) return false;
+
+	//Buffers are kept between calls, so only the first image of a size allocates
+	int numThreads = resolveThreads(m_numThreads);
+	if( static_cast<int>(m_scratch.size()) < numThreads ) m_scratch.resize(numThreads);
+	integrateTensor(image, numThreads);
+
+	//Tensor of a window two blocks wide around each block, as a doubled-angle vector
+	int blockRows = m_rows/m_blockSize;
+	int blockCols = m_cols/m_blockSize;
+	size_t stride = static_cast<size_t>(m_cols) + 1;
+	m_vecX.resize(blockRows, blockCols);
+	m_vecY.resize(blockRows, blockCols);
+
+	parallelFor(0, blockRows, numThreads, [&](int, int begin, int end)
+	{
+		for(int by = begin; by < end; by++)
+		{
+			size_t y0 = std::max(0, by*m_blockSize - m_blockSize/2)*stride;
+			size_t y1 = std::min(m_rows, (by + 1)*m_blockSize + m_blockSize/2)*stride;
+			for(int bx = 0; bx < blockCols; bx++)
+			{
+				size_t x0 = std::max(0, bx*m_blockSize - m_blockSize/2);
+				size_t x1 = std::min(m_cols, (bx + 1)*m_blockSize + m_blockSize/2);
+
+				double xx = m_sumXX[y1 + x1] - m_sumXX[y1 + x0] - m_sumXX[y0 + x1] + m_sumXX[y0 + x0];
+				double yy = m_sumYY[y1 + x1] - m_sumYY[y1 + x0] - m_sumYY[y0 + x1] + m_sumYY[y0 + x0];
+				double xy = m_sumXY[y1 + x1] - m_sumXY[y1 + x0] - m_sumXY[y0 + x1] + m_sumXY[y0 + x0];
+
+				//Normalized, so the length is the coherence of the block
+				double energy = xx + yy;
+				m_vecX(by, bx) = (energy > 0) ? (xx - yy)/energy : 0;
+				m_vecY(by, bx) = (energy > 0) ? 2*xy/energy : 0;
+			}
+		}
+	});
+
+	//Smooth the vectors over neighbouring blocks, ridges run across the mean gradient
+	m_orientation.resize(blockRows, blockCols);
+	m_coherence.resize(blockRows, blockCols);
+	parallelFor(0, blockRows, numThreads, [&](int, int begin, int end)
+	{
+		for(int by = begin; by < end; by++)
+		{
+			for(int bx = 0; bx < blockCols; bx++)
+			{
+				float sumX = 0;
+				float sumY = 0;
+				int count = 0;
+				for(int ny = std::max(0, by - m_smoothing); ny <= std::min(blockRows - 1, by + m_smoothing); ny++)
+				{
+					for(int nx = std::max(0, bx - m_smoothing); nx <= std::min(blockCols - 1, bx + m_smoothing); nx++)
+					{
+						sumX += m_vecX(ny, nx);
+						sumY += m_vecY(ny, nx);
+						count++;
+					}
+				}
+
+				float theta = 0.5f*std::atan2(sumY, sumX) + static_cast<float>(M_PI)/2;
+				if( theta >= static_cast<float>(M_PI) ) theta -= static_cast<float>(M_PI);
+				m_orientation(by, bx) = theta;
+				m_coherence(by, bx) = std::sqrt(sumX*sumX + sumY*sumY)/count;
+			}
+		}
+	});
+
+	//Period across the ridges of each block
+	m_frequency.resize(blockRows, blockCols);
+	parallelFor(0, blockRows, numThreads, [&](int thread, int begin, int end)
+	{
+		for(int by = begin; by < end; by++)
+		{
+			for(int bx = 0; bx < blockCols; bx++) m_frequency(by, bx) = blockFrequency(image, by, bx, m_scratch[thread]);
+		}
+	});
+
+	return true;
+}
+
+//Integrate gradient tensor
+void orientationField::integrateTensor(const image8u &image, int numThreads)
+{
+	size_t stride = static_cast<size_t>(m_cols) + 1;
+	m_sumXX.assign((m_rows + 1)*stride, 0);
+	m_sumYY.assign((m_rows + 1)*stride, 0);
+	m_sumXY.assign((m_rows + 1)*stride, 0);
+
+	//Running sums along each row, rows are independent
+	parallelFor(0, m_rows, numThreads, [&](int thread, int begin, int end)
+	{
+		std::vector<int32_t> &xx = m_scratch[thread].xx;
+		std::vector<int32_t> &yy = m_scratch[thread].yy;
+		std::vector<int32_t> &xy = m_scratch[thread].xy;
+		xx.resize(m_cols);
+		yy.resize(m_cols);
+		xy.resize(m_cols);
+		for(int r = begin; r < end; r++)
+		{
+			//Edge rows use themselves for the row outside
+			const uint8_t *up = image.data() + static_cast<size_t>(std::max(r - 1, 0))*m_cols;
+			const uint8_t *mid = image.data() + static_cast<size_t>(r)*m_cols;
+			const uint8_t *down = image.data() + static_cast<size_t>(std::min(r + 1, m_rows - 1))*m_cols;
+			sobelTensorRow(up, mid, down, m_cols, xx.data(), yy.data(), xy.data());
+
+			int64_t *outXX = &m_sumXX[(r + 1)*stride + 1];
+			int64_t *outYY = &m_sumYY[(r + 1)*stride + 1];
+			int64_t *outXY = &m_sumXY[(r + 1)*stride + 1];
+			int64_t runXX = 0, runYY = 0, runXY = 0;
+			for(int c = 0; c < m_cols; c++)
+			{
+				runXX += xx[c];
+				runYY += yy[c];
+				runXY += xy[c];
+				outXX[c] = runXX;
+				outYY[c] = runYY;
+				outXY[c] = runXY;
+			}
+		}
+	});
+
+	//Then down each column, a band of columns per thread
+	parallelFor(1, m_cols + 1, numThreads, [&](int, int begin, int end)
+	{
+		for(int r = 1; r <= m_rows; r++)
+		{
+			size_t above = (r - 1)*stride;
+			size_t here = r*stride;
+			for(int c = begin; c < end; c++)
+			{
+				m_sumXX[here + c] += m_sumXX[above + c];
+				m_sumYY[here + c] += m_sumYY[above + c];
+				m_sumXY[here + c] += m_sumXY[above + c];
+			}
+		}
+	});
+}
+
+//Frequency of a block
+float orientationField::blockFrequency(const image8u &image, int by, int bx, fieldScratch &scratch) const
+{
+	//Grey levels along a line across the ridges, two blocks long, each averaged along
+	//the ridges over a block
+	float theta = m_orientation(by, bx);
+	float alongX = std::cos(theta);
+	float alongY = std::sin(theta);
+	float centerX = (bx + 0.5f)*m_blockSize;
+	float centerY = (by + 0.5f)*m_blockSize;
+
+	int length = 2*m_blockSize;
+	std::vector<float> &signature = scratch.signature;
+	signature.assign(length, 0);
+	for(int k = 0; k < length; k++)
+	{
+		float across = k - length/2 + 0.5f;
+		float sum = 0;
+		int count = 0;
+		for(int j = 0; j < m_blockSize; j++)
+		{
+			float along = j - m_blockSize/2 + 0.5f;
+			int x = static_cast<int>(std::floor(centerX - across*alongY + along*alongX));
+			int y = static_cast<int>(std::floor(centerY + across*alongX + along*alongY));
+			if( x < 0 || y < 0 || x >= m_cols || y >= m_rows ) continue;
+
+			sum += image(y, x);
+			count++;
+		}
+		signature[k] = (count > 0) ? sum/count : 0;
+	}
+
+	//Mean distance between the peaks, after a light smoothing
+	int first = -1;
+	int last = -1;
+	int peaks = 0;
+	for(int k = 2; k < length - 2; k++)
+	{
+		float prev = signature[k - 2] + 2*signature[k - 1] + signature[k];
+		float here = signature[k - 1] + 2*signature[k] + signature[k + 1];
+		float next = signature[k] + 2*signature[k + 1] + signature[k + 2];
+		if( here > prev && here >= next )
+		{
+			if( first < 0 ) first = k;
+			last = k;
+			peaks++;
+		}
+	}
+	if( peaks < 2 ) return 0;
+
+	//Ridge periods at 500 dpi are 3 to 25 pixels
+	float period = static_cast<float>(last - first)/(peaks - 1);
+	if( period < 3 || period > 25 ) return 0;
+	return 1/period;
+}
+
+} // End namespace fpTools
@@ -0,0 +1,215 @@
+/*!
+ *    \file  orientationField.h
+ *   \brief  Block-wise ridge orientation and frequency estimation
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+#include <stdint.h>
+#include <algorithm>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+
+#ifndef ORIENTATIONFIELD_H
+#define ORIENTATIONFIELD_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Class to estimate the ridge orientation and frequency of a print, a block at a time
+ *
+ *  Sobel gradient tensors are summed into integral images, so the tensor of the window
+ *  around each block costs four lookups whatever the window size. The orientations are
+ *  smoothed over neighbouring blocks as doubled-angle vectors, then the ridge period of
+ *  each block is measured from the grey levels across the ridges. Blocks are spread over
+ *  the threads set.
+ */
+class orientationField
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Constructor
+		 *
+		 *  \param  blockSize int Side of a block in pixels, 16 suits 500 dpi
+		 */
+		orientationField (int blockSize = 16) : m_blockSize(blockSize), m_smoothing(1), m_numThreads(1),
+			m_rows(0), m_cols(0) {}                             /* constructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get the side of a block in pixels
+		 */
+		int getBlockSize() const {return m_blockSize;}
+
+		/*!
+		 *  \brief  Get the radius, in blocks, orientations are smoothed over
+		 */
+		int getSmoothing(){return m_smoothing;}
+
+		/*!
+		 *  \brief  Get number of threads used by compute
+		 */
+		int getNumThreads(){return m_numThreads;}
+
+		/*!
+		 *  \brief  Get the number of block rows
+		 */
+		int blockRows() const {return static_cast<int>(m_orientation.rows());}
+
+		/*!
+		 *  \brief  Get the number of block cols
+		 */
+		int blockCols() const {return static_cast<int>(m_orientation.cols());}
+
+		/*!
+		 *  \brief  Get the ridge orientation of each block
+		 *
+		 *  \return Eigen::MatrixXf Radians, 0 to pi, from the x axis towards y, x to the right and y down
+		 */
+		const Eigen::MatrixXf& orientation() const {return m_orientation;}
+
+		/*!
+		 *  \brief  Get how consistent the orientation of each block is
+		 *
+		 *  \return Eigen::MatrixXf 0 for no dominant orientation to 1 for parallel ridges
+		 */
+		const Eigen::MatrixXf& coherence() const {return m_coherence;}
+
+		/*!
+		 *  \brief  Get the ridge frequency of each block
+		 *
+		 *  \return Eigen::MatrixXf Ridges per pixel, 0 where no period was found
+		 */
+		const Eigen::MatrixXf& frequency() const {return m_frequency;}
+
+		/*!
+		 *  \brief  Get the ridge orientation at a pixel, from its block
+		 */
+		float orientationAt(int x, int y) const {return m_orientation(blockRow(y), blockCol(x));}
+
+		/*!
+		 *  \brief  Get the ridge frequency at a pixel, from its block
+		 */
+		float frequencyAt(int x, int y) const {return m_frequency(blockRow(y), blockCol(x));}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Set the side of a block
+		 *
+		 *  \param  blockSize int Side in pixels, about two ridge periods
+		 */
+		void setBlockSize(int blockSize){m_blockSize = blockSize;}
+
+		/*!
+		 *  \brief  Set how far orientations are smoothed
+		 *
+		 *  \param  smoothing int Radius in blocks, 0 to leave each block alone
+		 */
+		void setSmoothing(int smoothing){m_smoothing = smoothing;}
+
+		/*!
+		 *  \brief  Set number of threads used by compute
+		 *
+		 *  \param  numThreads int Number of threads, 1 for serial, 0 for all cores
+		 */
+		void setNumThreads(int numThreads){m_numThreads = numThreads;}
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Estimate the orientation and frequency of every block of an image
+		 *
+		 *  \param[in]  image image8u The grey level print
+		 *
+		 *  \return bool False if the image is smaller than a block
+		 */
+		bool compute(const image8u &image);
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/*!
+		 *  \brief  Buffers of one thread, sized to a row of the image and a block
+		 */
+		struct fieldScratch
+		{
+			std::vector<int32_t> xx; /**< Tensor gx*gx of a row */
+			std::vector<int32_t> yy; /**< Tensor gy*gy of a row */
+			std::vector<int32_t> xy; /**< Tensor gx*gy of a row */
+			std::vector<float> signature; /**< Grey levels across the ridges of a block */
+		};
+
+		/*!
+		 *  \brief  Integral images of the gradient tensor of an image
+		 *
+		 *  \param[in]  image image8u The image
+		 *  \param  numThreads int Threads to use
+		 */
+		void integrateTensor(const image8u &image, int numThreads);
+
+		/*!
+		 *  \brief  Ridge frequency of one block
+		 *
+		 *  \param[in]  image image8u The image
+		 *  \param  by int Block row
+		 *  \param  bx int Block col
+		 *  \param  scratch fieldScratch Buffers of the thread
+		 *
+		 *  \return float Ridges per pixel, 0 if no period was found
+		 */
+		float blockFrequency(const image8u &image, int by, int bx, fieldScratch &scratch) const;
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/*!
+		 *  \brief  Block row of a pixel row, clamped to the field
+		 */
+		int blockRow(int y) const {return std::min(std::max(y/m_blockSize, 0), blockRows() - 1);}
+
+		/*!
+		 *  \brief  Block col of a pixel col, clamped to the field
+		 */
+		int blockCol(int x) const {return std::min(std::max(x/m_blockSize, 0), blockCols() - 1);}
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		int m_blockSize; /**< Side of a block */
+		int m_smoothing; /**< Radius orientations are smoothed over, in blocks */
+		int m_numThreads; /**< Threads used by compute */
+		int m_rows; /**< Rows of the last image */
+		int m_cols; /**< Cols of the last image */
+
+		std::vector<int64_t> m_sumXX; /**< Integral image of gx*gx, rows + 1 by cols + 1 */
+		std::vector<int64_t> m_sumYY; /**< Integral image of gy*gy */
+		std::vector<int64_t> m_sumXY; /**< Integral image of gx*gy */
+		Eigen::MatrixXf m_vecX; /**< Doubled-angle tensor of each block, X */
+		Eigen::MatrixXf m_vecY; /**< Doubled-angle tensor of each block, Y */
+		std::vector<fieldScratch> m_scratch; /**< Buffers of each thread */
+
+		Eigen::MatrixXf m_orientation; /**< Ridge orientation of each block */
+		Eigen::MatrixXf m_coherence; /**< Coherence of each block */
+		Eigen::MatrixXf m_frequency; /**< Ridge frequency of each block */
+
+}; /* -----  end of class orientationField  ----- */
+
+} // End namespace fpTools
+
+#endif //ORIENTATIONFIELD_H
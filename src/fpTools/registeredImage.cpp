@@ -0,0 +1,122 @@
+/*!
+ *    \file  registeredImage.cpp
+ *   \brief  Implimentation of registered image view
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+//STL
+#include <vector>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools/registeredImage.h"
+
+namespace fpTools{
+
+//Constructor
+template<typename Image>
+basicRegisteredImage<Image>::basicRegisteredImage(const Image &image, int lengthOfScan,
+		const std::vector<int> &posX, const std::vector<int> &posY) :
+	m_image(NULL), m_lengthOfScan(0), m_rows(0), m_cols(0)
+{
+	assign(image, lengthOfScan, posX, posY);
+}
+
+//Point at other scans
+template<typename Image>
+void basicRegisteredImage<Image>::assign(const Image &image, int lengthOfScan,
+		const std::vector<int> &posX, const std::vector<int> &posY)
+{
+	m_image = &image;
+	m_lengthOfScan = lengthOfScan;
+	m_posX.assign(posX.begin(), posX.end());
+	m_posY.assign(posY.begin(), posY.end());
+
+	//Extent of the registered image
+	m_rows = 0;
+	m_cols = 0;
+	for(size_t k = 0; k < m_posX.size(); k++)
+	{
+		if( m_posY[k] + m_lengthOfScan > m_rows ) m_rows = m_posY[k] + m_lengthOfScan;
+		if( m_posX[k] + image.cols() > m_cols ) m_cols = m_posX[k] + image.cols();
+	}
+
+	//Count scanlines covering each row
+	m_rowStart.assign(m_rows + 1, 0);
+	for(size_t k = 0; k < m_posY.size(); k++)
+	{
+		for(int i = 0; i < m_lengthOfScan; i++) m_rowStart[m_posY[k] + i + 1]++;
+	}
+	for(int y = 0; y < m_rows; y++) m_rowStart[y+1] += m_rowStart[y];
+
+	//List them in swipe order so later lines draw last, the start of each row is its cursor
+	m_rowLines.resize(m_rowStart[m_rows]);
+	for(size_t k = 0; k < m_posY.size(); k++)
+	{
+		for(int i = 0; i < m_lengthOfScan; i++) m_rowLines[m_rowStart[m_posY[k] + i]++] = k;
+	}
+
+	//Each cursor ended at the start of the next row, shift them back
+	for(int y = m_rows; y > 0; y--) m_rowStart[y] = m_rowStart[y-1];
+	m_rowStart[0] = 0;
+}
+
+//Single pixel
+template<typename Image>
+int basicRegisteredImage<Image>::coeff(int row, int col) const
+{
+	//Last scanline covering the pixel wins
+	for(int n = m_rowStart[row+1] - 1; n >= m_rowStart[row]; n--)
+	{
+		int k = m_rowLines[n];
+		int x = col - m_posX[k];
+		if( x >= 0 && x < m_image->cols() )
+		{
+			return (*m_image)(k*m_lengthOfScan + row - m_posY[k], x);
+		}
+	}
+
+	return 0;
+}
+
+//Single row
+template<typename Image>
+void basicRegisteredImage<Image>::row(int row, Eigen::Matrix<typename Image::Scalar, 1, Eigen::Dynamic> &out) const
+{
+	out.setZero(m_cols);
+
+	for(int n = m_rowStart[row]; n < m_rowStart[row+1]; n++)
+	{
+		int k = m_rowLines[n];
+		out.segment(m_posX[k], m_image->cols()) = m_image->row(k*m_lengthOfScan + row - m_posY[k]);
+	}
+}
+
+//Full image
+template<typename Image>
+void basicRegisteredImage<Image>::materialize(Image &out) const
+{
+	out.setZero(m_rows, m_cols);
+
+	//Copy data
+	for(size_t k = 0; k < m_posX.size(); k++)
+	{
+		out.block(m_posY[k], m_posX[k], m_lengthOfScan, m_image->cols()) =
+			m_image->block(k*m_lengthOfScan, 0, m_lengthOfScan, m_image->cols());
+	}
+}
+
+//Supported scan types
+template class basicRegisteredImage<Eigen::MatrixXi>;
+template class basicRegisteredImage<image8u>;
+template class basicRegisteredImage<image16u>;
+
+} // End namespace fpTools
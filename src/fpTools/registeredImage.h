@@ -0,0 +1,178 @@
+/*!
+ *    \file  registeredImage.h
+ *   \brief  Lightweight view of registered scanlines
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+
+#ifndef REGISTEREDIMAGE_H
+#define REGISTEREDIMAGE_H
+
+namespace fpTools{
+/*!
+ *  \brief  View of a registered image made of the unregistered scans and an offset per scanline
+ *
+ *  No pixels are copied. The view references the stacked scans it was built from, which
+ *  must outlive it. Scanlines later in the swipe are drawn over earlier ones, uncovered
+ *  pixels read as 0, exactly as the materialized image.
+ *
+ *  Instantiated for Eigen::MatrixXi, image8u and image16u scans, see the typedefs below.
+ */
+template<typename Image>
+class basicRegisteredImage
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor, an empty view
+		 */
+		basicRegisteredImage() : m_image(NULL), m_lengthOfScan(0), m_rows(0), m_cols(0) {}
+
+		/*!
+		 *  \brief  Constructor
+		 *
+		 *  \param  image Image The stacked scans, referenced not copied
+		 *  \param  lengthOfScan int The length of the scanline in pixels
+		 *  \param  posX std::vector<int> Column of each scanline in the registered image, 0 or more
+		 *  \param  posY std::vector<int> Row of each scanline in the registered image, 0 or more
+		 */
+		basicRegisteredImage (const Image &image, int lengthOfScan,
+				const std::vector<int> &posX, const std::vector<int> &posY);   /* constructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get number of rows of the registered image
+		 */
+		int rows() const {return m_rows;}
+
+		/*!
+		 *  \brief  Get number of cols of the registered image
+		 */
+		int cols() const {return m_cols;}
+
+		/*!
+		 *  \brief  Get number of scanlines
+		 */
+		int scanLines() const {return static_cast<int>(m_posX.size());}
+
+		/*!
+		 *  \brief  Get scanlength
+		 */
+		int getLengthOfScan() const {return m_lengthOfScan;}
+
+		/*!
+		 *  \brief  Get the stacked scans the view reads from
+		 */
+		const Image* getSource() const {return m_image;}
+
+		/*!
+		 *  \brief  Get the column of a scanline in the registered image
+		 *
+		 *  \param  line int The scanline
+		 */
+		int getOffsetX(int line) const {return m_posX[line];}
+
+		/*!
+		 *  \brief  Get the row of a scanline in the registered image
+		 *
+		 *  \param  line int The scanline
+		 */
+		int getOffsetY(int line) const {return m_posY[line];}
+
+		/*!
+		 *  \brief  Get a single registered pixel
+		 *
+		 *  \param  row int The row in the registered image
+		 *  \param  col int The col in the registered image
+		 *
+		 *  \return int The pixel value
+		 */
+		int coeff(int row, int col) const;
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Point the view at other scans, as the constructor, reusing its buffers
+		 *
+		 *  \param  image Image The stacked scans, referenced not copied
+		 *  \param  lengthOfScan int The length of the scanline in pixels
+		 *  \param  posX std::vector<int> Column of each scanline in the registered image, 0 or more
+		 *  \param  posY std::vector<int> Row of each scanline in the registered image, 0 or more
+		 *
+		 *  Allocates only when there are more scanlines or rows than it has held before.
+		 */
+		void assign(const Image &image, int lengthOfScan, const std::vector<int> &posX, const std::vector<int> &posY);
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Read one registered row
+		 *
+		 *  \param[in]  row int The row in the registered image
+		 *  \param[out] out Eigen::Matrix<Scalar,1,Dynamic> The row, resized to cols()
+		 */
+		void row(int row, Eigen::Matrix<typename Image::Scalar, 1, Eigen::Dynamic> &out) const;
+
+		/*!
+		 *  \brief  Build the full registered image
+		 *
+		 *  \param[out] out Image The registered image, resized to rows() x cols()
+		 */
+		void materialize(Image &out) const;
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		const Image *m_image; /**< Stacked scans */
+		int m_lengthOfScan; /**< Length of scan */
+		int m_rows; /**< Rows of the registered image */
+		int m_cols; /**< Cols of the registered image */
+
+		std::vector<int> m_posX; /**< Column of each scanline */
+		std::vector<int> m_posY; /**< Row of each scanline */
+		std::vector<int> m_rowStart; /**< Start of each row's list in m_rowLines */
+		std::vector<int> m_rowLines; /**< Scanlines covering each row, in swipe order */
+
+}; /* -----  end of class basicRegisteredImage  ----- */
+
+/*!
+ *  \brief  View of registered Eigen::MatrixXi scans
+ */
+typedef basicRegisteredImage<Eigen::MatrixXi> registeredImage;
+
+/*!
+ *  \brief  View of registered 8-bit scans
+ */
+typedef basicRegisteredImage<image8u> registeredImage8u;
+
+/*!
+ *  \brief  View of registered 16-bit scans
+ */
+typedef basicRegisteredImage<image16u> registeredImage16u;
+
+} // End namespace fpTools
+
+#endif //REGISTEREDIMAGE_H
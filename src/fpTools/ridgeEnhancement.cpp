@@ -0,0 +1,261 @@
+/*!
+ *    \file  ridgeEnhancement.cpp
+ *   \brief  Implimentation of Gabor filter bank enhancement
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools/ridgeEnhancement.h"
+#include "fpTools_utility/parallelFor.h"
+
+namespace fpTools{
+
+/*!
+ *  \brief  Shortest ridge period in the bank, in pixels, as found by orientationField
+ */
+static const int minPeriod = 3;
+
+/*!
+ *  \brief  Number of periods in the bank, one per pixel up to 25
+ */
+static const int periodSteps = 23;
+
+/*!
+ *  \brief  Smallest size at least n with no prime factor above 5, which the FFT handles fastest
+ *
+ *  \param  n int The size needed
+ *
+ *  \return int The size
+ */
+static int fftSize(int n)
+{
+	for(;; n++)
+	{
+		int rest = n;
+		while( rest % 2 == 0 ) rest /= 2;
+		while( rest % 3 == 0 ) rest /= 3;
+		while( rest % 5 == 0 ) rest /= 5;
+		if( rest == 1 ) return n;
+	}
+}
+
+//Enhance, computing the field
+bool ridgeEnhancement::enhance(image8u &image)
+{
+	m_field.setNumThreads(m_numThreads);
+	if( !m_field.compute(image) ) return false;
+
+	return enhance(image, m_field);
+}
+
+//Enhance with a field
+bool ridgeEnhancement::enhance(image8u &image, const orientationField &field)
+{
+	int blockSize = field.getBlockSize();
+	if( field.blockRows() == 0 || field.blockRows() != image.rows()/blockSize ||
+			field.blockCols() != image.cols()/blockSize )
+	{
+		std::fprintf(stderr, "Orientation field does not match the image\n");
+		return false;
+	}
+
+	//Blocks with no period take the mean of the others
+	const Eigen::MatrixXf &frequency = field.frequency();
+	double sumFrequency = 0;
+	int validBlocks = 0;
+	for(int k = 0; k < frequency.size(); k++)
+	{
+		if( frequency.data()[k] <= 0 ) continue;
+		sumFrequency += frequency.data()[k];
+		validBlocks++;
+	}
+	if( validBlocks == 0 )
+	{
+		std::fprintf(stderr, "No ridge period found to enhance\n");
+		return false;
+	}
+	float meanFrequency = static_cast<float>(sumFrequency/validBlocks);
+
+	//A partial block at the bottom or right edge uses the field of the block next to it
+	int gridRows = (static_cast<int>(image.rows()) + blockSize - 1)/blockSize;
+	int gridCols = (static_cast<int>(image.cols()) + blockSize - 1)/blockSize;
+	m_filterIndex.resize(gridRows, gridCols);
+	for(int by = 0; by < gridRows; by++)
+	{
+		for(int bx = 0; bx < gridCols; bx++)
+		{
+			int fy = std::min(by, field.blockRows() - 1);
+			int fx = std::min(bx, field.blockCols() - 1);
+			float freq = (frequency(fy, fx) > 0) ? frequency(fy, fx) : meanFrequency;
+			int period = std::min(std::max(static_cast<int>(std::lround(1/freq)) - minPeriod, 0), periodSteps - 1);
+			int angle = static_cast<int>(std::lround(field.orientation()(fy, fx)/M_PI*m_angleSteps)) % m_angleSteps;
+			m_filterIndex(by, bx) = angle*periodSteps + period;
+		}
+	}
+
+	//Buffers are kept between calls, so only the first image of a size allocates
+	int numThreads = resolveThreads(m_numThreads);
+	if( static_cast<int>(m_scratch.size()) < numThreads ) m_scratch.resize(numThreads);
+	updateBank(blockSize, numThreads);
+	m_output.resize(image.rows(), image.cols());
+
+	parallelFor(0, gridRows, numThreads, [&](int thread, int begin, int end)
+	{
+		for(int by = begin; by < end; by++)
+		{
+			for(int bx = 0; bx < gridCols; bx++) filterBlock(image, by, bx, m_filterIndex(by, bx), m_scratch[thread]);
+		}
+	});
+
+	image.swap(m_output);
+	return true;
+}
+
+//Build the filter bank
+void ridgeEnhancement::updateBank(int blockSize, int numThreads)
+{
+	int margin = static_cast<int>(std::ceil(2*m_sigma));
+	int tileSize = fftSize(blockSize + 2*margin);
+
+	for(int t = 0; t < numThreads; t++)
+	{
+		tileScratch &scratch = m_scratch[t];
+		scratch.fft.resize(tileSize, tileSize);
+		scratch.tile.resize(tileSize, tileSize);
+		scratch.spectrum.resize(tileSize, scratch.fft.spectrumCols());
+		scratch.filtered.resize(tileSize, tileSize);
+	}
+
+	if( blockSize == m_bankBlockSize && tileSize == m_bankTileSize && m_sigma == m_bankSigma &&
+			m_angleSteps == m_bankAngleSteps ) return;
+
+	m_bank.resize(m_angleSteps*periodSteps);
+	parallelFor(0, static_cast<int>(m_bank.size()), numThreads, [&](int thread, int begin, int end)
+	{
+		tileScratch &scratch = m_scratch[thread];
+		std::vector<float> envelope((2*margin + 1)*(2*margin + 1));
+		std::vector<float> wave(envelope.size());
+
+		for(int i = begin; i < end; i++)
+		{
+			float theta = static_cast<float>(M_PI)*(i/periodSteps)/m_angleSteps;
+			float period = static_cast<float>(minPeriod + i % periodSteps);
+			float normalX = -std::sin(theta);
+			float normalY = std::cos(theta);
+
+			//Cosine across the ridges under a Gaussian, less its mean so flat areas give 0
+			double sumEnvelope = 0;
+			double sumProduct = 0;
+			for(int dy = -margin, k = 0; dy <= margin; dy++)
+			{
+				for(int dx = -margin; dx <= margin; dx++, k++)
+				{
+					float across = dx*normalX + dy*normalY;
+					envelope[k] = std::exp(-(dx*dx + dy*dy)/(2*m_sigma*m_sigma));
+					wave[k] = std::cos(2*static_cast<float>(M_PI)*across/period);
+					sumEnvelope += envelope[k];
+					sumProduct += envelope[k]*wave[k];
+				}
+			}
+			float offset = static_cast<float>(sumProduct/sumEnvelope);
+
+			//Scaled so a cosine of the same period gives back its amplitude
+			double gain = 0;
+			for(size_t k = 0; k < envelope.size(); k++) gain += envelope[k]*(wave[k] - offset)*wave[k];
+
+			//Centred on the origin, wrapped around the tile
+			scratch.tile.setZero();
+			for(int dy = -margin, k = 0; dy <= margin; dy++)
+			{
+				for(int dx = -margin; dx <= margin; dx++, k++)
+				{
+					scratch.tile((dy + tileSize) % tileSize, (dx + tileSize) % tileSize) =
+						static_cast<float>(envelope[k]*(wave[k] - offset)/gain);
+				}
+			}
+
+			m_bank[i].resize(tileSize, scratch.fft.spectrumCols());
+			scratch.fft.forward(scratch.tile, m_bank[i]);
+		}
+	});
+
+	m_bankBlockSize = blockSize;
+	m_bankTileSize = tileSize;
+	m_bankMargin = margin;
+	m_bankSigma = m_sigma;
+	m_bankAngleSteps = m_angleSteps;
+}
+
+//Filter a block
+void ridgeEnhancement::filterBlock(const image8u &image, int by, int bx, int filter, tileScratch &scratch)
+{
+	int rows = static_cast<int>(image.rows());
+	int cols = static_cast<int>(image.cols());
+	int tileSize = m_bankTileSize;
+	int margin = m_bankMargin;
+	int y0 = by*m_bankBlockSize;
+	int x0 = bx*m_bankBlockSize;
+	int y1 = std::min(y0 + m_bankBlockSize, rows);
+	int x1 = std::min(x0 + m_bankBlockSize, cols);
+
+	//The block and its margin, edges repeated past the image
+	double sum = 0;
+	double sumSquares = 0;
+	for(int r = 0; r < tileSize; r++)
+	{
+		const uint8_t *src = image.data() + static_cast<size_t>(std::min(std::max(y0 - margin + r, 0), rows - 1))*cols;
+		float *dst = scratch.tile.data() + static_cast<size_t>(r)*tileSize;
+		for(int c = 0; c < tileSize; c++)
+		{
+			float value = src[std::min(std::max(x0 - margin + c, 0), cols - 1)];
+			dst[c] = value;
+			sum += value;
+			sumSquares += value*value;
+		}
+	}
+
+	double count = static_cast<double>(tileSize)*tileSize;
+	double mean = sum/count;
+	double deviation = std::sqrt(std::max(sumSquares/count - mean*mean, 0.0));
+	if( deviation < m_minContrast )
+	{
+		for(int y = y0; y < y1; y++) std::fill(m_output.data() + static_cast<size_t>(y)*cols + x0,
+				m_output.data() + static_cast<size_t>(y)*cols + x1, 255);
+		return;
+	}
+
+	//Filter the tile normalized to zero mean and unit deviation
+	scratch.tile.array() = (scratch.tile.array() - static_cast<float>(mean))*static_cast<float>(1/deviation);
+	scratch.fft.forward(scratch.tile, scratch.spectrum);
+	scratch.spectrum.array() *= m_bank[filter].array();
+	scratch.fft.inverse(scratch.spectrum, scratch.filtered);
+
+	//A matched ridge of unit deviation swings by sqrt(2), about 90 grey levels
+	for(int y = y0; y < y1; y++)
+	{
+		uint8_t *dst = m_output.data() + static_cast<size_t>(y)*cols;
+		for(int x = x0; x < x1; x++)
+		{
+			float value = 128 + 64*scratch.filtered(y - y0 + margin, x - x0 + margin);
+			dst[x] = static_cast<uint8_t>(std::min(std::max(value + 0.5f, 0.0f), 255.0f));
+		}
+	}
+}
+
+} // End namespace fpTools
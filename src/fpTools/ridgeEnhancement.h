@@ -0,0 +1,186 @@
+/*!
+ *    \file  ridgeEnhancement.h
+ *   \brief  Contextual enhancement of ridges by a bank of Gabor filters
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+#include "fpTools/fftWorkspace.h"
+#include "fpTools/orientationField.h"
+
+#ifndef RIDGEENHANCEMENT_H
+#define RIDGEENHANCEMENT_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Class to enhance the ridges of a print with Gabor filters tuned to each block
+ *
+ *  Each block of the orientation field is filtered with the Gabor filter closest to its
+ *  orientation and ridge period. The filters are kept as spectra of the size of a block
+ *  and its margin, built once and reused until the block size or the filter shape change,
+ *  so a block costs a forward FFT, a product and an inverse FFT. Rows of blocks are spread
+ *  over the threads set, each with its own FFT workspace and buffers, so nothing is
+ *  allocated per block.
+ */
+class ridgeEnhancement
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor
+		 */
+		ridgeEnhancement () : m_sigma(4.0f), m_angleSteps(16), m_minContrast(4.0f), m_numThreads(1),
+			m_bankBlockSize(0), m_bankTileSize(0), m_bankMargin(0), m_bankSigma(0), m_bankAngleSteps(0) {}  /* constructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get the width of the Gaussian envelope of the filters, in pixels
+		 */
+		float getSigma(){return m_sigma;}
+
+		/*!
+		 *  \brief  Get the number of orientations in the filter bank
+		 */
+		int getAngleSteps(){return m_angleSteps;}
+
+		/*!
+		 *  \brief  Get the local standard deviation below which a block is background
+		 */
+		float getMinContrast(){return m_minContrast;}
+
+		/*!
+		 *  \brief  Get number of threads used to enhance
+		 */
+		int getNumThreads(){return m_numThreads;}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Set the width of the Gaussian envelope of the filters
+		 *
+		 *  \param  sigma float Standard deviation in pixels, 4 by default, the margin read
+		 *  		around each block is twice this
+		 */
+		void setSigma(float sigma){m_sigma = sigma;}
+
+		/*!
+		 *  \brief  Set the number of orientations in the filter bank
+		 *
+		 *  \param  angleSteps int Orientations spread over pi, 16 by default
+		 */
+		void setAngleSteps(int angleSteps){m_angleSteps = angleSteps;}
+
+		/*!
+		 *  \brief  Set the contrast a block needs to be filtered
+		 *
+		 *  \param  minContrast float Standard deviation in grey levels, flatter blocks are
+		 *  		set to 255, background
+		 */
+		void setMinContrast(float minContrast){m_minContrast = minContrast;}
+
+		/*!
+		 *  \brief  Set number of threads used to enhance
+		 *
+		 *  \param  numThreads int Number of threads, 1 for serial, 0 for all cores
+		 */
+		void setNumThreads(int numThreads){m_numThreads = numThreads;}
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Enhance a print, estimating its orientation field first
+		 *
+		 *  \param[in,out] image image8u The grey level print, ridges dark
+		 *
+		 *  \return bool False if the image is smaller than a block
+		 */
+		bool enhance(image8u &image);
+
+		/*!
+		 *  \brief  Enhance a print with a given orientation field
+		 *
+		 *  \param[in,out] image image8u The grey level print, ridges dark. Replaced by the
+		 *  		filtered print, ridges dark around a mean of 128
+		 *  \param[in]  field orientationField The field computed from the image
+		 *
+		 *  \return bool False if the field does not cover the image
+		 */
+		bool enhance(image8u &image, const orientationField &field);
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/*!
+		 *  \brief  Buffers of one thread, sized to a tile
+		 */
+		struct tileScratch
+		{
+			fftWorkspace fft; /**< Plans for a tile */
+			rowMatrixXf tile; /**< A block and its margin, normalized */
+			Eigen::MatrixXcf spectrum; /**< Half spectrum of the tile */
+			Eigen::MatrixXf filtered; /**< The filtered tile */
+		};
+
+		/*!
+		 *  \brief  Build the filter bank if the block size or the filter shape changed
+		 *
+		 *  \param  blockSize int Side of a block of the field
+		 *  \param  numThreads int Threads to use
+		 */
+		void updateBank(int blockSize, int numThreads);
+
+		/*!
+		 *  \brief  Filter one block
+		 *
+		 *  \param[in]  image image8u The print
+		 *  \param  by int Block row
+		 *  \param  bx int Block col
+		 *  \param  filter int Index of the filter in the bank
+		 *  \param  scratch tileScratch Buffers of the thread
+		 */
+		void filterBlock(const image8u &image, int by, int bx, int filter, tileScratch &scratch);
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		float m_sigma; /**< Width of the Gaussian envelope */
+		int m_angleSteps; /**< Orientations in the bank */
+		float m_minContrast; /**< Contrast a block needs to be filtered */
+		int m_numThreads; /**< Threads used to enhance */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		int m_bankBlockSize; /**< Block size the bank was built for */
+		int m_bankTileSize; /**< Side of the tiles the bank was built for */
+		int m_bankMargin; /**< Pixels read around a block, the radius of the filters */
+		float m_bankSigma; /**< Sigma the bank was built for */
+		int m_bankAngleSteps; /**< Orientations the bank was built for */
+		std::vector<Eigen::MatrixXcf> m_bank; /**< Half spectra of the filters, by angle then period */
+
+		std::vector<tileScratch> m_scratch; /**< Buffers of each thread */
+		Eigen::MatrixXi m_filterIndex; /**< Filter picked for each block */
+		image8u m_output; /**< The enhanced print, swapped with the input */
+		orientationField m_field; /**< Field computed by enhance(image) */
+
+}; /* -----  end of class ridgeEnhancement  ----- */
+
+} // End namespace fpTools
+
+#endif //RIDGEENHANCEMENT_H
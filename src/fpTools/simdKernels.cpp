@@ -0,0 +1,296 @@
+/*!
+ *    \file  simdKernels.cpp
+ *   \brief  Implimentation of vectorized inner loops
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+//STL
+#include <cmath>
+
+//SIMD
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//fpTools
+#include "fpTools/simdKernels.h"
+
+namespace fpTools{
+
+//Vector width
+int simdFloatWidth()
+{
+#if defined(__AVX2__)
+	return 8;
+#elif defined(__SSE2__)
+	return 4;
+#else
+	return 1;
+#endif
+}
+
+//Sum of absolute differences
+float sumAbsDiff(const float *a, const float *b, int n)
+{
+	int i = 0;
+	float sum = 0;
+
+#if defined(__AVX2__)
+	//Clear the sign bit for the absolute value
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+	__m256 acc = _mm256_setzero_ps();
+	for(; i + 8 <= n; i += 8)
+	{
+		__m256 diff = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+		acc = _mm256_add_ps(acc, _mm256_and_ps(diff, absMask));
+	}
+
+	//Reduce the lanes
+	__m128 acc4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+	acc4 = _mm_add_ps(acc4, _mm_movehl_ps(acc4, acc4));
+	acc4 = _mm_add_ss(acc4, _mm_shuffle_ps(acc4, acc4, 1));
+	sum = _mm_cvtss_f32(acc4);
+#elif defined(__SSE2__)
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	__m128 acc = _mm_setzero_ps();
+	for(; i + 4 <= n; i += 4)
+	{
+		__m128 diff = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+		acc = _mm_add_ps(acc, _mm_and_ps(diff, absMask));
+	}
+
+	//Reduce the lanes
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+	sum = _mm_cvtss_f32(acc);
+#endif
+
+	//Remainder, or everything without SIMD
+	for(; i < n; i++)
+	{
+		sum += std::fabs(a[i] - b[i]);
+	}
+
+	return sum;
+}
+
+//Threshold bytes
+void thresholdBytes(uint8_t *data, size_t n, int thresh)
+{
+	//Thresholds outside the byte range set every byte alike
+	if( thresh <= 0 || thresh > 255 )
+	{
+		uint8_t value = (thresh <= 0) ? 255 : 0;
+		for(size_t i = 0; i < n; i++) data[i] = value;
+		return;
+	}
+
+	size_t i = 0;
+
+	//x >= thresh exactly where max(x, thresh) == x, which gives the 0 or 255 byte directly
+#if defined(__AVX2__)
+	const __m256i t32 = _mm256_set1_epi8(static_cast<char>(thresh));
+	for(; i + 32 <= n; i += 32)
+	{
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_cmpeq_epi8(_mm256_max_epu8(x, t32), x));
+	}
+#endif
+#if defined(__SSE2__)
+	const __m128i t16 = _mm_set1_epi8(static_cast<char>(thresh));
+	for(; i + 16 <= n; i += 16)
+	{
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_cmpeq_epi8(_mm_max_epu8(x, t16), x));
+	}
+#endif
+
+	//Remainder, or everything without SIMD
+	for(; i < n; i++)
+	{
+		data[i] = (data[i] < thresh) ? 0 : 255;
+	}
+}
+
+//Sobel gradient tensor
+void sobelTensorRow(const uint8_t *up, const uint8_t *mid, const uint8_t *down, int n,
+		int32_t *gxx, int32_t *gyy, int32_t *gxy)
+{
+	if( n <= 0 ) return;
+	gxx[0] = gyy[0] = gxy[0] = 0;
+	gxx[n - 1] = gyy[n - 1] = gxy[n - 1] = 0;
+
+	int i = 1;
+
+	//Pixels i-1, i and i+1 of each row widened to 16 bits, the gradients fit in 16 bits
+#if defined(__AVX2__)
+	for(; i + 17 <= n; i += 16)
+	{
+		__m256i ul = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(up + i - 1)));
+		__m256i uc = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(up + i)));
+		__m256i ur = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(up + i + 1)));
+		__m256i ml = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mid + i - 1)));
+		__m256i mr = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mid + i + 1)));
+		__m256i dl = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(down + i - 1)));
+		__m256i dc = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(down + i)));
+		__m256i dr = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(down + i + 1)));
+
+		__m256i gx = _mm256_sub_epi16(_mm256_add_epi16(_mm256_add_epi16(ur, dr), _mm256_slli_epi16(mr, 1)),
+				_mm256_add_epi16(_mm256_add_epi16(ul, dl), _mm256_slli_epi16(ml, 1)));
+		__m256i gy = _mm256_sub_epi16(_mm256_add_epi16(_mm256_add_epi16(dl, dr), _mm256_slli_epi16(dc, 1)),
+				_mm256_add_epi16(_mm256_add_epi16(ul, ur), _mm256_slli_epi16(uc, 1)));
+
+		//Products in 32 bits, a half at a time
+		for(int h = 0; h < 2; h++)
+		{
+			__m256i x32 = _mm256_cvtepi16_epi32((h == 0) ? _mm256_castsi256_si128(gx) : _mm256_extracti128_si256(gx, 1));
+			__m256i y32 = _mm256_cvtepi16_epi32((h == 0) ? _mm256_castsi256_si128(gy) : _mm256_extracti128_si256(gy, 1));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(gxx + i + 8*h), _mm256_mullo_epi32(x32, x32));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(gyy + i + 8*h), _mm256_mullo_epi32(y32, y32));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(gxy + i + 8*h), _mm256_mullo_epi32(x32, y32));
+		}
+	}
+#endif
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	for(; i + 9 <= n; i += 8)
+	{
+		__m128i ul = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(up + i - 1)), zero);
+		__m128i uc = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(up + i)), zero);
+		__m128i ur = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(up + i + 1)), zero);
+		__m128i ml = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mid + i - 1)), zero);
+		__m128i mr = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mid + i + 1)), zero);
+		__m128i dl = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(down + i - 1)), zero);
+		__m128i dc = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(down + i)), zero);
+		__m128i dr = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(down + i + 1)), zero);
+
+		__m128i gx = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(ur, dr), _mm_slli_epi16(mr, 1)),
+				_mm_add_epi16(_mm_add_epi16(ul, dl), _mm_slli_epi16(ml, 1)));
+		__m128i gy = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(dl, dr), _mm_slli_epi16(dc, 1)),
+				_mm_add_epi16(_mm_add_epi16(ul, ur), _mm_slli_epi16(uc, 1)));
+
+		//32-bit products from the low and high 16 bits of the 16-bit products
+		__m128i lo = _mm_mullo_epi16(gx, gx);
+		__m128i hi = _mm_mulhi_epi16(gx, gx);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(gxx + i), _mm_unpacklo_epi16(lo, hi));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(gxx + i + 4), _mm_unpackhi_epi16(lo, hi));
+		lo = _mm_mullo_epi16(gy, gy);
+		hi = _mm_mulhi_epi16(gy, gy);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(gyy + i), _mm_unpacklo_epi16(lo, hi));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(gyy + i + 4), _mm_unpackhi_epi16(lo, hi));
+		lo = _mm_mullo_epi16(gx, gy);
+		hi = _mm_mulhi_epi16(gx, gy);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(gxy + i), _mm_unpacklo_epi16(lo, hi));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(gxy + i + 4), _mm_unpackhi_epi16(lo, hi));
+	}
+#endif
+
+	//Remainder, or everything without SIMD
+	for(; i + 1 < n; i++)
+	{
+		int gx = (up[i + 1] + 2*mid[i + 1] + down[i + 1]) - (up[i - 1] + 2*mid[i - 1] + down[i - 1]);
+		int gy = (down[i - 1] + 2*down[i] + down[i + 1]) - (up[i - 1] + 2*up[i] + up[i + 1]);
+		gxx[i] = gx*gx;
+		gyy[i] = gy*gy;
+		gxy[i] = gx*gy;
+	}
+}
+
+//Population count of xor
+int popcountXor(const uint64_t *a, const uint64_t *b, int words)
+{
+	int i = 0;
+	int count = 0;
+
+#if defined(__AVX2__)
+	//Count of each nibble by table lookup, bytes summed by sad
+	const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+	__m256i acc = _mm256_setzero_si256();
+	for(; i + 4 <= words; i += 4)
+	{
+		__m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+		__m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble)),
+				_mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+	}
+	__m128i acc2 = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+	count += static_cast<int>(_mm_cvtsi128_si64(acc2) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc2, acc2)));
+#elif defined(__SSE2__)
+	//Bits summed in pairs, nibbles and bytes, then bytes summed by sad
+	const __m128i m1 = _mm_set1_epi8(0x55);
+	const __m128i m2 = _mm_set1_epi8(0x33);
+	const __m128i m4 = _mm_set1_epi8(0x0F);
+	__m128i acc = _mm_setzero_si128();
+	for(; i + 2 <= words; i += 2)
+	{
+		__m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+		x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi64(x, 1), m1));
+		x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi64(x, 2), m2));
+		x = _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi64(x, 4)), m4);
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(x, _mm_setzero_si128()));
+	}
+	count += _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc));
+#endif
+
+	//Remainder, or everything without SIMD
+	for(; i < words; i++)
+	{
+		count += __builtin_popcountll(a[i] ^ b[i]);
+	}
+
+	return count;
+}
+
+//Population count of xor against many
+void popcountXorMany(const uint64_t *a, const uint64_t *b, int count, int words, int *out)
+{
+	int k = 0;
+
+#if defined(__AVX2__)
+	//Vectors of 4 or 8 words, the common cylinder sizes, with a held in registers
+	if( words == 4 || words == 8 )
+	{
+		const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+				0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i nibble = _mm256_set1_epi8(0x0F);
+		__m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+		__m256i a1 = (words == 8) ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 4)) : _mm256_setzero_si256();
+		for(; k < count; k++)
+		{
+			const uint64_t *other = b + static_cast<size_t>(k)*words;
+			__m256i x = _mm256_xor_si256(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other)));
+			__m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble)),
+					_mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+			if( words == 8 )
+			{
+				x = _mm256_xor_si256(a1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other + 4)));
+				bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble)),
+						_mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble))));
+			}
+			__m256i sums = _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+			__m128i sums2 = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+			out[k] = _mm_cvtsi128_si32(_mm_add_epi64(sums2, _mm_unpackhi_epi64(sums2, sums2)));
+		}
+	}
+#endif
+
+	//Any other size, or without AVX2, one at a time
+	for(; k < count; k++)
+	{
+		out[k] = popcountXor(a, b + static_cast<size_t>(k)*words, words);
+	}
+}
+
+} // End namespace fpTools
@@ -0,0 +1,92 @@
+/*!
+ *    \file  simdKernels.h
+ *   \brief  Vectorized inner loops shared by the fpTools classes
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ *  Each kernel has an AVX2 path, used when built with USE_AVX2, an SSE2 path and a
+ *  scalar fallback.
+ */
+
+//STL
+#include <cstddef>
+#include <stdint.h>
+
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Number of floats processed per vector instruction in this build
+ *
+ *  \return int 8 for AVX2, 4 for SSE2, 1 for scalar
+ */
+int simdFloatWidth();
+
+/*!
+ *  \brief  Sum of absolute differences of two float arrays
+ *
+ *  \param  a const float* First array
+ *  \param  b const float* Second array
+ *  \param  n int Number of elements
+ *
+ *  \return float Sum of |a[i] - b[i]|
+ */
+float sumAbsDiff(const float *a, const float *b, int n);
+
+/*!
+ *  \brief  Threshold bytes in place
+ *
+ *  \param[in,out] data uint8_t* The bytes, set to 0 below thresh and 255 otherwise
+ *  \param  n size_t Number of bytes
+ *  \param  thresh int The threshold, any value
+ */
+void thresholdBytes(uint8_t *data, size_t n, int thresh);
+
+/*!
+ *  \brief  Sobel gradient tensor of a row of pixels
+ *
+ *  \param  up const uint8_t* The row above
+ *  \param  mid const uint8_t* The row
+ *  \param  down const uint8_t* The row below
+ *  \param  n int Number of pixels in a row
+ *  \param[out] gxx int32_t* gx*gx of each pixel, 0 at the first and last
+ *  \param[out] gyy int32_t* gy*gy of each pixel, 0 at the first and last
+ *  \param[out] gxy int32_t* gx*gy of each pixel, 0 at the first and last
+ *
+ *  gx increases to the right and gy down.
+ */
+void sobelTensorRow(const uint8_t *up, const uint8_t *mid, const uint8_t *down, int n,
+		int32_t *gxx, int32_t *gyy, int32_t *gxy);
+
+/*!
+ *  \brief  Number of bits that differ between two bit vectors
+ *
+ *  \param  a const uint64_t* First vector
+ *  \param  b const uint64_t* Second vector
+ *  \param  words int Number of 64-bit words
+ *
+ *  \return int Population count of a xor b
+ */
+int popcountXor(const uint64_t *a, const uint64_t *b, int words);
+
+/*!
+ *  \brief  Number of bits that differ between one bit vector and each of a run of others
+ *
+ *  \param  a const uint64_t* The vector
+ *  \param  b const uint64_t* The others, one after the other
+ *  \param  count int Number of others
+ *  \param  words int Number of 64-bit words in each vector
+ *  \param[out] out int* Population count of a xor each of b
+ */
+void popcountXorMany(const uint64_t *a, const uint64_t *b, int count, int words, int *out);
+
+} // End namespace fpTools
+
+#endif //SIMDKERNELS_H
@@ -0,0 +1,595 @@
+/*!
+ *    \file  templateGallery.cpp
+ *   \brief  Implimentation of the memory-mapped template gallery
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+//POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//fpTools
+#include "fpTools/templateGallery.h"
+#include "fpTools_utility/parallelFor.h"
+
+namespace fpTools{
+
+/*!
+ *  \brief  Nearest neighbours of a minutia that make triangles with it
+ */
+static const int tripletNeighbours = 4;
+
+/*!
+ *  \brief  Width of a bin of side length in pixels, and bins per side, longer sides are dropped
+ */
+static const float sideBin = 6.0f;
+static const int sideBins = 32;
+
+/*!
+ *  \brief  Bins of the angle of a minutia to the side leaving it
+ */
+static const int vertexBins = 8;
+
+/*!
+ *  \brief  Most bits of a key used by the directory of a segment
+ */
+static const int maxDirectoryBits = 16;
+
+/*!
+ *  \brief  Templates in the gallery per hit of a query above which votes are counted over
+ *  		the sorted hits rather than in an array over the gallery
+ */
+static const uint64_t sparseVotes = 16;
+
+/*!
+ *  \brief  Round up to the alignment of the file
+ */
+static inline size_t alignUp(size_t bytes)
+{
+	return (bytes + galleryAlignment - 1)/galleryAlignment*galleryAlignment;
+}
+
+/*!
+ *  \brief  Write all of a buffer at an offset of a file
+ *
+ *  \param  fd int The file
+ *  \param  data const void* The bytes
+ *  \param  count size_t Number of bytes
+ *  \param  offset uint64_t Where in the file
+ *
+ *  \return bool False if the write failed
+ */
+static bool writeAt(int fd, const void *data, size_t count, uint64_t offset)
+{
+	const uint8_t *bytes = static_cast<const uint8_t*>(data);
+	while( count > 0 )
+	{
+		ssize_t written = pwrite(fd, bytes, count, static_cast<off_t>(offset));
+		if( written <= 0 ) return false;
+		bytes += written;
+		count -= written;
+		offset += written;
+	}
+	return true;
+}
+
+//Constructor
+templateGallery::templateGallery(const char* fN) :
+	m_fd(-1), m_map(NULL), m_mapSize(0), m_fileSize(0), m_numTemplates(0), m_radius(0)
+{
+	open(fN);
+}
+
+//Create file
+bool templateGallery::create(const char* fN, float radius)
+{
+	close();
+
+	int fd = ::open(fN, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if( fd < 0 )
+	{
+		std::fprintf(stderr, "Unable to open file %s\n", fN);
+		return false;
+	}
+
+	galleryFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, galleryMagic, sizeof(galleryMagic));
+	header.version = 1;
+	header.cylinderWords = cylinderTemplate::cylinderWords;
+	header.signatureWords = cylinderTemplate::signatureWords;
+	header.keyBits = keyBits;
+	header.radius = radius;
+	if( !writeAt(fd, &header, sizeof(header), 0) || fdatasync(fd) != 0 )
+	{
+		std::fprintf(stderr, "Unable to write file %s\n", fN);
+		::close(fd);
+		return false;
+	}
+
+	m_fd = fd;
+	if( !mapFile(sizeof(header)) )
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+//Open file
+bool templateGallery::open(const char* fN)
+{
+	close();
+
+	//A file that cannot be written can still be searched
+	int fd = ::open(fN, O_RDWR);
+	if( fd < 0 ) fd = ::open(fN, O_RDONLY);
+	if( fd < 0 )
+	{
+		std::fprintf(stderr, "Unable to open file %s\n", fN);
+		return false;
+	}
+
+	struct stat info;
+	m_fd = fd;
+	if( fstat(fd, &info) != 0 || !mapFile(static_cast<uint64_t>(info.st_size)) )
+	{
+		std::fprintf(stderr, "Unknown file type %s\n", fN);
+		close();
+		return false;
+	}
+	return true;
+}
+
+//Close file
+void templateGallery::close()
+{
+	if( m_map != NULL ) munmap(m_map, m_mapSize);
+	if( m_fd >= 0 ) ::close(m_fd);
+	m_fd = -1;
+	m_map = NULL;
+	m_mapSize = 0;
+	m_fileSize = 0;
+	m_numTemplates = 0;
+	m_radius = 0;
+	m_segments.clear();
+}
+
+//Segment layout
+size_t templateGallery::segmentLayout(const gallerySegmentHeader &header, size_t *starts)
+{
+	size_t templates = header.numTemplates;
+	size_t cylinders = header.numCylinders;
+	size_t bytes[8] = {
+		(templates + 1)*sizeof(uint32_t),
+		templates*sizeof(uint32_t),
+		templates*cylinderTemplate::signatureWords*sizeof(uint64_t),
+		cylinders*cylinderTemplate::cylinderWords*sizeof(uint64_t),
+		cylinders*sizeof(float),
+		cylinders*sizeof(float),
+		static_cast<size_t>(header.numKeys)*sizeof(galleryKey),
+		((static_cast<size_t>(1) << header.directoryBits) + 1)*sizeof(uint32_t)};
+
+	size_t offset = sizeof(gallerySegmentHeader);
+	for(int k = 0; k < 8; k++)
+	{
+		starts[k] = offset;
+		offset = alignUp(offset + bytes[k]);
+	}
+	return offset;
+}
+
+//Segment offsets
+bool templateGallery::segmentValid(const segmentView &segment)
+{
+	const gallerySegmentHeader &header = *segment.header;
+
+	if( segment.cylinderStart[0] != 0 || segment.cylinderStart[header.numTemplates] != header.numCylinders ) return false;
+	for(uint32_t t = 0; t < header.numTemplates; t++)
+	{
+		if( segment.cylinderStart[t] > segment.cylinderStart[t + 1] ) return false;
+	}
+
+	uint32_t buckets = static_cast<uint32_t>(1) << header.directoryBits;
+	if( segment.directory[0] != 0 || segment.directory[buckets] != header.numKeys ) return false;
+	for(uint32_t b = 0; b < buckets; b++)
+	{
+		if( segment.directory[b] > segment.directory[b + 1] ) return false;
+	}
+
+	for(uint32_t k = 0; k < header.numKeys; k++)
+	{
+		if( segment.keys[k].index >= header.numTemplates ) return false;
+	}
+	return true;
+}
+
+//Map file
+bool templateGallery::mapFile(uint64_t size)
+{
+	if( m_map != NULL ) munmap(m_map, m_mapSize);
+	m_map = NULL;
+	m_mapSize = 0;
+	m_segments.clear();
+	m_numTemplates = 0;
+
+	galleryFileHeader header;
+	if( size < sizeof(header) ) return false;
+
+	m_mapSize = static_cast<size_t>(size);
+	m_map = mmap(NULL, m_mapSize, PROT_READ, MAP_SHARED, m_fd, 0);
+	if( m_map == MAP_FAILED )
+	{
+		m_map = NULL;
+		m_mapSize = 0;
+		return false;
+	}
+
+	//Templates must have the layout this build encodes
+	const uint8_t *bytes = static_cast<const uint8_t*>(m_map);
+	std::memcpy(&header, bytes, sizeof(header));
+	if( std::memcmp(header.magic, galleryMagic, sizeof(galleryMagic)) != 0 || header.version != 1 ||
+			header.cylinderWords != cylinderTemplate::cylinderWords ||
+			header.signatureWords != cylinderTemplate::signatureWords || header.keyBits != keyBits )
+	{
+		return false;
+	}
+	m_radius = header.radius;
+
+	//Segments up to the first one that is not whole, or whose offsets leave its arrays
+	uint64_t offset = sizeof(header);
+	while( offset + sizeof(gallerySegmentHeader) <= size )
+	{
+		const gallerySegmentHeader *segment = reinterpret_cast<const gallerySegmentHeader*>(bytes + offset);
+		size_t starts[8];
+		if( std::memcmp(segment->magic, segmentMagic, sizeof(segmentMagic)) != 0 || segment->firstId != m_numTemplates ||
+				segment->directoryBits > maxDirectoryBits || segment->size != segmentLayout(*segment, starts) ||
+				segment->size > size - offset )
+		{
+			break;
+		}
+
+		const uint8_t *base = bytes + offset;
+		segmentView view;
+		view.offset = offset;
+		view.header = segment;
+		view.cylinderStart = reinterpret_cast<const uint32_t*>(base + starts[0]);
+		view.signatureCount = reinterpret_cast<const uint32_t*>(base + starts[1]);
+		view.signature = reinterpret_cast<const uint64_t*>(base + starts[2]);
+		view.bits = reinterpret_cast<const uint64_t*>(base + starts[3]);
+		view.angle = reinterpret_cast<const float*>(base + starts[4]);
+		view.norm = reinterpret_cast<const float*>(base + starts[5]);
+		view.keys = reinterpret_cast<const galleryKey*>(base + starts[6]);
+		view.directory = reinterpret_cast<const uint32_t*>(base + starts[7]);
+		if( !segmentValid(view) ) break;
+		m_segments.push_back(view);
+
+		m_numTemplates += segment->numTemplates;
+		offset += segment->size;
+	}
+	m_fileSize = offset;
+
+	return true;
+}
+
+//Append a segment
+bool templateGallery::enroll(const std::vector<cylinderTemplate> &prints)
+{
+	if( !isOpen() )
+	{
+		std::fprintf(stderr, "No gallery open to enroll into\n");
+		return false;
+	}
+	if( prints.empty() ) return true;
+
+	//Keys of every template, sorted for the index
+	std::vector<galleryKey> index;
+	std::vector<uint32_t> keys;
+	uint64_t cylinders = 0;
+	for(size_t i = 0; i < prints.size(); i++)
+	{
+		tripletKeys(prints[i], false, keys);
+		for(size_t k = 0; k < keys.size(); k++)
+		{
+			galleryKey entry = {keys[k], static_cast<uint32_t>(i)};
+			index.push_back(entry);
+		}
+		cylinders += prints[i].size();
+	}
+	if( cylinders > UINT32_MAX || index.size() > UINT32_MAX )
+	{
+		std::fprintf(stderr, "Too many templates to enroll at once\n");
+		return false;
+	}
+	std::sort(index.begin(), index.end(), [](const galleryKey &a, const galleryKey &b)
+	{
+		return (a.key != b.key) ? a.key < b.key : a.index < b.index;
+	});
+
+	gallerySegmentHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, segmentMagic, sizeof(segmentMagic));
+	header.numTemplates = static_cast<uint32_t>(prints.size());
+	header.numCylinders = static_cast<uint32_t>(cylinders);
+	header.numKeys = static_cast<uint32_t>(index.size());
+	header.firstId = m_numTemplates;
+
+	//About four keys per bucket of the directory
+	while( static_cast<int>(header.directoryBits) < maxDirectoryBits &&
+			(static_cast<uint64_t>(4) << header.directoryBits) < header.numKeys )
+	{
+		header.directoryBits++;
+	}
+
+	size_t starts[8];
+	header.size = segmentLayout(header, starts);
+	std::vector<uint8_t> segment(header.size, 0);
+
+	uint32_t *cylinderStart = reinterpret_cast<uint32_t*>(&segment[starts[0]]);
+	uint32_t *signatureCount = reinterpret_cast<uint32_t*>(&segment[starts[1]]);
+	uint64_t *signature = reinterpret_cast<uint64_t*>(&segment[starts[2]]);
+	uint64_t *bits = reinterpret_cast<uint64_t*>(&segment[starts[3]]);
+	float *angle = reinterpret_cast<float*>(&segment[starts[4]]);
+	float *norm = reinterpret_cast<float*>(&segment[starts[5]]);
+	uint32_t *directory = reinterpret_cast<uint32_t*>(&segment[starts[7]]);
+
+	uint32_t first = 0;
+	for(size_t i = 0; i < prints.size(); i++)
+	{
+		const cylinderTemplate &print = prints[i];
+		cylinderStart[i] = first;
+		signatureCount[i] = print.signatureCount();
+		std::memcpy(signature + i*cylinderTemplate::signatureWords, print.signature(),
+				cylinderTemplate::signatureWords*sizeof(uint64_t));
+		std::memcpy(bits + static_cast<size_t>(first)*cylinderTemplate::cylinderWords, print.bits(),
+				static_cast<size_t>(print.size())*cylinderTemplate::cylinderWords*sizeof(uint64_t));
+		std::memcpy(angle + first, print.angle(), print.size()*sizeof(float));
+		std::memcpy(norm + first, print.norm(), print.size()*sizeof(float));
+		first += print.size();
+	}
+	cylinderStart[prints.size()] = first;
+	if( !index.empty() ) std::memcpy(&segment[starts[6]], index.data(), index.size()*sizeof(galleryKey));
+
+	//First key of each bucket, by the top bits of the key
+	int shift = keyBits - header.directoryBits;
+	size_t k = 0;
+	for(uint32_t bucket = 0; bucket <= (static_cast<uint32_t>(1) << header.directoryBits); bucket++)
+	{
+		while( k < index.size() && (index[k].key >> shift) < bucket ) k++;
+		directory[bucket] = static_cast<uint32_t>(k);
+	}
+
+	//Anything after the last whole segment is from an enrollment that did not finish. The
+	//header goes last, once the rest is on disk
+	std::memcpy(&segment[0], &header, sizeof(header));
+	if( ftruncate(m_fd, static_cast<off_t>(m_fileSize)) != 0 ||
+			!writeAt(m_fd, &segment[sizeof(header)], segment.size() - sizeof(header), m_fileSize + sizeof(header)) ||
+			fdatasync(m_fd) != 0 || !writeAt(m_fd, &segment[0], sizeof(header), m_fileSize) || fdatasync(m_fd) != 0 )
+	{
+		std::fprintf(stderr, "Unable to append to the gallery\n");
+		return false;
+	}
+
+	return mapFile(m_fileSize + header.size);
+}
+
+//Count votes
+void templateGallery::countVotes(std::vector<uint32_t> &found, uint64_t numTemplates, bool sparse,
+		std::vector<std::pair<int, uint32_t> > &votes)
+{
+	votes.clear();
+	if( sparse )
+	{
+		//Over the sorted hits, costing what the query found rather than the size of the gallery
+		std::sort(found.begin(), found.end());
+		for(size_t k = 0; k < found.size(); )
+		{
+			size_t run = k;
+			while( run < found.size() && found[run] == found[k] ) run++;
+			votes.push_back(std::make_pair(-static_cast<int>(run - k), found[k]));
+			k = run;
+		}
+	}else
+	{
+		std::vector<uint32_t> shared(numTemplates, 0);
+		for(size_t k = 0; k < found.size(); k++)
+		{
+			if( shared[found[k]]++ == 0 ) votes.push_back(std::make_pair(0, found[k]));
+		}
+		for(size_t k = 0; k < votes.size(); k++) votes[k].first = -static_cast<int>(shared[votes[k].second]);
+	}
+}
+
+//Search
+void templateGallery::search(const minutiaeMatcher &matcher, const cylinderTemplate &query, int maxResults,
+		std::vector<matchResult> &results) const
+{
+	results.clear();
+	if( m_numTemplates == 0 || maxResults <= 0 ) return;
+	if( matcher.getRadius() != m_radius )
+	{
+		std::fprintf(stderr, "Gallery was encoded with radius %g, the matcher uses %g\n", m_radius, matcher.getRadius());
+		return;
+	}
+
+	std::vector<uint32_t> keys;
+	tripletKeys(query, true, keys);
+	int numThreads = resolveThreads(matcher.getNumThreads());
+
+	//Templates with each key of the query, each thread taking a range of keys
+	std::vector<std::vector<uint32_t> > hits(numThreads);
+	parallelFor(0, static_cast<int>(keys.size()), numThreads, [&](int thread, int begin, int end)
+	{
+		std::vector<uint32_t> &found = hits[thread];
+		for(size_t s = 0; s < m_segments.size(); s++)
+		{
+			const segmentView &segment = m_segments[s];
+			int shift = keyBits - segment.header->directoryBits;
+			uint32_t firstId = static_cast<uint32_t>(segment.header->firstId);
+			for(int k = begin; k < end; k++)
+			{
+				uint32_t key = keys[k];
+				const galleryKey *last = segment.keys + segment.directory[(key >> shift) + 1];
+				const galleryKey *entry = std::lower_bound(segment.keys + segment.directory[key >> shift], last, key,
+					[](const galleryKey &a, uint32_t b)
+					{
+						return a.key < b;
+					});
+				for(; entry != last && entry->key == key; entry++) found.push_back(firstId + entry->index);
+			}
+		}
+	});
+
+	//Keys shared with the query, most first
+	std::vector<uint32_t> &found = hits[0];
+	for(int t = 1; t < numThreads; t++) found.insert(found.end(), hits[t].begin(), hits[t].end());
+	std::vector<std::pair<int, uint32_t> > votes;
+	countVotes(found, m_numTemplates, m_numTemplates > sparseVotes*found.size(), votes);
+
+	int count = static_cast<int>(votes.size());
+	int shortlist = (matcher.getShortlist() <= 0) ? count : std::min(matcher.getShortlist(), count);
+	shortlist = std::max(shortlist, std::min(maxResults, count));
+	std::nth_element(votes.begin(), votes.begin() + shortlist, votes.end());
+	votes.resize(shortlist);
+
+	//The candidates in full
+	results.resize(shortlist);
+	parallelFor(0, shortlist, numThreads, [&](int, int begin, int end)
+	{
+		for(int k = begin; k < end; k++)
+		{
+			uint32_t id = votes[k].second;
+			const segmentView *segment = &*(std::upper_bound(m_segments.begin(), m_segments.end(), id,
+				[](uint32_t a, const segmentView &b)
+				{
+					return a < b.header->firstId;
+				}) - 1);
+			uint32_t local = id - static_cast<uint32_t>(segment->header->firstId);
+			uint32_t first = segment->cylinderStart[local];
+
+			results[k].id = static_cast<int>(id);
+			results[k].score = matcher.scoreCylinders(query.bits(), query.angle(), query.norm(), query.size(),
+					segment->bits + static_cast<size_t>(first)*cylinderTemplate::cylinderWords, segment->angle + first,
+					segment->norm + first, segment->cylinderStart[local + 1] - first);
+		}
+	});
+
+	//Best first, ties by id
+	int keep = std::min(maxResults, static_cast<int>(results.size()));
+	std::partial_sort(results.begin(), results.begin() + keep, results.end(),
+		[](const matchResult &a, const matchResult &b)
+		{
+			return (a.score != b.score) ? a.score > b.score : a.id < b.id;
+		});
+	results.resize(keep);
+}
+
+//Triangle keys
+void templateGallery::tripletKeys(const cylinderTemplate &print, bool probe, std::vector<uint32_t> &keys)
+{
+	const float maxSide = sideBin*sideBins;
+	const float vertexBin = 2*static_cast<float>(M_PI)/vertexBins;
+
+	keys.clear();
+	int count = print.size();
+	const uint16_t *px = print.x();
+	const uint16_t *py = print.y();
+	const float *pa = print.angle();
+
+	std::vector<std::pair<float, int> > near;
+	for(int i = 0; i < count; i++)
+	{
+		//Nearest neighbours close enough to make a triangle with
+		near.clear();
+		for(int j = 0; j < count; j++)
+		{
+			float dx = static_cast<float>(px[j]) - px[i];
+			float dy = static_cast<float>(py[j]) - py[i];
+			float dist2 = dx*dx + dy*dy;
+			if( j != i && dist2 < maxSide*maxSide ) near.push_back(std::make_pair(dist2, j));
+		}
+		int numNear = std::min(tripletNeighbours, static_cast<int>(near.size()));
+		std::partial_sort(near.begin(), near.begin() + numNear, near.end());
+
+		for(int a = 0; a < numNear; a++)
+		{
+			for(int b = a + 1; b < numNear; b++)
+			{
+				//Vertices in order of the side opposite them, longest first
+				int vertex[3] = {i, near[a].second, near[b].second};
+				float side[3];
+				for(int v = 0; v < 3; v++)
+				{
+					float dx = static_cast<float>(px[vertex[(v + 2) % 3]]) - px[vertex[(v + 1) % 3]];
+					float dy = static_cast<float>(py[vertex[(v + 2) % 3]]) - py[vertex[(v + 1) % 3]];
+					side[v] = std::sqrt(dx*dx + dy*dy);
+				}
+				for(int v = 0; v < 2; v++)
+				{
+					for(int w = 2; w > v; w--)
+					{
+						if( side[w] <= side[w - 1] ) continue;
+						std::swap(side[w], side[w - 1]);
+						std::swap(vertex[w], vertex[w - 1]);
+					}
+				}
+				if( side[0] >= maxSide ) continue;
+
+				//Angle of each minutia to the side to the next vertex
+				uint32_t angles = 0;
+				for(int v = 0; v < 3; v++)
+				{
+					int from = vertex[v];
+					int to = vertex[(v + 1) % 3];
+					float rel = pa[from] - std::atan2(static_cast<float>(py[to]) - py[from], static_cast<float>(px[to]) - px[from]);
+					rel -= 2*static_cast<float>(M_PI)*std::floor(rel/(2*static_cast<float>(M_PI)));
+					angles = angles*vertexBins + std::min(vertexBins - 1, static_cast<int>(rel/vertexBin));
+				}
+
+				//Bin of each side, and when probing the neighbouring bin it is closer to
+				int bins[3][2];
+				int choices[3];
+				for(int v = 0; v < 3; v++)
+				{
+					float pos = side[v]/sideBin;
+					bins[v][0] = static_cast<int>(pos);
+					bins[v][1] = (pos - bins[v][0] < 0.5f) ? bins[v][0] - 1 : bins[v][0] + 1;
+					choices[v] = (probe && bins[v][1] >= 0 && bins[v][1] < sideBins) ? 2 : 1;
+				}
+				for(int c0 = 0; c0 < choices[0]; c0++)
+				{
+					for(int c1 = 0; c1 < choices[1]; c1++)
+					{
+						for(int c2 = 0; c2 < choices[2]; c2++)
+						{
+							uint32_t sides = (bins[0][c0]*sideBins + bins[1][c1])*sideBins + bins[2][c2];
+							keys.push_back((sides << 9) | angles);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+} // End namespace fpTools
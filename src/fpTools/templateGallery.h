@@ -0,0 +1,242 @@
+/*!
+ *    \file  templateGallery.h
+ *   \brief  Gallery of cylinder templates kept in a memory-mapped file
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <stdint.h>
+
+//fpTools
+#include "fpTools/cylinderTemplate.h"
+#include "fpTools/minutiaeMatcher.h"
+#include "fpTools/galleryFormat.h"
+
+#ifndef TEMPLATEGALLERY_H
+#define TEMPLATEGALLERY_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Class to enroll templates into a gallery file and search it
+ *
+ *  See galleryFormat.h for the layout. The file is mapped and used where it sits, opening
+ *  only walks the segment headers, so a gallery of any size is ready at once and its pages
+ *  are read as searches touch them. Each enrollment appends a segment, leaving the rest of
+ *  the file as it was; enroll in batches, as every segment is looked up by every search.
+ *
+ *  Templates are indexed by geometric hashing. Each triangle of a minutia and two of its
+ *  nearest neighbours gives a key from its sides and the angles of its minutiae to them,
+ *  which do not change as the print moves or turns. A search looks up the keys of the
+ *  query, counting for each template the keys it shares, and scores in full only the
+ *  templates with the most. Several threads may search at once, but not while enrolling.
+ */
+class templateGallery
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor, nothing mapped
+		 */
+		templateGallery() : m_fd(-1), m_map(NULL), m_mapSize(0), m_fileSize(0), m_numTemplates(0), m_radius(0) {}
+
+		/*!
+		 *  \brief  Constructor, opens a gallery file
+		 *
+		 *  \param  fN const char* The file path, check isOpen() for success
+		 */
+		templateGallery (const char* fN);                           /* constructor */
+
+		/*!
+		 *  \brief  Destructor, unmaps and closes the file
+		 */
+		~templateGallery () {close();}                              /* destructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Check a file is open
+		 */
+		bool isOpen() const {return m_fd >= 0;}
+
+		/*!
+		 *  \brief  Get number of templates
+		 */
+		int size() const {return static_cast<int>(m_numTemplates);}
+
+		/*!
+		 *  \brief  Get number of segments, one per enrollment
+		 */
+		int numSegments() const {return static_cast<int>(m_segments.size());}
+
+		/*!
+		 *  \brief  Get the radius the templates were encoded with, in pixels
+		 */
+		float getRadius() const {return m_radius;}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Create an empty gallery file, replacing any file there, and open it
+		 *
+		 *  \param  fN const char* The file path
+		 *  \param  radius float Radius of the cylinders that will be enrolled
+		 *
+		 *  \return bool True on success
+		 */
+		bool create(const char* fN, float radius);
+
+		/*!
+		 *  \brief  Open a gallery file, closing any file open before
+		 *
+		 *  \param  fN const char* The file path
+		 *
+		 *  \return bool True if the file is a valid gallery
+		 */
+		bool open(const char* fN);
+
+		/*!
+		 *  \brief  Unmap and close the file
+		 */
+		void close();
+
+		/*!
+		 *  \brief  Append templates to the gallery as one segment
+		 *
+		 *  The segment is on disk when this returns. A segment left incomplete by an earlier
+		 *  crash is cut off first.
+		 *
+		 *  \param[in]  prints std::vector<cylinderTemplate> The templates, given ids from size()
+		 *  		on, in order
+		 *
+		 *  \return bool True on success
+		 */
+		bool enroll(const std::vector<cylinderTemplate> &prints);
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Find the templates most similar to a query
+		 *
+		 *  \param[in]  matcher minutiaeMatcher Scores the candidates, on its threads. Its
+		 *  		shortlist is the number of candidates taken from the index, 0 for every
+		 *  		template sharing a key with the query
+		 *  \param[in]  query cylinderTemplate The query, encoded with the radius of the gallery
+		 *  \param  maxResults int Number of results wanted
+		 *  \param[out] results std::vector<matchResult> Best first, only templates sharing a
+		 *  		key with the query
+		 */
+		void search(const minutiaeMatcher &matcher, const cylinderTemplate &query, int maxResults,
+				std::vector<matchResult> &results) const;
+
+		/*!
+		 *  \brief  Keys of the triangles of a template
+		 *
+		 *  \param[in]  print cylinderTemplate The template
+		 *  \param  probe bool Add keys with each side in the neighbouring bin it is closest
+		 *  		to, to find triangles whose sides moved across a bin
+		 *  \param[out] keys std::vector<uint32_t> Sorted keys, without repeats
+		 */
+		static void tripletKeys(const cylinderTemplate &print, bool probe, std::vector<uint32_t> &keys);
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		static const int keyBits = 24; /**< Bits in a triplet key */
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/*!
+		 *  \brief  Arrays of a segment, in the mapping
+		 */
+		struct segmentView
+		{
+			uint64_t offset; /**< Start of the segment in the file */
+			const gallerySegmentHeader *header; /**< Header */
+			const uint32_t *cylinderStart; /**< First cylinder of each template */
+			const uint32_t *signatureCount; /**< Bits set in each signature */
+			const uint64_t *signature; /**< Signatures */
+			const uint64_t *bits; /**< Cylinders */
+			const float *angle; /**< Angles of the cylinders */
+			const float *norm; /**< Norms of the cylinders */
+			const galleryKey *keys; /**< Key index */
+			const uint32_t *directory; /**< Key directory */
+		};
+
+		/*!
+		 *  \brief  Bytes in a segment, and where each array starts in it
+		 *
+		 *  \param[in]  header gallerySegmentHeader Counts of the segment
+		 *  \param[out] starts size_t* Offsets of the eight arrays from the start of the segment
+		 *
+		 *  \return size_t Bytes in the segment, a multiple of galleryAlignment
+		 */
+		static size_t segmentLayout(const gallerySegmentHeader &header, size_t *starts);
+
+		/*!
+		 *  \brief  Check that the offsets in a segment stay within its own arrays, search
+		 *  		follows them without checks
+		 *
+		 *  \param[in]  segment segmentView The mapped segment
+		 *
+		 *  \return bool True if the cylinder starts and the directory are in order and in
+		 *  		range, and every key names a template of the segment
+		 */
+		static bool segmentValid(const segmentView &segment);
+
+		/*!
+		 *  \brief  Count the keys each template found by a query shares with it
+		 *
+		 *  \param[in,out] found std::vector<uint32_t> Id of the template of each key found,
+		 *  		sorted when sparse
+		 *  \param  numTemplates uint64_t Templates in the gallery, every id is below it
+		 *  \param  sparse bool Count over the sorted ids rather than in an array over the gallery,
+		 *  		for queries that find few templates in a large gallery
+		 *  \param[out] votes std::vector<std::pair<int, uint32_t> > Each template found once, as
+		 *  		the negated count of its keys and its id
+		 */
+		static void countVotes(std::vector<uint32_t> &found, uint64_t numTemplates, bool sparse,
+				std::vector<std::pair<int, uint32_t> > &votes);
+
+		/*!
+		 *  \brief  Map the file and find its segments
+		 *
+		 *  \param  size uint64_t Bytes of the file to map
+		 *
+		 *  \return bool True on success
+		 */
+		bool mapFile(uint64_t size);
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		//Not copyable, the mapping is owned
+		templateGallery ( const templateGallery &other );
+		templateGallery& operator = ( const templateGallery &other );
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		int m_fd; /**< The file, open to append to */
+		void *m_map; /**< Start of the mapping */
+		size_t m_mapSize; /**< Length of the mapping */
+		uint64_t m_fileSize; /**< End of the last whole segment */
+		uint64_t m_numTemplates; /**< Templates in every segment */
+		float m_radius; /**< Radius of the cylinders */
+		std::vector<segmentView> m_segments; /**< Segments, in order */
+
+}; /* -----  end of class templateGallery  ----- */
+
+} // End namespace fpTools
+
+#endif //TEMPLATEGALLERY_H
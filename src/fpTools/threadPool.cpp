@@ -0,0 +1,148 @@
+/*!
+ *    \file  threadPool.cpp
+ *   \brief  Implimentation of work-stealing thread pool
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+//STL
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+//fpTools
+#include "fpTools/threadPool.h"
+#include "fpTools_utility/parallelFor.h"
+
+namespace fpTools{
+
+//Constructor
+threadPool::threadPool(int numThreads) : m_queued(0), m_pending(0), m_next(0), m_stop(false)
+{
+	numThreads = resolveThreads(numThreads);
+
+	for(int i = 0; i < numThreads; i++)
+	{
+		m_queues.push_back(std::unique_ptr<taskQueue>(new taskQueue));
+	}
+
+	for(int i = 0; i < numThreads; i++)
+	{
+		m_workers.push_back(std::thread(&threadPool::workerLoop, this, i));
+	}
+}
+
+//Destructor
+threadPool::~threadPool()
+{
+	wait();
+
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+
+	for(size_t i = 0; i < m_workers.size(); i++) m_workers[i].join();
+}
+
+//Queue task
+void threadPool::submit(const std::function<void(int)> &task)
+{
+	//Deal out to the queues in turn
+	taskQueue &queue = *m_queues[m_next++ % m_queues.size()];
+	{
+		std::lock_guard<std::mutex> guard(queue.lock);
+		queue.tasks.push_back(task);
+	}
+
+	//Counted only once it can be taken
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_queued++;
+		m_pending++;
+	}
+
+	m_wake.notify_one();
+}
+
+//Wait for all tasks
+void threadPool::wait()
+{
+	std::unique_lock<std::mutex> guard(m_lock);
+	while( m_pending > 0 ) m_done.wait(guard);
+}
+
+//Worker loop
+void threadPool::workerLoop(int id)
+{
+	std::function<void(int)> task;
+
+	while( true )
+	{
+		//Sleep until there is work, and claim a task while holding the lock so no other
+		//worker wakes for it
+		{
+			std::unique_lock<std::mutex> guard(m_lock);
+			while( !m_stop && m_queued == 0 ) m_wake.wait(guard);
+			if( m_stop && m_queued == 0 ) return;
+			m_queued--;
+		}
+
+		//A claimed task is in some queue, but a scan can pass a queue just before a task
+		//lands in it while another worker empties the rest
+		while( !takeTask(id, task) ) std::this_thread::yield();
+
+		task(id);
+		task = nullptr;
+
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_pending--;
+			if( m_pending == 0 ) m_done.notify_all();
+		}
+	}
+}
+
+//Take own task or steal one
+bool threadPool::takeTask(int id, std::function<void(int)> &task)
+{
+	int numQueues = static_cast<int>(m_queues.size());
+
+	//Own queue from the front
+	{
+		taskQueue &queue = *m_queues[id];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if( !queue.tasks.empty() )
+		{
+			task.swap(queue.tasks.front());
+			queue.tasks.pop_front();
+			return true;
+		}
+	}
+
+	//Other queues from the back
+	for(int i = 1; i < numQueues; i++)
+	{
+		taskQueue &queue = *m_queues[(id + i) % numQueues];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if( !queue.tasks.empty() )
+		{
+			task.swap(queue.tasks.back());
+			queue.tasks.pop_back();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+} // End namespace fpTools
@@ -0,0 +1,126 @@
+/*!
+ *    \file  threadPool.h
+ *   \brief  Work-stealing pool of worker threads
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+namespace fpTools{
+/*!
+ *  \brief  Pool of worker threads, each with its own task queue
+ *
+ *  Tasks are dealt out to the queues in turn. A worker takes tasks from the front of its
+ *  own queue and, once that is empty, steals from the back of the others. Tasks are passed
+ *  the index of the worker running them so they can use per-worker scratch.
+ */
+class threadPool
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Constructor
+		 *
+		 *  \param  numThreads int Number of workers, 0 for all cores
+		 */
+		threadPool (int numThreads);                             /* constructor */
+
+		/*!
+		 *  \brief  Destructor, waits for queued tasks then stops the workers
+		 */
+		~threadPool ();                                          /* destructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get number of workers
+		 */
+		int size(){return static_cast<int>(m_workers.size());}
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Queue a task
+		 *
+		 *  \param  task std::function<void(int)> Task, called with the index of the worker running it
+		 */
+		void submit(const std::function<void(int)> &task);
+
+		/*!
+		 *  \brief  Block until every queued task has finished
+		 */
+		void wait();
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/*!
+		 *  \brief  Loop run by each worker
+		 *
+		 *  \param  id int Index of the worker
+		 */
+		void workerLoop(int id);
+
+		/*!
+		 *  \brief  Take a task from the worker's own queue, or steal one
+		 *
+		 *  \param  id int Index of the worker
+		 *  \param[out] task std::function<void(int)> The task
+		 *
+		 *  \return bool False if every queue was empty
+		 */
+		bool takeTask(int id, std::function<void(int)> &task);
+
+		threadPool ( const threadPool &other );   /* not copyable */
+		threadPool& operator = ( const threadPool &other );
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+		/*!
+		 *  \brief  Task queue of one worker
+		 */
+		struct taskQueue
+		{
+			std::mutex lock; /**< Guards tasks */
+			std::deque< std::function<void(int)> > tasks; /**< Queued tasks */
+		};
+
+		std::vector< std::unique_ptr<taskQueue> > m_queues; /**< One queue per worker */
+		std::vector<std::thread> m_workers; /**< Worker threads */
+
+		std::mutex m_lock; /**< Guards the counters below */
+		std::condition_variable m_wake; /**< Signals queued tasks or stop */
+		std::condition_variable m_done; /**< Signals all tasks done */
+		int m_queued; /**< Tasks queued but not claimed by a worker */
+		int m_pending; /**< Tasks queued or running */
+		unsigned int m_next; /**< Queue for the next task */
+		bool m_stop; /**< Set to stop the workers */
+
+}; /* -----  end of class threadPool  ----- */
+
+} // End namespace fpTools
+
+#endif //THREADPOOL_H
@@ -0,0 +1,181 @@
+/*!
+ *    \file  bitImage.cpp
+ *   \brief  Implimentation of packed binary image conversions and morphology
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/bitImage.h"
+
+namespace fpTools{
+
+/*!
+ *  \brief  Pack the pixels of an image below a threshold
+ *
+ *  \param[in]  image Eigen::Matrix The row-major image
+ *  \param  thresh int The threshold
+ *  \param[out] bits bitImage The packed image, resized to fit
+ */
+template<typename Scalar>
+static void packBelow(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> &image, int thresh,
+		bitImage &bits)
+{
+	int rows = image.rows();
+	int cols = image.cols();
+
+	bits.resize(rows, cols);
+	for(int r = 0; r < rows; r++)
+	{
+		const Scalar *in = image.data() + static_cast<size_t>(r)*cols;
+		uint64_t *words = bits.row(r);
+
+		//A word at a time, so each is stored once
+		for(int c0 = 0; c0 < cols; c0 += 64)
+		{
+			int n = std::min(64, cols - c0);
+			uint64_t word = 0;
+			for(int c = 0; c < n; c++) word |= static_cast<uint64_t>(in[c0 + c] < thresh) << c;
+			words[c0 >> 6] = word;
+		}
+	}
+}
+
+/*!
+ *  \brief  Unpack to an image
+ *
+ *  \param[in]  bits bitImage The packed image
+ *  \param[out] image Eigen::Matrix The row-major image, resized to fit
+ *  \param  set Scalar Value of set pixels
+ *  \param  clear Scalar Value of clear pixels
+ */
+template<typename Scalar>
+static void unpack(const bitImage &bits, Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> &image,
+		Scalar set, Scalar clear)
+{
+	int rows = bits.rows();
+	int cols = bits.cols();
+
+	image.resize(rows, cols);
+	for(int r = 0; r < rows; r++)
+	{
+		Scalar *out = image.data() + static_cast<size_t>(r)*cols;
+		const uint64_t *words = bits.row(r);
+		for(int c = 0; c < cols; c++)
+		{
+			out[c] = ((words[c >> 6] >> (c & 63)) & 1) ? set : clear;
+		}
+	}
+}
+
+//Pack 8-bit image
+void bitImage::fromImage(const image8u &image, int thresh)
+{
+	packBelow(image, thresh, *this);
+}
+
+//Pack 16-bit image
+void bitImage::fromImage(const image16u &image, int thresh)
+{
+	packBelow(image, thresh, *this);
+}
+
+//Unpack to 8-bit image
+void bitImage::toImage(image8u &image, uint8_t set, uint8_t clear) const
+{
+	unpack(*this, image, set, clear);
+}
+
+//Unpack to 16-bit image
+void bitImage::toImage(image16u &image, uint16_t set, uint16_t clear) const
+{
+	unpack(*this, image, set, clear);
+}
+
+//Dilate
+void bitImage::dilate(int radius)
+{
+	for(int k = 0; k < radius; k++) morphology(true);
+}
+
+//Erode
+void bitImage::erode(int radius)
+{
+	for(int k = 0; k < radius; k++) morphology(false);
+}
+
+//One 3 x 3 pass
+void bitImage::morphology(bool grow)
+{
+	int words = m_wordsPerRow;
+	if( m_rows == 0 || words == 0 ) return;
+
+	//Pixels outside the image, clear when dilating and set when eroding, so neither
+	//grows or shrinks the print from its edges
+	uint64_t outside = grow ? 0 : ~static_cast<uint64_t>(0);
+	uint64_t lastMask = (m_cols & 63) ? (static_cast<uint64_t>(1) << (m_cols & 63)) - 1 : ~static_cast<uint64_t>(0);
+
+	//Each row is overwritten once the rows below it are read, so only the rows above,
+	//at and below it are kept across
+	m_across.resize(3*static_cast<size_t>(words));
+	uint64_t *up = &m_across[0];
+	uint64_t *mid = up + words;
+	uint64_t *down = mid + words;
+	acrossRow(row(0), grow, lastMask, mid);
+
+	//Down the columns, the rows above and below
+	for(int r = 0; r < m_rows; r++)
+	{
+		if( r + 1 < m_rows ) acrossRow(row(r + 1), grow, lastMask, down);
+
+		uint64_t *out = row(r);
+		for(int w = 0; w < words; w++)
+		{
+			uint64_t above = (r > 0) ? up[w] : outside;
+			uint64_t below = (r + 1 < m_rows) ? down[w] : outside;
+			out[w] = grow ? (mid[w] | above | below) : (mid[w] & above & below);
+		}
+		out[words - 1] &= lastMask;
+
+		//Roll the rows
+		uint64_t *oldUp = up;
+		up = mid;
+		mid = down;
+		down = oldUp;
+	}
+}
+
+//Pixels and their east and west neighbours
+void bitImage::acrossRow(const uint64_t *in, bool grow, uint64_t lastMask, uint64_t *out) const
+{
+	int words = m_wordsPerRow;
+	uint64_t outside = grow ? 0 : ~static_cast<uint64_t>(0);
+
+	uint64_t prev = outside;
+	uint64_t x = in[0] | ((words == 1) ? (outside & ~lastMask) : 0);
+	for(int w = 0; w < words; w++)
+	{
+		uint64_t next = (w + 1 < words) ? in[w + 1] | ((w + 2 == words) ? (outside & ~lastMask) : 0) : outside;
+		uint64_t east = (x >> 1) | (next << 63);
+		uint64_t west = (x << 1) | (prev >> 63);
+		out[w] = grow ? (x | east | west) : (x & east & west);
+		prev = x;
+		x = next;
+	}
+}
+
+} // End namespace fpTools
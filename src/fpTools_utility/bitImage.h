@@ -0,0 +1,239 @@
+/*!
+ *    \file  bitImage.h
+ *   \brief  Binary image packed one bit per pixel
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+#include <stdint.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+
+#ifndef BITIMAGE_H
+#define BITIMAGE_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Binary image packed in 64-bit words, a row at a time
+ *
+ *  Column c of a row is bit c % 64 of word c / 64, so the pixel to the east of a bit is
+ *  the next bit up. Rows are padded to a stride of whole 16-byte vectors, so every row
+ *  starts aligned, and the bits past the last column are kept clear, so whole words can
+ *  be combined with bitwise operations. An 8-bit binary image takes eight times the
+ *  space, an Eigen::MatrixXi thirty-two.
+ */
+class bitImage
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor, empty image
+		 */
+		bitImage() : m_rows(0), m_cols(0), m_wordsPerRow(0), m_stride(0) {}
+
+		/*!
+		 *  \brief  Constructor, every pixel clear
+		 *
+		 *  \param  rows int Number of rows
+		 *  \param  cols int Number of cols
+		 */
+		bitImage (int rows, int cols){resize(rows, cols);}       /* constructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get number of rows
+		 */
+		int rows() const {return m_rows;}
+
+		/*!
+		 *  \brief  Get number of cols
+		 */
+		int cols() const {return m_cols;}
+
+		/*!
+		 *  \brief  Get number of words in a row
+		 */
+		int wordsPerRow() const {return m_wordsPerRow;}
+
+		/*!
+		 *  \brief  Get number of words from the start of one row to the next
+		 */
+		int stride() const {return m_stride;}
+
+		/*!
+		 *  \brief  Get the words of a row
+		 *
+		 *  \param  r int The row
+		 */
+		const uint64_t* row(int r) const {return &m_words[static_cast<size_t>(r)*m_stride];}
+
+		/*!
+		 *  \brief  Get a pixel
+		 *
+		 *  \param  r int The row
+		 *  \param  c int The col
+		 *
+		 *  \return bool True if set
+		 */
+		bool get(int r, int c) const {return (row(r)[c >> 6] >> (c & 63)) & 1;}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Resize, clearing every pixel
+		 *
+		 *  \param  rows int Number of rows
+		 *  \param  cols int Number of cols
+		 */
+		void resize(int rows, int cols)
+		{
+			m_rows = rows;
+			m_cols = cols;
+			m_wordsPerRow = (cols + 63)/64;
+			m_stride = (m_wordsPerRow + 1) & ~1;
+			m_words.assign(static_cast<size_t>(rows)*m_stride, 0);
+		}
+
+		/*!
+		 *  \brief  Get the words of a row to change, the bits past the last column must stay clear
+		 *
+		 *  \param  r int The row
+		 */
+		uint64_t* row(int r){return &m_words[static_cast<size_t>(r)*m_stride];}
+
+		/*!
+		 *  \brief  Set or clear a pixel
+		 *
+		 *  \param  r int The row
+		 *  \param  c int The col
+		 *  \param  value bool True to set
+		 */
+		void set(int r, int c, bool value)
+		{
+			uint64_t bit = static_cast<uint64_t>(1) << (c & 63);
+			if( value )
+			{
+				row(r)[c >> 6] |= bit;
+			}else
+			{
+				row(r)[c >> 6] &= ~bit;
+			}
+		}
+
+		/*!
+		 *  \brief  Set the pixels of an 8-bit image darker than a threshold, resizing to fit
+		 *
+		 *  \param[in]  image image8u The image
+		 *  \param  thresh int Pixels below it are set, 128 suits a binarized image with dark ridges
+		 */
+		void fromImage(const image8u &image, int thresh = 128);
+
+		/*!
+		 *  \brief  Set the pixels of a 16-bit image darker than a threshold, resizing to fit
+		 *
+		 *  \param[in]  image image16u The image
+		 *  \param  thresh int Pixels below it are set
+		 */
+		void fromImage(const image16u &image, int thresh);
+
+		/*!
+		 *  \brief  Grow the set pixels by a square
+		 *
+		 *  \param  radius int Half the side of the square less one, 1 for 3 x 3
+		 */
+		void dilate(int radius = 1);
+
+		/*!
+		 *  \brief  Shrink the set pixels by a square, pixels outside the image count as set
+		 *
+		 *  \param  radius int Half the side of the square less one, 1 for 3 x 3
+		 */
+		void erode(int radius = 1);
+
+		/*!
+		 *  \brief  Erode then dilate, removing set specks and spurs narrower than the square
+		 *
+		 *  \param  radius int Half the side of the square less one, 1 for 3 x 3
+		 */
+		void open(int radius = 1){erode(radius); dilate(radius);}
+
+		/*!
+		 *  \brief  Dilate then erode, filling clear holes and gaps narrower than the square
+		 *
+		 *  \param  radius int Half the side of the square less one, 1 for 3 x 3
+		 */
+		void close(int radius = 1){dilate(radius); erode(radius);}
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Unpack to an 8-bit image
+		 *
+		 *  \param[out] image image8u The image, resized to fit
+		 *  \param  set uint8_t Value of set pixels, 0 for dark ridges
+		 *  \param  clear uint8_t Value of clear pixels
+		 */
+		void toImage(image8u &image, uint8_t set = 0, uint8_t clear = 255) const;
+
+		/*!
+		 *  \brief  Unpack to a 16-bit image
+		 *
+		 *  \param[out] image image16u The image, resized to fit
+		 *  \param  set uint16_t Value of set pixels
+		 *  \param  clear uint16_t Value of clear pixels
+		 */
+		void toImage(image16u &image, uint16_t set, uint16_t clear) const;
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/*!
+		 *  \brief  Dilate or erode by a 3 x 3 square once
+		 *
+		 *  \param  grow bool True to dilate
+		 */
+		void morphology(bool grow);
+
+		/*!
+		 *  \brief  One row dilated or eroded by a 1 x 3 row
+		 *
+		 *  \param[in]  in const uint64_t* The row
+		 *  \param  grow bool True to dilate
+		 *  \param  lastMask uint64_t Pixels of the last word inside the image
+		 *  \param[out] out uint64_t* The result, wordsPerRow() words
+		 */
+		void acrossRow(const uint64_t *in, bool grow, uint64_t lastMask, uint64_t *out) const;
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		int m_rows; /**< Number of rows */
+		int m_cols; /**< Number of cols */
+		int m_wordsPerRow; /**< Words in a row */
+		int m_stride; /**< Words from one row to the next, a whole number of 16-byte vectors */
+		std::vector<uint64_t, Eigen::aligned_allocator<uint64_t> > m_words; /**< The rows, one after the other */
+		std::vector<uint64_t> m_across; /**< Rows above, at and below the row being dilated or eroded */
+
+}; /* -----  end of class bitImage  ----- */
+
+} // End namespace fpTools
+
+#endif //BITIMAGE_H
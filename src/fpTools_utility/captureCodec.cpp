@@ -0,0 +1,154 @@
+/*!
+ *    \file  captureCodec.cpp
+ *   \brief  Implimentation of the scanline chunk codec
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstring>
+#include <vector>
+
+//fpTools
+#include "fpTools_utility/captureCodec.h"
+
+namespace fpTools{
+
+//Longest literal and run
+static const size_t maxLiteral = 128;
+static const size_t minRun = 3;
+static const size_t maxRun = 130;
+
+//Run-length code a byte plane
+static void packBits(const uint8_t *in, size_t n, std::vector<uint8_t> &out)
+{
+	size_t i = 0;
+	while( i < n )
+	{
+		//Length of the run starting here
+		size_t run = 1;
+		while( i + run < n && run < maxRun && in[i + run] == in[i] ) run++;
+
+		if( run >= minRun )
+		{
+			out.push_back(static_cast<uint8_t>(run + 125));
+			out.push_back(in[i]);
+			i += run;
+			continue;
+		}
+
+		//Literals up to the next run worth coding
+		size_t start = i;
+		while( i < n && i - start < maxLiteral )
+		{
+			if( i + 2 < n && in[i] == in[i+1] && in[i] == in[i+2] ) break;
+			i++;
+		}
+		out.push_back(static_cast<uint8_t>(i - start - 1));
+		out.insert(out.end(), in + start, in + i);
+	}
+}
+
+//Decode a run-length coded byte plane
+static bool unpackBits(const uint8_t *in, size_t size, size_t &pos, uint8_t *out, size_t n)
+{
+	size_t k = 0;
+	while( k < n )
+	{
+		if( pos >= size ) return false;
+		uint8_t c = in[pos++];
+
+		if( c < 128 )
+		{
+			size_t len = c + 1;
+			if( pos + len > size || k + len > n ) return false;
+			std::memcpy(out + k, in + pos, len);
+			pos += len;
+			k += len;
+		}else
+		{
+			size_t len = c - 125;
+			if( pos >= size || k + len > n ) return false;
+			std::memset(out + k, in[pos++], len);
+			k += len;
+		}
+	}
+
+	return true;
+}
+
+//Encode 8-bit
+void encodeChunk(const uint8_t *pixels, size_t count, std::vector<uint8_t> &out)
+{
+	std::vector<uint8_t> delta(count);
+	uint8_t prev = 0;
+	for(size_t k = 0; k < count; k++)
+	{
+		delta[k] = static_cast<uint8_t>(pixels[k] - prev);
+		prev = pixels[k];
+	}
+
+	packBits(delta.data(), count, out);
+}
+
+//Encode 16-bit
+void encodeChunk(const uint16_t *pixels, size_t count, std::vector<uint8_t> &out)
+{
+	//High bytes then low bytes
+	std::vector<uint8_t> planes(2*count);
+	uint16_t prev = 0;
+	for(size_t k = 0; k < count; k++)
+	{
+		uint16_t d = static_cast<uint16_t>(pixels[k] - prev);
+		planes[k] = static_cast<uint8_t>(d >> 8);
+		planes[count + k] = static_cast<uint8_t>(d & 0xFF);
+		prev = pixels[k];
+	}
+
+	packBits(planes.data(), count, out);
+	packBits(planes.data() + count, count, out);
+}
+
+//Decode 8-bit
+bool decodeChunk(const uint8_t *data, size_t size, uint8_t *pixels, size_t count)
+{
+	size_t pos = 0;
+	if( !unpackBits(data, size, pos, pixels, count) || pos != size ) return false;
+
+	//Undo the differences
+	uint8_t prev = 0;
+	for(size_t k = 0; k < count; k++)
+	{
+		prev = static_cast<uint8_t>(prev + pixels[k]);
+		pixels[k] = prev;
+	}
+
+	return true;
+}
+
+//Decode 16-bit
+bool decodeChunk(const uint8_t *data, size_t size, uint16_t *pixels, size_t count)
+{
+	std::vector<uint8_t> planes(2*count);
+	size_t pos = 0;
+	if( !unpackBits(data, size, pos, planes.data(), count) ||
+			!unpackBits(data, size, pos, planes.data() + count, count) || pos != size ) return false;
+
+	//Join the planes and undo the differences
+	uint16_t prev = 0;
+	for(size_t k = 0; k < count; k++)
+	{
+		prev = static_cast<uint16_t>(prev + ((planes[k] << 8) | planes[count + k]));
+		pixels[k] = prev;
+	}
+
+	return true;
+}
+
+} // End namespace fpTools
@@ -0,0 +1,74 @@
+/*!
+ *    \file  captureCodec.h
+ *   \brief  Lightweight lossless codec for scanline chunks
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ *  Each pixel is replaced by its difference to the previous pixel, which is 0 over the
+ *  flat background of a scan, and the differences are run-length coded. 16-bit
+ *  differences are split into a high and a low byte plane, so the mostly empty high
+ *  bytes form long runs. The run-length coding is PackBits style: a control byte c
+ *  below 128 is followed by c + 1 literal bytes, otherwise the next byte repeats
+ *  c - 125 times.
+ */
+
+//STL
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+#ifndef CAPTURECODEC_H
+#define CAPTURECODEC_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Encode 8-bit pixels
+ *
+ *  \param[in]  pixels const uint8_t* The pixels
+ *  \param  count size_t Number of pixels
+ *  \param[out] out std::vector<uint8_t> Encoded bytes, appended
+ */
+void encodeChunk(const uint8_t *pixels, size_t count, std::vector<uint8_t> &out);
+
+/*!
+ *  \brief  Encode 16-bit pixels
+ *
+ *  \param[in]  pixels const uint16_t* The pixels
+ *  \param  count size_t Number of pixels
+ *  \param[out] out std::vector<uint8_t> Encoded bytes, appended
+ */
+void encodeChunk(const uint16_t *pixels, size_t count, std::vector<uint8_t> &out);
+
+/*!
+ *  \brief  Decode 8-bit pixels
+ *
+ *  \param[in]  data const uint8_t* Encoded bytes
+ *  \param  size size_t Number of encoded bytes
+ *  \param[out] pixels uint8_t* The pixels
+ *  \param  count size_t Number of pixels
+ *
+ *  \return bool False if the data is corrupt or does not decode to count pixels
+ */
+bool decodeChunk(const uint8_t *data, size_t size, uint8_t *pixels, size_t count);
+
+/*!
+ *  \brief  Decode 16-bit pixels
+ *
+ *  \param[in]  data const uint8_t* Encoded bytes
+ *  \param  size size_t Number of encoded bytes
+ *  \param[out] pixels uint16_t* The pixels
+ *  \param  count size_t Number of pixels
+ *
+ *  \return bool False if the data is corrupt or does not decode to count pixels
+ */
+bool decodeChunk(const uint8_t *data, size_t size, uint16_t *pixels, size_t count);
+
+} // End namespace fpTools
+
+#endif //CAPTURECODEC_H
@@ -0,0 +1,98 @@
+/*!
+ *    \file  captureFormat.h
+ *   \brief  On-disk layout of capture container files
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ *  A container file holds any number of captures, each a swipe of scanlines stacked as
+ *  demoReg expects them. The layout, all fields little-endian:
+ *
+ *  - captureFileHeader
+ *  - The chunks, one per scanline, in the order they were written
+ *  - The index, 8-byte aligned, one captureEntry per capture then one chunkEntry per scanline
+ *  - captureFileTrailer, at the very end of the file
+ *
+ *  A reader finds the index from the trailer, then any capture or scanline by position
+ *  in the index, without reading anything else.
+ *
+ *  Fields are written and read as they sit in memory, so only little-endian hosts can
+ *  build the container.
+ */
+
+//STL
+#include <stdint.h>
+
+#ifndef CAPTUREFORMAT_H
+#define CAPTUREFORMAT_H
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Capture containers are little-endian and are read and written without byte swapping"
+#endif
+
+namespace fpTools{
+
+/*!
+ *  \brief  Magic number at the start and end of a container file
+ */
+static const char captureMagic[8] = {'F', 'P', 'C', 'A', 'P', 'T', '0', '1'};
+
+/*!
+ *  \brief  How a chunk is stored
+ */
+enum captureCodec
+{
+	CODEC_RAW = 0, /**< Pixels as they are */
+	CODEC_DELTA_RLE = 1 /**< Difference to the previous pixel, run-length coded */
+};
+
+/*!
+ *  \brief  Start of a container file
+ */
+struct captureFileHeader
+{
+	char magic[8]; /**< captureMagic */
+	uint32_t version; /**< Format version, 1 */
+	uint32_t reserved; /**< 0 */
+};
+
+/*!
+ *  \brief  Index entry for one capture
+ */
+struct captureEntry
+{
+	uint32_t lengthOfScan; /**< Rows per scanline */
+	uint32_t cols; /**< Cols of every scanline */
+	uint32_t scanLines; /**< Number of scanlines */
+	uint32_t bitDepth; /**< 8 or 16 */
+	uint64_t firstChunk; /**< Index of the first scanline's chunkEntry */
+};
+
+/*!
+ *  \brief  Index entry for one scanline
+ */
+struct chunkEntry
+{
+	uint64_t offset; /**< Offset of the chunk in the file */
+	uint32_t size; /**< Stored size in bytes */
+	uint32_t codec; /**< captureCodec */
+};
+
+/*!
+ *  \brief  End of a container file
+ */
+struct captureFileTrailer
+{
+	uint64_t indexOffset; /**< Offset of the first captureEntry */
+	uint64_t numCaptures; /**< Number of captureEntry */
+	uint64_t numChunks; /**< Number of chunkEntry, after the captureEntry */
+	char magic[8]; /**< captureMagic */
+};
+
+} // End namespace fpTools
+
+#endif //CAPTUREFORMAT_H
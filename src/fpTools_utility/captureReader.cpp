@@ -0,0 +1,252 @@
+/*!
+ *    \file  captureReader.cpp
+ *   \brief  Implimentation of capture container reader
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+//POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/captureReader.h"
+#include "fpTools_utility/captureCodec.h"
+#include "fpTools_utility/parallelFor.h"
+
+namespace fpTools{
+
+//Constructor
+captureReader::captureReader(const char* fN) :
+	m_map(NULL), m_mapSize(0), m_captures(NULL), m_chunks(NULL), m_numCaptures(0), m_numChunks(0)
+{
+	open(fN);
+}
+
+//Map file
+bool captureReader::open(const char* fN)
+{
+	close();
+
+	int fd = ::open(fN, O_RDONLY);
+	if( fd < 0 )
+	{
+		std::fprintf(stderr, "Unable to open file %s\n", fN);
+		return false;
+	}
+
+	//The mapping holds its own reference to the file
+	struct stat info;
+	if( fstat(fd, &info) == 0 && info.st_size > 0 )
+	{
+		m_mapSize = static_cast<size_t>(info.st_size);
+		m_map = mmap(NULL, m_mapSize, PROT_READ, MAP_SHARED, fd, 0);
+		if( m_map == MAP_FAILED ) m_map = NULL;
+	}
+	::close(fd);
+
+	//Header and trailer
+	const uint8_t *bytes = static_cast<const uint8_t*>(m_map);
+	captureFileTrailer trailer;
+	if( m_map == NULL || m_mapSize < sizeof(captureFileHeader) + sizeof(trailer) ||
+			std::memcmp(bytes, captureMagic, sizeof(captureMagic)) != 0 )
+	{
+		std::fprintf(stderr, "Unknown file type %s\n", fN);
+		close();
+		return false;
+	}
+	std::memcpy(&trailer, bytes + m_mapSize - sizeof(trailer), sizeof(trailer));
+
+	//The index must fill the space before the trailer exactly, each count is bounded by the
+	//space left first so the sum cannot wrap
+	uint64_t indexEnd = m_mapSize - sizeof(trailer);
+	if( std::memcmp(trailer.magic, captureMagic, sizeof(captureMagic)) != 0 ||
+			trailer.indexOffset < sizeof(captureFileHeader) || trailer.indexOffset > indexEnd || trailer.indexOffset % 8 != 0 ||
+			trailer.numCaptures > (indexEnd - trailer.indexOffset)/sizeof(captureEntry) ||
+			trailer.numChunks > (indexEnd - trailer.indexOffset - trailer.numCaptures*sizeof(captureEntry))/sizeof(chunkEntry) ||
+			trailer.indexOffset + trailer.numCaptures*sizeof(captureEntry) + trailer.numChunks*sizeof(chunkEntry) != indexEnd )
+	{
+		std::fprintf(stderr, "Corrupt capture index %s\n", fN);
+		close();
+		return false;
+	}
+
+	m_numCaptures = trailer.numCaptures;
+	m_numChunks = trailer.numChunks;
+	m_captures = reinterpret_cast<const captureEntry*>(bytes + trailer.indexOffset);
+	m_chunks = reinterpret_cast<const chunkEntry*>(bytes + trailer.indexOffset + m_numCaptures*sizeof(captureEntry));
+
+	//Every capture's scanlines must be in the index
+	for(uint64_t c = 0; c < m_numCaptures; c++)
+	{
+		if( m_captures[c].firstChunk > m_numChunks || m_captures[c].scanLines > m_numChunks - m_captures[c].firstChunk )
+		{
+			std::fprintf(stderr, "Corrupt capture index %s\n", fN);
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//Unmap file
+void captureReader::close()
+{
+	if( m_map != NULL ) munmap(m_map, m_mapSize);
+
+	m_map = NULL;
+	m_mapSize = 0;
+	m_captures = NULL;
+	m_chunks = NULL;
+	m_numCaptures = 0;
+	m_numChunks = 0;
+}
+
+//Check capture
+template<typename Scalar>
+bool captureReader::checkCapture(int capture) const
+{
+	if( !isOpen() || capture < 0 || static_cast<uint64_t>(capture) >= m_numCaptures )
+	{
+		std::fprintf(stderr, "No capture %d\n", capture);
+		return false;
+	}
+	if( m_captures[capture].bitDepth > 8*sizeof(Scalar) )
+	{
+		std::fprintf(stderr, "16-bit capture, read into image16u\n");
+		return false;
+	}
+
+	return true;
+}
+
+//Decode scanline
+template<typename Scalar>
+bool captureReader::decode(int capture, int line, Scalar *out) const
+{
+	const captureEntry &entry = m_captures[capture];
+	const chunkEntry &chunk = m_chunks[entry.firstChunk + line];
+	size_t count = static_cast<size_t>(entry.lengthOfScan)*entry.cols;
+
+	if( chunk.offset > m_mapSize || chunk.size > m_mapSize - chunk.offset )
+	{
+		std::fprintf(stderr, "Corrupt capture chunk\n");
+		return false;
+	}
+	const uint8_t *data = static_cast<const uint8_t*>(m_map) + chunk.offset;
+
+	bool ok = false;
+	if( entry.bitDepth == 16 )
+	{
+		//Only reached for 16-bit output
+		uint16_t *out16 = reinterpret_cast<uint16_t*>(out);
+		if( chunk.codec == CODEC_RAW )
+		{
+			ok = chunk.size == 2*count;
+			if( ok ) std::memcpy(out16, data, chunk.size);
+		}else if( chunk.codec == CODEC_DELTA_RLE )
+		{
+			ok = decodeChunk(data, chunk.size, out16, count);
+		}
+	}else
+	{
+		//Decode the bytes at the front of the output
+		uint8_t *out8 = reinterpret_cast<uint8_t*>(out);
+		if( chunk.codec == CODEC_RAW )
+		{
+			ok = chunk.size == count;
+			if( ok ) std::memcpy(out8, data, chunk.size);
+		}else if( chunk.codec == CODEC_DELTA_RLE )
+		{
+			ok = decodeChunk(data, chunk.size, out8, count);
+		}
+
+		//Widen in place from the back
+		if( ok && sizeof(Scalar) > 1 )
+		{
+			for(size_t k = count; k > 0; k--) out[k-1] = out8[k-1];
+		}
+	}
+
+	if( !ok ) std::fprintf(stderr, "Corrupt capture chunk\n");
+	return ok;
+}
+
+//Decode capture
+template<typename Scalar>
+bool captureReader::decodeCapture(int capture, Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> &image,
+		int numThreads) const
+{
+	if( !checkCapture<Scalar>(capture) ) return false;
+
+	const captureEntry &entry = m_captures[capture];
+	image.resize(static_cast<Eigen::Index>(entry.scanLines)*entry.lengthOfScan, entry.cols);
+	size_t scanSize = static_cast<size_t>(entry.lengthOfScan)*entry.cols;
+
+	//Scanlines decode independently into their own rows
+	std::vector<char> ok(entry.scanLines, 0);
+	parallelFor(0, entry.scanLines, resolveThreads(numThreads), [&](int, int begin, int end)
+	{
+		for(int i = begin; i < end; i++)
+		{
+			ok[i] = decode(capture, i, image.data() + i*scanSize);
+		}
+	});
+
+	for(size_t i = 0; i < ok.size(); i++)
+	{
+		if( !ok[i] ) return false;
+	}
+	return true;
+}
+
+//Read 8-bit scanline
+bool captureReader::readScanline(int capture, int line, image8u &scan) const
+{
+	if( !checkCapture<uint8_t>(capture) ) return false;
+	if( line < 0 || static_cast<uint32_t>(line) >= m_captures[capture].scanLines ) return false;
+
+	scan.resize(m_captures[capture].lengthOfScan, m_captures[capture].cols);
+	return decode(capture, line, scan.data());
+}
+
+//Read 16-bit scanline
+bool captureReader::readScanline(int capture, int line, image16u &scan) const
+{
+	if( !checkCapture<uint16_t>(capture) ) return false;
+	if( line < 0 || static_cast<uint32_t>(line) >= m_captures[capture].scanLines ) return false;
+
+	scan.resize(m_captures[capture].lengthOfScan, m_captures[capture].cols);
+	return decode(capture, line, scan.data());
+}
+
+//Read 8-bit capture
+bool captureReader::readCapture(int capture, image8u &image, int numThreads) const
+{
+	return decodeCapture(capture, image, numThreads);
+}
+
+//Read 16-bit capture
+bool captureReader::readCapture(int capture, image16u &image, int numThreads) const
+{
+	return decodeCapture(capture, image, numThreads);
+}
+
+} // End namespace fpTools
@@ -0,0 +1,200 @@
+/*!
+ *    \file  captureReader.h
+ *   \brief  Reads capture container files
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstddef>
+#include <stdint.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+#include "fpTools_utility/captureFormat.h"
+
+#ifndef CAPTUREREADER_H
+#define CAPTUREREADER_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Class to read captures from a container file by mapping it into memory
+ *
+ *  See captureFormat.h for the layout. The index is used where it sits in the mapping,
+ *  so any capture or scanline is found in constant time. Scanlines decode independently,
+ *  a capture can be decoded on many threads. Reads do not change the reader, several
+ *  threads may read from one reader at once.
+ */
+class captureReader
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor, nothing mapped
+		 */
+		captureReader() : m_map(NULL), m_mapSize(0), m_captures(NULL), m_chunks(NULL), m_numCaptures(0), m_numChunks(0) {}
+
+		/*!
+		 *  \brief  Constructor, maps a file
+		 *
+		 *  \param  fN const char* The file path, check isOpen() for success
+		 */
+		captureReader (const char* fN);                             /* constructor */
+
+		/*!
+		 *  \brief  Destructor, unmaps the file
+		 */
+		~captureReader () {close();}                                /* destructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Check a file is mapped
+		 */
+		bool isOpen() const {return m_map != NULL;}
+
+		/*!
+		 *  \brief  Get number of captures
+		 */
+		int numCaptures() const {return static_cast<int>(m_numCaptures);}
+
+		/*!
+		 *  \brief  Get the index entry of a capture
+		 *
+		 *  \param  capture int The capture, 0 to numCaptures() - 1
+		 */
+		const captureEntry& getCapture(int capture) const {return m_captures[capture];}
+
+		/*!
+		 *  \brief  Get the index entry of a scanline
+		 *
+		 *  \param  capture int The capture
+		 *  \param  line int The scanline in the capture
+		 */
+		const chunkEntry& getChunk(int capture, int line) const {return m_chunks[m_captures[capture].firstChunk + line];}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Map a file and check its index, unmapping any file mapped before
+		 *
+		 *  \param  fN const char* The file path
+		 *
+		 *  \return bool True if the file is a valid container
+		 */
+		bool open(const char* fN);
+
+		/*!
+		 *  \brief  Unmap the file
+		 */
+		void close();
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Decode one scanline of an 8-bit capture
+		 *
+		 *  \param  capture int The capture
+		 *  \param  line int The scanline in the capture
+		 *  \param[out] scan image8u The scanline, resized to lengthOfScan x cols
+		 *
+		 *  \return bool True on success, false for 16-bit captures
+		 */
+		bool readScanline(int capture, int line, image8u &scan) const;
+
+		/*!
+		 *  \brief  Decode one scanline of an 8 or 16-bit capture
+		 *
+		 *  \param  capture int The capture
+		 *  \param  line int The scanline in the capture
+		 *  \param[out] scan image16u The scanline, resized to lengthOfScan x cols
+		 *
+		 *  \return bool True on success
+		 */
+		bool readScanline(int capture, int line, image16u &scan) const;
+
+		/*!
+		 *  \brief  Decode a whole 8-bit capture into stacked scanlines
+		 *
+		 *  \param  capture int The capture
+		 *  \param[out] image image8u The stacked scanlines, resized to fit
+		 *  \param  numThreads int Threads to decode on, 0 for all cores
+		 *
+		 *  \return bool True on success, false for 16-bit captures
+		 */
+		bool readCapture(int capture, image8u &image, int numThreads = 1) const;
+
+		/*!
+		 *  \brief  Decode a whole 8 or 16-bit capture into stacked scanlines
+		 *
+		 *  \param  capture int The capture
+		 *  \param[out] image image16u The stacked scanlines, resized to fit
+		 *  \param  numThreads int Threads to decode on, 0 for all cores
+		 *
+		 *  \return bool True on success
+		 */
+		bool readCapture(int capture, image16u &image, int numThreads = 1) const;
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		//Not copyable, the mapping is owned
+		captureReader ( const captureReader &other );
+		captureReader& operator = ( const captureReader &other );
+
+		/*!
+		 *  \brief  Check a capture and its pixel type
+		 *
+		 *  \return bool False if the capture does not exist or is deeper than Scalar
+		 */
+		template<typename Scalar>
+		bool checkCapture(int capture) const;
+
+		/*!
+		 *  \brief  Decode one scanline
+		 *
+		 *  \param  capture int The capture
+		 *  \param  line int The scanline in the capture
+		 *  \param[out] out Scalar* lengthOfScan x cols pixels
+		 *
+		 *  \return bool True on success
+		 */
+		template<typename Scalar>
+		bool decode(int capture, int line, Scalar *out) const;
+
+		/*!
+		 *  \brief  Decode a whole capture
+		 */
+		template<typename Scalar>
+		bool decodeCapture(int capture, Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> &image,
+				int numThreads) const;
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		void *m_map; /**< Start of the mapping */
+		size_t m_mapSize; /**< Length of the mapping */
+		const captureEntry *m_captures; /**< Index of captures, in the mapping */
+		const chunkEntry *m_chunks; /**< Index of scanlines, in the mapping */
+		uint64_t m_numCaptures; /**< Number of captures */
+		uint64_t m_numChunks; /**< Number of scanlines */
+
+}; /* -----  end of class captureReader  ----- */
+
+} // End namespace fpTools
+
+#endif //CAPTUREREADER_H
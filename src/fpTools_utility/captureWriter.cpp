@@ -0,0 +1,215 @@
+/*!
+ *    \file  captureWriter.cpp
+ *   \brief  Implimentation of capture container writer
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/captureWriter.h"
+#include "fpTools_utility/captureCodec.h"
+
+namespace fpTools{
+
+//Constructor
+captureWriter::captureWriter(const char* fN, bool compress) :
+	m_file(NULL), m_offset(0), m_compress(true), m_failed(false), m_inCapture(false)
+{
+	open(fN, compress);
+}
+
+//Create file
+bool captureWriter::open(const char* fN, bool compress)
+{
+	close();
+
+	m_file = std::fopen(fN, "wb");
+	if( m_file == NULL )
+	{
+		std::fprintf(stderr, "Cannot open file to write %s\n", fN);
+		return false;
+	}
+
+	m_offset = 0;
+	m_compress = compress;
+	m_failed = false;
+	m_inCapture = false;
+	m_captures.clear();
+	m_chunks.clear();
+
+	captureFileHeader header;
+	std::memcpy(header.magic, captureMagic, sizeof(header.magic));
+	header.version = 1;
+	header.reserved = 0;
+
+	return writeBytes(&header, sizeof(header));
+}
+
+//Write index and close
+bool captureWriter::close()
+{
+	if( m_file == NULL ) return true;
+
+	captureFileTrailer trailer;
+	trailer.numCaptures = m_captures.size();
+	trailer.numChunks = m_chunks.size();
+	std::memcpy(trailer.magic, captureMagic, sizeof(trailer.magic));
+
+	//Align the index so it can be used in place
+	static const uint8_t zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	writeBytes(zeros, (8 - m_offset % 8) % 8);
+	trailer.indexOffset = m_offset;
+
+	writeBytes(m_captures.data(), m_captures.size()*sizeof(captureEntry));
+	writeBytes(m_chunks.data(), m_chunks.size()*sizeof(chunkEntry));
+	writeBytes(&trailer, sizeof(trailer));
+
+	if( std::fclose(m_file) != 0 ) m_failed = true;
+	m_file = NULL;
+	m_inCapture = false;
+
+	return !m_failed;
+}
+
+//Write bytes
+bool captureWriter::writeBytes(const void *data, size_t size)
+{
+	if( size > 0 && std::fwrite(data, 1, size, m_file) != size )
+	{
+		std::fprintf(stderr, "Unable to write capture data\n");
+		m_failed = true;
+		return false;
+	}
+
+	m_offset += size;
+	return true;
+}
+
+//Start capture
+bool captureWriter::beginCapture(int lengthOfScan, int cols, int bitDepth)
+{
+	if( m_file == NULL || lengthOfScan <= 0 || cols <= 0 || (bitDepth != 8 && bitDepth != 16) )
+	{
+		std::fprintf(stderr, "Bad capture size\n");
+		return false;
+	}
+
+	captureEntry entry;
+	entry.lengthOfScan = lengthOfScan;
+	entry.cols = cols;
+	entry.scanLines = 0;
+	entry.bitDepth = bitDepth;
+	entry.firstChunk = m_chunks.size();
+	m_captures.push_back(entry);
+
+	m_inCapture = true;
+	return true;
+}
+
+//Code and write scanline
+template<typename Scalar>
+bool captureWriter::writeChunk(const Scalar *pixels, int rows, int cols)
+{
+	if( !m_inCapture )
+	{
+		std::fprintf(stderr, "No capture started\n");
+		return false;
+	}
+
+	captureEntry &capture = m_captures.back();
+	if( static_cast<int>(capture.bitDepth) != 8*static_cast<int>(sizeof(Scalar)) ||
+			rows != static_cast<int>(capture.lengthOfScan) || cols != static_cast<int>(capture.cols) )
+	{
+		std::fprintf(stderr, "Scanline does not match the capture\n");
+		return false;
+	}
+
+	size_t count = static_cast<size_t>(rows)*cols;
+	size_t rawSize = count*sizeof(Scalar);
+
+	chunkEntry chunk;
+	chunk.offset = m_offset;
+	chunk.codec = CODEC_RAW;
+
+	//Keep the coded chunk only when it is smaller
+	m_buffer.clear();
+	if( m_compress ) encodeChunk(pixels, count, m_buffer);
+
+	bool ok;
+	if( m_compress && m_buffer.size() < rawSize )
+	{
+		chunk.codec = CODEC_DELTA_RLE;
+		chunk.size = static_cast<uint32_t>(m_buffer.size());
+		ok = writeBytes(m_buffer.data(), m_buffer.size());
+	}else
+	{
+		chunk.size = static_cast<uint32_t>(rawSize);
+		ok = writeBytes(pixels, rawSize);
+	}
+	if( !ok ) return false;
+
+	m_chunks.push_back(chunk);
+	capture.scanLines++;
+	return true;
+}
+
+//Add 8-bit scanline
+bool captureWriter::addScanline(const image8u &scan)
+{
+	return writeChunk(scan.data(), scan.rows(), scan.cols());
+}
+
+//Add 16-bit scanline
+bool captureWriter::addScanline(const image16u &scan)
+{
+	return writeChunk(scan.data(), scan.rows(), scan.cols());
+}
+
+//Add 8-bit capture
+bool captureWriter::addCapture(const image8u &image, int lengthOfScan)
+{
+	if( lengthOfScan <= 0 || image.rows() % lengthOfScan != 0 ) return false;
+	if( !beginCapture(lengthOfScan, image.cols(), 8) ) return false;
+
+	//Scanlines are contiguous in a row-major image
+	size_t scanSize = static_cast<size_t>(lengthOfScan)*image.cols();
+	for(int i = 0; i < image.rows()/lengthOfScan; i++)
+	{
+		if( !writeChunk(image.data() + i*scanSize, lengthOfScan, image.cols()) ) return false;
+	}
+
+	m_inCapture = false;
+	return true;
+}
+
+//Add 16-bit capture
+bool captureWriter::addCapture(const image16u &image, int lengthOfScan)
+{
+	if( lengthOfScan <= 0 || image.rows() % lengthOfScan != 0 ) return false;
+	if( !beginCapture(lengthOfScan, image.cols(), 16) ) return false;
+
+	size_t scanSize = static_cast<size_t>(lengthOfScan)*image.cols();
+	for(int i = 0; i < image.rows()/lengthOfScan; i++)
+	{
+		if( !writeChunk(image.data() + i*scanSize, lengthOfScan, image.cols()) ) return false;
+	}
+
+	m_inCapture = false;
+	return true;
+}
+
+} // End namespace fpTools
@@ -0,0 +1,193 @@
+/*!
+ *    \file  captureWriter.h
+ *   \brief  Writes capture container files
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstdio>
+#include <vector>
+#include <stdint.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+#include "fpTools_utility/captureFormat.h"
+
+#ifndef CAPTUREWRITER_H
+#define CAPTUREWRITER_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Class to write captures, a scanline at a time, into a container file
+ *
+ *  See captureFormat.h for the layout. Chunks are written as they arrive, the index is
+ *  kept in memory and written by close().
+ */
+class captureWriter
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor, no file open
+		 */
+		captureWriter() : m_file(NULL), m_offset(0), m_compress(true), m_failed(false), m_inCapture(false) {}
+
+		/*!
+		 *  \brief  Constructor, creates a file
+		 *
+		 *  \param  fN const char* The file path, check isOpen() for success
+		 *  \param  compress bool Code the chunks with CODEC_DELTA_RLE where it is smaller
+		 */
+		captureWriter (const char* fN, bool compress = true);                     /* constructor */
+
+		/*!
+		 *  \brief  Destructor, closes the file
+		 */
+		~captureWriter () {close();}                                /* destructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Check a file is open
+		 */
+		bool isOpen() const {return m_file != NULL;}
+
+		/*!
+		 *  \brief  Get number of captures written, including one in progress
+		 */
+		int numCaptures() const {return static_cast<int>(m_captures.size());}
+
+		/*!
+		 *  \brief  Get bytes written so far
+		 */
+		uint64_t bytesWritten() const {return m_offset;}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Create a file and write its header, closing any file open before
+		 *
+		 *  \param  fN const char* The file path
+		 *  \param  compress bool Code the chunks with CODEC_DELTA_RLE where it is smaller
+		 *
+		 *  \return bool True on success
+		 */
+		bool open(const char* fN, bool compress = true);
+
+		/*!
+		 *  \brief  Write the index and close the file
+		 *
+		 *  \return bool True if every write succeeded
+		 */
+		bool close();
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Start a capture, its scanlines are added with addScanline()
+		 *
+		 *  \param  lengthOfScan int Rows per scanline
+		 *  \param  cols int Cols of every scanline
+		 *  \param  bitDepth int 8 or 16
+		 *
+		 *  \return bool True on success
+		 */
+		bool beginCapture(int lengthOfScan, int cols, int bitDepth);
+
+		/*!
+		 *  \brief  Add a scanline to the current 8-bit capture
+		 *
+		 *  \param[in]  scan image8u lengthOfScan x cols
+		 *
+		 *  \return bool True on success
+		 */
+		bool addScanline(const image8u &scan);
+
+		/*!
+		 *  \brief  Add a scanline to the current 16-bit capture
+		 *
+		 *  \param[in]  scan image16u lengthOfScan x cols
+		 *
+		 *  \return bool True on success
+		 */
+		bool addScanline(const image16u &scan);
+
+		/*!
+		 *  \brief  Add a whole 8-bit capture of stacked scanlines
+		 *
+		 *  \param[in]  image image8u The stacked scanlines
+		 *  \param  lengthOfScan int Rows per scanline, must divide the rows of image
+		 *
+		 *  \return bool True on success
+		 */
+		bool addCapture(const image8u &image, int lengthOfScan);
+
+		/*!
+		 *  \brief  Add a whole 16-bit capture of stacked scanlines
+		 *
+		 *  \param[in]  image image16u The stacked scanlines
+		 *  \param  lengthOfScan int Rows per scanline, must divide the rows of image
+		 *
+		 *  \return bool True on success
+		 */
+		bool addCapture(const image16u &image, int lengthOfScan);
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		//Not copyable, the file is owned
+		captureWriter ( const captureWriter &other );
+		captureWriter& operator = ( const captureWriter &other );
+
+		/*!
+		 *  \brief  Code and write one scanline
+		 *
+		 *  \param[in]  pixels const Scalar* The scanline, contiguous
+		 *  \param  rows int Rows of the scanline
+		 *  \param  cols int Cols of the scanline
+		 *
+		 *  \return bool True on success
+		 */
+		template<typename Scalar>
+		bool writeChunk(const Scalar *pixels, int rows, int cols);
+
+		/*!
+		 *  \brief  Write bytes and advance the offset
+		 *
+		 *  \return bool True on success
+		 */
+		bool writeBytes(const void *data, size_t size);
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		FILE *m_file; /**< Open file */
+		uint64_t m_offset; /**< Bytes written */
+		bool m_compress; /**< Try CODEC_DELTA_RLE */
+		bool m_failed; /**< A write failed */
+		bool m_inCapture; /**< A capture is in progress */
+
+		std::vector<captureEntry> m_captures; /**< Index of captures */
+		std::vector<chunkEntry> m_chunks; /**< Index of scanlines */
+		std::vector<uint8_t> m_buffer; /**< Coded chunk */
+
+}; /* -----  end of class captureWriter  ----- */
+
+} // End namespace fpTools
+
+#endif //CAPTUREWRITER_H
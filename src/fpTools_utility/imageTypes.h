@@ -0,0 +1,39 @@
+/*!
+ *    \file  imageTypes.h
+ *   \brief  Compact image storage types
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ *  Images are stored row-major at the bit depth of the sensor, so a row is contiguous
+ *  in memory and an 8-bit image takes a quarter of the space of an Eigen::MatrixXi.
+ */
+
+//STL
+#include <stdint.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+#ifndef IMAGETYPES_H
+#define IMAGETYPES_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Row-major 8-bit image
+ */
+typedef Eigen::Matrix<uint8_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> image8u;
+
+/*!
+ *  \brief  Row-major 16-bit image
+ */
+typedef Eigen::Matrix<uint16_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> image16u;
+
+} // End namespace fpTools
+
+#endif //IMAGETYPES_H
@@ -0,0 +1,167 @@
+/*!
+ *    \file  ioPipeline.h
+ *   \brief  Ring-buffered pipeline overlapping reads, processing and writes
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#ifndef IOPIPELINE_H
+#define IOPIPELINE_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Pipeline running a load, a process and a store stage on a list of items
+ *
+ *  Items are loaded on a reader thread, processed on the calling thread and stored on a
+ *  writer thread. Each stage hands its result on through a ring of depth slots, so the
+ *  next item is read and the previous one written while the current one is processed,
+ *  and a run over many items takes about as long as its slowest stage. The slots are
+ *  kept between runs so their buffers are reused.
+ */
+template<typename Input, typename Output>
+class ioPipeline
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Constructor
+		 *
+		 *  \param  depth int Items held between each pair of stages, 2 to double buffer
+		 */
+		ioPipeline (int depth = 2) :
+			m_depth((depth > 0) ? depth : 1), m_inputs(m_depth), m_outputs(m_depth) {}       /* constructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Get number of slots between stages
+		 */
+		int getDepth(){return m_depth;}
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Run every item through the three stages
+		 *
+		 *  \param  count int Number of items
+		 *  \param  load Callable as bool load(int item, Input &in), on the reader thread
+		 *  \param  process Callable as bool process(int item, Input &in, Output &out),
+		 *  		on the calling thread
+		 *  \param  store Callable as bool store(int item, Output &out), on the writer thread
+		 *
+		 *  Items go through each stage in order. An item a stage fails on skips the stages
+		 *  after it. Each stage runs on one thread, so a stage needs no locking of its own.
+		 *
+		 *  \return int Number of items every stage succeeded on
+		 */
+		template<typename Load, typename Process, typename Store>
+		int run(int count, Load load, Process process, Store store)
+		{
+			std::vector<char> inOk(m_depth, 0), outOk(m_depth, 0);
+			std::mutex lock;
+			std::condition_variable changed;
+			int loaded = 0, processed = 0, stored = 0, done = 0;
+
+			//Reader fills an input slot once the item before in it is processed
+			std::thread reader([&]()
+			{
+				for(int i = 0; i < count; i++)
+				{
+					int slot = i % m_depth;
+					{
+						std::unique_lock<std::mutex> guard(lock);
+						changed.wait(guard, [&]{return i - processed < m_depth;});
+					}
+
+					bool ok = load(i, m_inputs[slot]);
+
+					{
+						std::lock_guard<std::mutex> guard(lock);
+						inOk[slot] = ok;
+						loaded++;
+					}
+					changed.notify_all();
+				}
+			});
+
+			//Writer empties an output slot once it is processed
+			std::thread writer([&]()
+			{
+				for(int i = 0; i < count; i++)
+				{
+					int slot = i % m_depth;
+					{
+						std::unique_lock<std::mutex> guard(lock);
+						changed.wait(guard, [&]{return processed > i;});
+					}
+
+					bool ok = outOk[slot] && store(i, m_outputs[slot]);
+
+					{
+						std::lock_guard<std::mutex> guard(lock);
+						if( ok ) done++;
+						stored++;
+					}
+					changed.notify_all();
+				}
+			});
+
+			//Calling thread processes once the input is loaded and the output slot is free
+			for(int i = 0; i < count; i++)
+			{
+				int slot = i % m_depth;
+				{
+					std::unique_lock<std::mutex> guard(lock);
+					changed.wait(guard, [&]{return loaded > i && i - stored < m_depth;});
+				}
+
+				bool ok = inOk[slot] && process(i, m_inputs[slot], m_outputs[slot]);
+
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					outOk[slot] = ok;
+					processed++;
+				}
+				changed.notify_all();
+			}
+
+			reader.join();
+			writer.join();
+			return done;
+		}
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		ioPipeline ( const ioPipeline &other );   /* not copyable */
+		ioPipeline& operator = ( const ioPipeline &other );
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		int m_depth; /**< Slots between each pair of stages */
+		std::vector<Input> m_inputs; /**< Ring of loaded items */
+		std::vector<Output> m_outputs; /**< Ring of processed items */
+
+}; /* -----  end of class ioPipeline  ----- */
+
+} // End namespace fpTools
+
+#endif //IOPIPELINE_H
@@ -0,0 +1,79 @@
+/*!
+ *    \file  parallelFor.h
+ *   \brief  Helper to split a loop over threads
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <thread>
+#include <vector>
+
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Resolve a requested thread count
+ *
+ *  \param  numThreads int Requested threads, 0 or less for all cores
+ *
+ *  \return int Number of threads to use, at least 1
+ */
+inline int resolveThreads(int numThreads)
+{
+	if( numThreads > 0 ) return numThreads;
+
+	int cores = static_cast<int>(std::thread::hardware_concurrency());
+	return (cores > 0) ? cores : 1;
+}
+
+/*!
+ *  \brief  Run a loop over [begin, end) split in contiguous chunks, one per thread
+ *
+ *  \param  begin int First index
+ *  \param  end int One past the last index
+ *  \param  numThreads int Number of threads, the calling thread runs the first chunk
+ *  \param  func Callable as func(int thread, int chunkBegin, int chunkEnd)
+ *
+ *  Returns once every chunk is done.
+ */
+template<typename Func>
+void parallelFor(int begin, int end, int numThreads, Func func)
+{
+	int count = end - begin;
+	if( count <= 0 ) return;
+	if( numThreads > count ) numThreads = count;
+	if( numThreads < 1 ) numThreads = 1;
+
+	//Chunk bounds
+	int chunk = count / numThreads;
+	int extra = count % numThreads;
+
+	std::vector<std::thread> workers;
+	workers.reserve(numThreads - 1);
+
+	int start = begin + chunk + (extra > 0 ? 1 : 0);
+	for(int t = 1; t < numThreads; t++)
+	{
+		int stop = start + chunk + (t < extra ? 1 : 0);
+		workers.push_back(std::thread(func, t, start, stop));
+		start = stop;
+	}
+
+	//Calling thread takes the first chunk
+	func(0, begin, begin + chunk + (extra > 0 ? 1 : 0));
+
+	for(size_t t = 0; t < workers.size(); t++) workers[t].join();
+}
+
+} // End namespace fpTools
+
+#endif //PARALLELFOR_H
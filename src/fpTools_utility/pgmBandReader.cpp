@@ -0,0 +1,197 @@
+/*!
+ *    \file  pgmBandReader.cpp
+ *   \brief  Implimentation of banded PGM reader
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+
+//POSIX
+#include <sys/types.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/pgmBandReader.h"
+#include "fpTools_utility/pgmMap.h"
+
+namespace fpTools{
+
+//Constructor
+pgmBandReader::pgmBandReader(const char* fN) :
+	m_file(NULL), m_dataOffset(0), m_rows(0), m_cols(0), m_max(0)
+{
+	open(fN);
+}
+
+//Open file and read header
+bool pgmBandReader::open(const char* fN)
+{
+	close();
+
+	m_file = std::fopen(fN, "rb");
+	if( m_file == NULL )
+	{
+		std::fprintf(stderr, "Unable to open file %s\n", fN);
+		return false;
+	}
+
+	//Read more of the file until the header is complete, comments can make it long
+	std::vector<uint8_t> head;
+	size_t offset = 0;
+	bool valid = false;
+	for(size_t want = 4096; !valid && want <= (1 << 20); want *= 2)
+	{
+		size_t have = head.size();
+		head.resize(want);
+		head.resize(have + std::fread(head.data() + have, 1, want - have, m_file));
+
+		valid = pgmMap::parseHeader(head.data(), head.size(), m_cols, m_rows, m_max, offset);
+		if( head.size() < want ) break;
+	}
+
+	if( !valid )
+	{
+		std::fprintf(stderr, "Unknown file type %s\n", fN);
+		close();
+		return false;
+	}
+	m_dataOffset = static_cast<long long>(offset);
+
+	//Make sure every row is there
+	long long dataSize = static_cast<long long>(m_rows)*m_cols*bytesPerPixel();
+	if( fseeko(m_file, 0, SEEK_END) != 0 || ftello(m_file) - m_dataOffset < dataSize )
+	{
+		std::fprintf(stderr, "Truncated PGM data %s\n", fN);
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+//Close file
+void pgmBandReader::close()
+{
+	if( m_file != NULL ) std::fclose(m_file);
+
+	m_file = NULL;
+	m_dataOffset = 0;
+	m_rows = 0;
+	m_cols = 0;
+	m_max = 0;
+}
+
+//Rows for a memory budget
+int pgmBandReader::bandRows(size_t budget, int bytesPerPixel) const
+{
+	size_t rowBytes = static_cast<size_t>(std::max(m_cols, 1))*bytesPerPixel;
+	size_t rows = budget/rowBytes;
+	return static_cast<int>(std::max<size_t>(1, std::min<size_t>(rows, std::max(m_rows, 1))));
+}
+
+//Clip tile
+bool pgmBandReader::clipTile(int startRow, int startCol, int &numRows, int &numCols)
+{
+	if( !isOpen() || startRow < 0 || startCol < 0 || startRow >= m_rows || startCol >= m_cols )
+	{
+		std::fprintf(stderr, "Band outside the image\n");
+		return false;
+	}
+
+	numRows = std::min(numRows, m_rows - startRow);
+	numCols = std::min(numCols, m_cols - startCol);
+	return numRows > 0 && numCols > 0;
+}
+
+//Read packed tile bytes
+bool pgmBandReader::readPacked(int startRow, int startCol, int numRows, int numCols, uint8_t *out)
+{
+	int bytes = bytesPerPixel();
+	size_t rowBytes = static_cast<size_t>(numCols)*bytes;
+
+	//Full rows are contiguous in the file
+	int runs = (numCols == m_cols) ? 1 : numRows;
+	size_t runBytes = (numCols == m_cols) ? rowBytes*numRows : rowBytes;
+
+	for(int r = 0; r < runs; r++)
+	{
+		long long pos = m_dataOffset + (static_cast<long long>(startRow + r)*m_cols + startCol)*bytes;
+		if( fseeko(m_file, static_cast<off_t>(pos), SEEK_SET) != 0 ||
+				std::fread(out + r*runBytes, 1, runBytes, m_file) != runBytes )
+		{
+			std::fprintf(stderr, "Unable to read PGM data\n");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//Read 8-bit band
+bool pgmBandReader::readBand(int startRow, int numRows, image8u &band)
+{
+	return readTile(startRow, 0, numRows, m_cols, band);
+}
+
+//Read 16-bit band
+bool pgmBandReader::readBand(int startRow, int numRows, image16u &band)
+{
+	return readTile(startRow, 0, numRows, m_cols, band);
+}
+
+//Read 8-bit tile
+bool pgmBandReader::readTile(int startRow, int startCol, int numRows, int numCols, image8u &tile)
+{
+	if( bytesPerPixel() != 1 )
+	{
+		std::fprintf(stderr, "16-bit PGM, read into image16u\n");
+		return false;
+	}
+	if( !clipTile(startRow, startCol, numRows, numCols) ) return false;
+
+	//File bytes are the pixels
+	tile.resize(numRows, numCols);
+	return readPacked(startRow, startCol, numRows, numCols, tile.data());
+}
+
+//Read 16-bit tile
+bool pgmBandReader::readTile(int startRow, int startCol, int numRows, int numCols, image16u &tile)
+{
+	if( !clipTile(startRow, startCol, numRows, numCols) ) return false;
+
+	tile.resize(numRows, numCols);
+	uint8_t *bytes = reinterpret_cast<uint8_t*>(tile.data());
+	if( !readPacked(startRow, startCol, numRows, numCols, bytes) ) return false;
+
+	if( bytesPerPixel() == 2 )
+	{
+		//Big-endian on disk
+		for(Eigen::Index k = 0; k < tile.size(); k++)
+		{
+			tile.data()[k] = static_cast<uint16_t>((bytes[2*k] << 8) | bytes[2*k+1]);
+		}
+	}else
+	{
+		//Widen in place from the back
+		for(Eigen::Index k = tile.size(); k > 0; k--)
+		{
+			tile.data()[k-1] = bytes[k-1];
+		}
+	}
+
+	return true;
+}
+
+} // End namespace fpTools
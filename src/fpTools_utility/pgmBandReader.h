@@ -0,0 +1,202 @@
+/*!
+ *    \file  pgmBandReader.h
+ *   \brief  Reads bands of rows from a PGM image
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstdio>
+#include <cstddef>
+#include <stdint.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+
+#ifndef PGMBANDREADER_H
+#define PGMBANDREADER_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Class to read a P5 PGM image a band of rows, or a tile, at a time
+ *
+ *  Only the header is read on open. Any band or tile can then be read by seeking to it,
+ *  so memory use is set by the band size and not by the image.
+ */
+class pgmBandReader
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor, no file open
+		 */
+		pgmBandReader() : m_file(NULL), m_dataOffset(0), m_rows(0), m_cols(0), m_max(0) {}
+
+		/*!
+		 *  \brief  Constructor, opens a file
+		 *
+		 *  \param  fN const char* The file path, check isOpen() for success
+		 */
+		pgmBandReader (const char* fN);                             /* constructor */
+
+		/*!
+		 *  \brief  Destructor, closes the file
+		 */
+		~pgmBandReader () {close();}                                /* destructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Check a file is open
+		 */
+		bool isOpen() const {return m_file != NULL;}
+
+		/*!
+		 *  \brief  Get number of rows
+		 */
+		int rows() const {return m_rows;}
+
+		/*!
+		 *  \brief  Get number of cols
+		 */
+		int cols() const {return m_cols;}
+
+		/*!
+		 *  \brief  Get maximum grey value from the header
+		 */
+		int getMaxVal() const {return m_max;}
+
+		/*!
+		 *  \brief  Get bytes per pixel, 1 for maximum grey values up to 255, else 2
+		 */
+		int bytesPerPixel() const {return (m_max > 255) ? 2 : 1;}
+
+		/*!
+		 *  \brief  Rows in a band that fits a memory budget
+		 *
+		 *  \param  budget size_t Bytes available for one band
+		 *  \param  bytesPerPixel int Bytes per pixel of the band image, 1 or 2
+		 *
+		 *  \return int Rows per band, at least 1 and at most rows()
+		 */
+		int bandRows(size_t budget, int bytesPerPixel) const;
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Open a file and read its header, closing any file open before
+		 *
+		 *  \param  fN const char* The file path
+		 *
+		 *  \return bool True if the file is a valid P5 PGM
+		 */
+		bool open(const char* fN);
+
+		/*!
+		 *  \brief  Close the file
+		 */
+		void close();
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Read a band of full rows from an 8-bit file
+		 *
+		 *  \param  startRow int First row of the band
+		 *  \param  numRows int Rows in the band, clipped to the bottom of the image
+		 *  \param[out] band image8u The rows, resized to fit
+		 *
+		 *  \return bool True on success, false for 16-bit files or rows outside the image
+		 */
+		bool readBand(int startRow, int numRows, image8u &band);
+
+		/*!
+		 *  \brief  Read a band of full rows from an 8 or 16-bit file
+		 *
+		 *  \param  startRow int First row of the band
+		 *  \param  numRows int Rows in the band, clipped to the bottom of the image
+		 *  \param[out] band image16u The rows, resized to fit
+		 *
+		 *  \return bool True on success
+		 */
+		bool readBand(int startRow, int numRows, image16u &band);
+
+		/*!
+		 *  \brief  Read a tile from an 8-bit file
+		 *
+		 *  \param  startRow int First row of the tile
+		 *  \param  startCol int First col of the tile
+		 *  \param  numRows int Rows in the tile, clipped to the image
+		 *  \param  numCols int Cols in the tile, clipped to the image
+		 *  \param[out] tile image8u The tile, resized to fit
+		 *
+		 *  \return bool True on success, false for 16-bit files or tiles outside the image
+		 */
+		bool readTile(int startRow, int startCol, int numRows, int numCols, image8u &tile);
+
+		/*!
+		 *  \brief  Read a tile from an 8 or 16-bit file
+		 *
+		 *  \param  startRow int First row of the tile
+		 *  \param  startCol int First col of the tile
+		 *  \param  numRows int Rows in the tile, clipped to the image
+		 *  \param  numCols int Cols in the tile, clipped to the image
+		 *  \param[out] tile image16u The tile, resized to fit
+		 *
+		 *  \return bool True on success
+		 */
+		bool readTile(int startRow, int startCol, int numRows, int numCols, image16u &tile);
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		//Not copyable, the file is owned
+		pgmBandReader ( const pgmBandReader &other );
+		pgmBandReader& operator = ( const pgmBandReader &other );
+
+		/*!
+		 *  \brief  Clip a tile to the image
+		 *
+		 *  \return bool False if the tile is empty
+		 */
+		bool clipTile(int startRow, int startCol, int &numRows, int &numCols);
+
+		/*!
+		 *  \brief  Read the file bytes of a tile, rows packed one after the other
+		 *
+		 *  \param[out] out uint8_t* Destination, numRows*numCols*bytesPerPixel() bytes
+		 *
+		 *  \return bool True on success
+		 *
+		 *  Full width tiles are read with one seek and one read.
+		 */
+		bool readPacked(int startRow, int startCol, int numRows, int numCols, uint8_t *out);
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		FILE *m_file; /**< Open file */
+		long long m_dataOffset; /**< Offset of the pixel data */
+		int m_rows; /**< Rows of the image */
+		int m_cols; /**< Cols of the image */
+		int m_max; /**< Maximum grey value */
+
+}; /* -----  end of class pgmBandReader  ----- */
+
+} // End namespace fpTools
+
+#endif //PGMBANDREADER_H
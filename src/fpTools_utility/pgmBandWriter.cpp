@@ -0,0 +1,185 @@
+/*!
+ *    \file  pgmBandWriter.cpp
+ *   \brief  Implimentation of banded PGM writer
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+//POSIX
+#include <sys/types.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/pgmBandWriter.h"
+
+namespace fpTools{
+
+//Constructor
+pgmBandWriter::pgmBandWriter(const char* fN, int cols, int rows, int max) :
+	m_file(NULL), m_dataOffset(0), m_rows(0), m_cols(0), m_max(0), m_rowsWritten(0), m_failed(false)
+{
+	open(fN, cols, rows, max);
+}
+
+//Create file
+bool pgmBandWriter::open(const char* fN, int cols, int rows, int max)
+{
+	close();
+
+	if( cols <= 0 || rows < 0 || max <= 0 || max > 65535 )
+	{
+		std::fprintf(stderr, "Bad PGM size\n");
+		return false;
+	}
+
+	m_file = std::fopen(fN, "wb");
+	if( m_file == NULL )
+	{
+		std::fprintf(stderr, "Cannot open file to write %s\n", fN);
+		return false;
+	}
+
+	m_fileName = fN;
+	m_rows = rows;
+	m_cols = cols;
+	m_max = max;
+	m_rowsWritten = 0;
+	m_failed = false;
+
+	if( !writeHeader(rows) )
+	{
+		std::fclose(m_file);
+		m_file = NULL;
+		return false;
+	}
+	m_dataOffset = ftello(m_file);
+
+	return true;
+}
+
+//Write header
+bool pgmBandWriter::writeHeader(int rows)
+{
+	//Unknown rows are padded with spaces so the count can be filled in later
+	int written;
+	if( m_rows > 0 )
+	{
+		written = std::fprintf(m_file, "P5 %i %i %i ", m_cols, rows, m_max);
+	}else
+	{
+		written = std::fprintf(m_file, "P5 %i %10i %i ", m_cols, rows, m_max);
+	}
+
+	return written > 0;
+}
+
+//Close file
+bool pgmBandWriter::close()
+{
+	if( m_file == NULL ) return true;
+
+	int bytes = (m_max > 255) ? 2 : 1;
+	if( m_rows > 0 && m_rowsWritten < m_rows )
+	{
+		//Rows never written read as 0
+		long long end = m_dataOffset + static_cast<long long>(m_rows)*m_cols*bytes;
+		if( fseeko(m_file, static_cast<off_t>(end - 1), SEEK_SET) != 0 || std::fputc(0, m_file) == EOF ) m_failed = true;
+	}else if( m_rows == 0 && m_rowsWritten == 0 )
+	{
+		//A PGM cannot have 0 rows, leave no file rather than one no reader opens
+		std::fprintf(stderr, "No rows written to %s\n", m_fileName.c_str());
+		m_failed = true;
+	}else if( m_rows == 0 )
+	{
+		//Fill in the rows
+		if( fseeko(m_file, 0, SEEK_SET) != 0 || !writeHeader(m_rowsWritten) ) m_failed = true;
+	}
+
+	if( std::fclose(m_file) != 0 ) m_failed = true;
+	m_file = NULL;
+	if( m_rows == 0 && m_rowsWritten == 0 ) std::remove(m_fileName.c_str());
+
+	return !m_failed;
+}
+
+//Encode and write rows
+template<typename Scalar>
+bool pgmBandWriter::writeRows(int startRow, const Scalar *data, int numRows, int numCols)
+{
+	if( m_file == NULL || startRow < 0 || numCols != m_cols || (m_rows > 0 && startRow + numRows > m_rows) )
+	{
+		std::fprintf(stderr, "Band does not fit the image\n");
+		return false;
+	}
+
+	int bytes = (m_max > 255) ? 2 : 1;
+	size_t count = static_cast<size_t>(numRows)*numCols;
+	long long pos = m_dataOffset + static_cast<long long>(startRow)*m_cols*bytes;
+	if( fseeko(m_file, static_cast<off_t>(pos), SEEK_SET) != 0 )
+	{
+		m_failed = true;
+		return false;
+	}
+
+	size_t written;
+	if( sizeof(Scalar) == 1 && bytes == 1 )
+	{
+		//Already laid out as the file
+		written = std::fwrite(data, 1, count, m_file);
+	}else
+	{
+		//Clamp and encode, big-endian for 16-bit
+		m_buffer.resize(count*bytes);
+		for(size_t k = 0; k < count; k++)
+		{
+			int v = std::min(static_cast<int>(data[k]), m_max);
+			if( bytes == 2 )
+			{
+				m_buffer[2*k] = static_cast<uint8_t>(v >> 8);
+				m_buffer[2*k+1] = static_cast<uint8_t>(v & 0xFF);
+			}else
+			{
+				m_buffer[k] = static_cast<uint8_t>(v);
+			}
+		}
+		written = std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file)/bytes;
+	}
+
+	if( written != count )
+	{
+		std::fprintf(stderr, "Unable to write PGM data\n");
+		m_failed = true;
+		return false;
+	}
+
+	m_rowsWritten = std::max(m_rowsWritten, startRow + numRows);
+	return true;
+}
+
+//Write 8-bit band
+bool pgmBandWriter::writeBand(int startRow, const image8u &band)
+{
+	return writeRows(startRow, band.data(), band.rows(), band.cols());
+}
+
+//Write 16-bit band
+bool pgmBandWriter::writeBand(int startRow, const image16u &band)
+{
+	return writeRows(startRow, band.data(), band.rows(), band.cols());
+}
+
+} // End namespace fpTools
@@ -0,0 +1,193 @@
+/*!
+ *    \file  pgmBandWriter.h
+ *   \brief  Writes bands of rows to a PGM image
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+
+#ifndef PGMBANDWRITER_H
+#define PGMBANDWRITER_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Class to write a P5 PGM image a band of rows at a time
+ *
+ *  Bands can be appended or written at any row. When the number of rows is not known
+ *  up front, as for a swipe being registered, the header is written with room for it
+ *  and filled in on close(). Values outside the maximum grey value are clamped.
+ */
+class pgmBandWriter
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor, no file open
+		 */
+		pgmBandWriter() : m_file(NULL), m_dataOffset(0), m_rows(0), m_cols(0), m_max(0), m_rowsWritten(0), m_failed(false) {}
+
+		/*!
+		 *  \brief  Constructor, creates a file
+		 *
+		 *  \param  fN const char* The file path, check isOpen() for success
+		 *  \param  cols int Number of cols
+		 *  \param  rows int Number of rows, 0 if not known until close()
+		 *  \param  max int Maximum grey value, above 255 writes 16-bit
+		 */
+		pgmBandWriter (const char* fN, int cols, int rows = 0, int max = 255);    /* constructor */
+
+		/*!
+		 *  \brief  Destructor, closes the file
+		 */
+		~pgmBandWriter () {close();}                                /* destructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Check a file is open
+		 */
+		bool isOpen() const {return m_file != NULL;}
+
+		/*!
+		 *  \brief  Get number of cols
+		 */
+		int cols() const {return m_cols;}
+
+		/*!
+		 *  \brief  Get number of rows written so far, to the last row of any band
+		 */
+		int getRowsWritten() const {return m_rowsWritten;}
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Create a file and write its header, closing any file open before
+		 *
+		 *  \param  fN const char* The file path
+		 *  \param  cols int Number of cols
+		 *  \param  rows int Number of rows, 0 if not known until close()
+		 *  \param  max int Maximum grey value, above 255 writes 16-bit
+		 *
+		 *  \return bool True on success
+		 */
+		bool open(const char* fN, int cols, int rows = 0, int max = 255);
+
+		/*!
+		 *  \brief  Fill in the number of rows if it was not known, and close the file
+		 *
+		 *  A file opened without a row count that no band was written to is removed, as a
+		 *  PGM cannot record 0 rows.
+		 *
+		 *  \return bool True if every write succeeded, false if the file was removed
+		 */
+		bool close();
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Write a band of rows
+		 *
+		 *  \param  startRow int Row of the image the band starts at
+		 *  \param[in]  band image8u The rows, cols() wide
+		 *
+		 *  \return bool True on success
+		 */
+		bool writeBand(int startRow, const image8u &band);
+
+		/*!
+		 *  \brief  Write a band of rows
+		 *
+		 *  \param  startRow int Row of the image the band starts at
+		 *  \param[in]  band image16u The rows, cols() wide
+		 *
+		 *  \return bool True on success
+		 */
+		bool writeBand(int startRow, const image16u &band);
+
+		/*!
+		 *  \brief  Write a band of rows after the last row written
+		 *
+		 *  \param[in]  band image8u The rows, cols() wide
+		 *
+		 *  \return bool True on success
+		 */
+		bool appendBand(const image8u &band){return writeBand(m_rowsWritten, band);}
+
+		/*!
+		 *  \brief  Write a band of rows after the last row written
+		 *
+		 *  \param[in]  band image16u The rows, cols() wide
+		 *
+		 *  \return bool True on success
+		 */
+		bool appendBand(const image16u &band){return writeBand(m_rowsWritten, band);}
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		//Not copyable, the file is owned
+		pgmBandWriter ( const pgmBandWriter &other );
+		pgmBandWriter& operator = ( const pgmBandWriter &other );
+
+		/*!
+		 *  \brief  Encode and write a band of rows
+		 *
+		 *  \param  startRow int Row of the image the band starts at
+		 *  \param[in]  data const Scalar* The rows, contiguous
+		 *  \param  numRows int Rows in the band
+		 *  \param  numCols int Cols in the band
+		 *
+		 *  \return bool True on success
+		 */
+		template<typename Scalar>
+		bool writeRows(int startRow, const Scalar *data, int numRows, int numCols);
+
+		/*!
+		 *  \brief  Write the header
+		 *
+		 *  \param  rows int Number of rows to record
+		 *
+		 *  \return bool True on success
+		 */
+		bool writeHeader(int rows);
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		FILE *m_file; /**< Open file */
+		std::string m_fileName; /**< Path of the open file */
+		long long m_dataOffset; /**< Offset of the pixel data */
+		int m_rows; /**< Rows given on open, 0 if unknown */
+		int m_cols; /**< Cols of the image */
+		int m_max; /**< Maximum grey value */
+		int m_rowsWritten; /**< One past the last row written */
+		bool m_failed; /**< A write failed */
+		std::vector<uint8_t> m_buffer; /**< Encoded band */
+
+}; /* -----  end of class pgmBandWriter  ----- */
+
+} // End namespace fpTools
+
+#endif //PGMBANDWRITER_H
@@ -13,6 +13,8 @@
 //STL
 #include <cstdio>
 #include <cstring>
+#include <vector>
+#include <algorithm>
 
 //Eigen3
 #include <Eigen/Core>
@@ -103,35 +105,271 @@ void pgmIO::read(Eigen::MatrixXi &image)
 
 }
 
-//Function to write PGM data
-void pgmIO::write(Eigen::MatrixXi &image){
+//Open file and read header
+FILE* pgmIO::openHeader(int &col, int &row, int &max)
+{
+	char version[3];
 
-	/* Define */
-	FILE *fileVar;
-	int i, j;
-	int h, l;
+	/* Open and start reading */
+	FILE *fileVar = std::fopen(m_fN, "rb");
+	if (fileVar == NULL){
+		std::fprintf(stderr,"Unable to open file\n");
+		return NULL;
+	}
 
-	/* Open file for writing */
-	fileVar = fopen(m_fN, "wb");
-	if(fileVar == NULL){
-		std::fprintf(stderr,"Cannot open file to write");
-		return;
-	}	
+	/*Get Version*/
+	if( std::fgets(version, sizeof(version), fileVar) == NULL || std::strcmp(version, "P5") ){
+		std::fprintf(stderr,"Unknown file type\n");
+		std::fclose(fileVar);
+		return NULL;
+	}
 
-	/*Write header*/
-	std::fprintf(fileVar, "P5 ");
-	std::fprintf(fileVar, "%i %i ", (int)image.cols(), (int)image.rows());
-	std::fprintf(fileVar, "%i ", 255);
-	
-	/*Write data*/
-	for( i = 0; i < image.rows(); i++){
-		for( j = 0; j < image.cols(); j++){
-			l = (image(i,j)  & 0x000000FF );
-			std::fputc(l, fileVar);
+	std::fgetc(fileVar); /*burn off \n */
+	/*Skip through comments*/
+	skipComments(fileVar);
+	/*Get row, col and max grey value*/
+	if( std::fscanf(fileVar, "%i %i %i", &col, &row, &max) != 3 || col <= 0 || row <= 0 || max <= 0 || max > 65535 ){
+		std::fprintf(stderr,"Bad PGM header\n");
+		std::fclose(fileVar);
+		return NULL;
+	}
+	std::fgetc(fileVar); /*burn off \n */
+
+	return fileVar;
+}
+
+//Function to read 8-bit PGM image
+bool pgmIO::read(image8u &image)
+{
+	int col, row, max;
+	FILE *fileVar = openHeader(col, row, max);
+	if( fileVar == NULL ) return false;
+
+	if( max > 255 ){
+		std::fprintf(stderr,"16-bit PGM, read into image16u\n");
+		std::fclose(fileVar);
+		return false;
+	}
+
+	/* Rows are contiguous, read the whole image at once */
+	image.resize(row, col);
+	size_t count = std::fread(image.data(), 1, image.size(), fileVar);
+	std::fclose(fileVar);
+
+	if( count != static_cast<size_t>(image.size()) ){
+		std::fprintf(stderr,"Truncated PGM data\n");
+		return false;
+	}
+
+	return true;
+}
+
+//Function to read 8 or 16-bit PGM image
+bool pgmIO::read(image16u &image)
+{
+	int col, row, max;
+	FILE *fileVar = openHeader(col, row, max);
+	if( fileVar == NULL ) return false;
+
+	image.resize(row, col);
+	size_t count;
+	if( max > 255 ){
+		/* Two bytes a pixel, most significant first */
+		count = std::fread(image.data(), 2, image.size(), fileVar);
+		uint8_t *bytes = reinterpret_cast<uint8_t*>(image.data());
+		for(size_t k = 0; k < count; k++){
+			image.data()[k] = static_cast<uint16_t>((bytes[2*k] << 8) | bytes[2*k+1]);
+		}
+	}else{
+		/* One byte a pixel, widen in place from the back */
+		count = std::fread(image.data(), 1, image.size(), fileVar);
+		uint8_t *bytes = reinterpret_cast<uint8_t*>(image.data());
+		for(size_t k = count; k > 0; k--){
+			image.data()[k-1] = bytes[k-1];
 		}
 	}
-	
-	/* Close */
 	std::fclose(fileVar);
+
+	if( count != static_cast<size_t>(image.size()) ){
+		std::fprintf(stderr,"Truncated PGM data\n");
+		return false;
+	}
+
+	return true;
+}
+
+//Format header
+size_t pgmIO::formatHeader(int cols, int rows, int max, char header[32])
+{
+	return static_cast<size_t>(std::snprintf(header, 32, "P5 %i %i %i ", cols, rows, max));
+}
+
+//Encode PGM data
+size_t pgmIO::encode(const Eigen::MatrixXi &image, uint8_t *buf, size_t size)
+{
+	//Only go to 16-bit when the data needs it
+	int max = (image.size() > 0 && image.maxCoeff() > 255) ? 65535 : 255;
+	int bytes = (max > 255) ? 2 : 1;
+
+	char header[32];
+	size_t headerSize = formatHeader(image.cols(), image.rows(), max, header);
+	size_t total = headerSize + bytes*static_cast<size_t>(image.size());
+	if( buf == NULL || total > size ) return total;
+
+	std::memcpy(buf, header, headerSize);
+	uint8_t *out = buf + headerSize;
+	for(int i = 0; i < image.rows(); i++)
+	{
+		for(int j = 0; j < image.cols(); j++)
+		{
+			int v = std::min(std::max(image(i,j), 0), max);
+			if( bytes == 2 ) *out++ = static_cast<uint8_t>(v >> 8);
+			*out++ = static_cast<uint8_t>(v & 0xFF);
+		}
+	}
+
+	return total;
+}
+
+//Encode 8-bit PGM data
+size_t pgmIO::encode(const image8u &image, uint8_t *buf, size_t size)
+{
+	char header[32];
+	size_t headerSize = formatHeader(image.cols(), image.rows(), 255, header);
+	size_t total = headerSize + static_cast<size_t>(image.size());
+	if( buf == NULL || total > size ) return total;
+
+	std::memcpy(buf, header, headerSize);
+	std::memcpy(buf + headerSize, image.data(), image.size());
+
+	return total;
+}
+
+//Encode 16-bit PGM data
+size_t pgmIO::encode(const image16u &image, uint8_t *buf, size_t size)
+{
+	char header[32];
+	size_t headerSize = formatHeader(image.cols(), image.rows(), 65535, header);
+	size_t total = headerSize + 2*static_cast<size_t>(image.size());
+	if( buf == NULL || total > size ) return total;
+
+	std::memcpy(buf, header, headerSize);
+
+	//Big-endian
+	uint8_t *out = buf + headerSize;
+	const uint16_t *in = image.data();
+	for(Eigen::Index k = 0; k < image.size(); k++)
+	{
+		out[2*k] = static_cast<uint8_t>(in[k] >> 8);
+		out[2*k+1] = static_cast<uint8_t>(in[k] & 0xFF);
+	}
+
+	return total;
+}
+
+/*!
+ *  \brief  Unpack a row of a binary image, set pixels 0 and the rest 255
+ *
+ *  \param[in]  image bitImage The image
+ *  \param  r int The row
+ *  \param[out] out uint8_t* cols bytes
+ */
+static void unpackRow(const bitImage &image, int r, uint8_t *out)
+{
+	const uint64_t *words = image.row(r);
+	for(int c = 0; c < image.cols(); c++)
+	{
+		out[c] = ((words[c >> 6] >> (c & 63)) & 1) ? 0 : 255;
+	}
+}
+
+//Encode binary PGM data
+size_t pgmIO::encode(const bitImage &image, uint8_t *buf, size_t size)
+{
+	char header[32];
+	size_t headerSize = formatHeader(image.cols(), image.rows(), 255, header);
+	size_t total = headerSize + static_cast<size_t>(image.rows())*image.cols();
+	if( buf == NULL || total > size ) return total;
+
+	std::memcpy(buf, header, headerSize);
+	for(int r = 0; r < image.rows(); r++)
+	{
+		unpackRow(image, r, buf + headerSize + static_cast<size_t>(r)*image.cols());
+	}
+
+	return total;
+}
+
+//Write encoded data
+bool pgmIO::writeEncoded(const std::vector<uint8_t> &data)
+{
+	FILE *fileVar = std::fopen(m_fN, "wb");
+	if(fileVar == NULL){
+		std::fprintf(stderr,"Cannot open file to write\n");
+		return false;
+	}
+
+	size_t count = std::fwrite(data.data(), 1, data.size(), fileVar);
+
+	return std::fclose(fileVar) == 0 && count == data.size();
+}
+
+//Function to write 8-bit PGM data
+bool pgmIO::write(const image8u &image)
+{
+	FILE *fileVar = std::fopen(m_fN, "wb");
+	if(fileVar == NULL){
+		std::fprintf(stderr,"Cannot open file to write\n");
+		return false;
+	}
+
+	//Already laid out as the file, write straight from the image
+	char header[32];
+	size_t headerSize = formatHeader(image.cols(), image.rows(), 255, header);
+	bool ok = std::fwrite(header, 1, headerSize, fileVar) == headerSize;
+	ok = ok && std::fwrite(image.data(), 1, image.size(), fileVar) == static_cast<size_t>(image.size());
+
+	return std::fclose(fileVar) == 0 && ok;
+}
+
+//Function to write binary PGM data
+bool pgmIO::write(const bitImage &image)
+{
+	FILE *fileVar = std::fopen(m_fN, "wb");
+	if(fileVar == NULL){
+		std::fprintf(stderr,"Cannot open file to write\n");
+		return false;
+	}
+
+	//Only one row is ever unpacked
+	char header[32];
+	size_t headerSize = formatHeader(image.cols(), image.rows(), 255, header);
+	bool ok = std::fwrite(header, 1, headerSize, fileVar) == headerSize;
+	std::vector<uint8_t> line(image.cols());
+	for(int r = 0; r < image.rows() && ok; r++)
+	{
+		unpackRow(image, r, line.data());
+		ok = std::fwrite(line.data(), 1, line.size(), fileVar) == line.size();
+	}
+
+	return std::fclose(fileVar) == 0 && ok;
+}
+
+//Function to write 16-bit PGM data
+bool pgmIO::write(const image16u &image)
+{
+	std::vector<uint8_t> data(encode(image, NULL, 0));
+	encode(image, data.data(), data.size());
+
+	return writeEncoded(data);
+}
+
+//Function to write PGM data
+bool pgmIO::write(const Eigen::MatrixXi &image)
+{
+	std::vector<uint8_t> data(encode(image, NULL, 0));
+	encode(image, data.data(), data.size());
+
+	return writeEncoded(data);
 }
 } //End namespace fpTools
@@ -10,9 +10,18 @@
  *      Compiler:  gcc
  */
 
+//STL
+#include <cstdio>
+#include <vector>
+#include <stdint.h>
+
 //Eigen3
 #include <Eigen/Core>
 
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+#include "fpTools_utility/bitImage.h"
+
 #ifndef PGMIO_H
 #define PGMIO_H
 
@@ -76,8 +85,104 @@ class pgmIO
 		 *  \brief  Writes a PGM image
 		 *  
 		 *  \param[in] image Eigen::MatrixXi Data to write to PGM
+		 *
+		 *  \return bool True on success
+		 *
+		 *  Written as 8-bit if every value fits, else as 16-bit with a maximum grey value
+		 *  of 65535. Values outside the range are clamped.
+		 */
+		bool write(const Eigen::MatrixXi &image);
+
+		/*!
+		 *  \brief  Reads an 8-bit PGM image
+		 *  
+		 *  \param[out] image image8u Image to store PGM data, resized to fit
+		 *
+		 *  \return bool True on success, false if the file can not be read or is 16-bit
+		 */
+		bool read(image8u &image);
+
+		/*!
+		 *  \brief  Reads an 8 or 16-bit PGM image
+		 *  
+		 *  \param[out] image image16u Image to store PGM data, resized to fit
+		 *
+		 *  \return bool True on success
+		 */
+		bool read(image16u &image);
+
+		/*!
+		 *  \brief  Writes an 8-bit PGM image
+		 *  
+		 *  \param[in] image image8u Data to write to PGM
+		 *
+		 *  \return bool True on success
+		 */
+		bool write(const image8u &image);
+
+		/*!
+		 *  \brief  Writes a 16-bit PGM image, big-endian with a maximum grey value of 65535
+		 *  
+		 *  \param[in] image image16u Data to write to PGM
+		 *
+		 *  \return bool True on success
+		 */
+		bool write(const image16u &image);
+
+		/*!
+		 *  \brief  Writes a binary image as an 8-bit PGM image, set pixels 0 and the rest 255
+		 *  
+		 *  \param[in] image bitImage Data to write to PGM
+		 *
+		 *  \return bool True on success
+		 *
+		 *  Unpacked a row at a time as it is written.
+		 */
+		bool write(const bitImage &image);
+
+		/*!
+		 *  \brief  Encodes a PGM image into memory
+		 *  
+		 *  \param[in] image Eigen::MatrixXi Data to encode, as write()
+		 *  \param[out] buf uint8_t* Buffer for the encoded file, may be NULL
+		 *  \param  size size_t Size of buf
+		 *
+		 *  \return size_t Size of the encoded file, nothing is written if larger than size
+		 */
+		static size_t encode(const Eigen::MatrixXi &image, uint8_t *buf, size_t size);
+
+		/*!
+		 *  \brief  Encodes an 8-bit PGM image into memory
+		 *  
+		 *  \param[in] image image8u Data to encode
+		 *  \param[out] buf uint8_t* Buffer for the encoded file, may be NULL
+		 *  \param  size size_t Size of buf
+		 *
+		 *  \return size_t Size of the encoded file, nothing is written if larger than size
+		 */
+		static size_t encode(const image8u &image, uint8_t *buf, size_t size);
+
+		/*!
+		 *  \brief  Encodes a 16-bit PGM image into memory
+		 *  
+		 *  \param[in] image image16u Data to encode
+		 *  \param[out] buf uint8_t* Buffer for the encoded file, may be NULL
+		 *  \param  size size_t Size of buf
+		 *
+		 *  \return size_t Size of the encoded file, nothing is written if larger than size
+		 */
+		static size_t encode(const image16u &image, uint8_t *buf, size_t size);
+
+		/*!
+		 *  \brief  Encodes a binary image into memory as an 8-bit PGM image, as write()
+		 *  
+		 *  \param[in] image bitImage Data to encode
+		 *  \param[out] buf uint8_t* Buffer for the encoded file, may be NULL
+		 *  \param  size size_t Size of buf
+		 *
+		 *  \return size_t Size of the encoded file, nothing is written if larger than size
 		 */
-		void write(Eigen::MatrixXi &image);			
+		static size_t encode(const bitImage &image, uint8_t *buf, size_t size);
 		
 		
 		//Assignment operator.
@@ -98,6 +203,38 @@ class pgmIO
 		 */
 		void skipComments(FILE* fP);
 
+		/*!
+		 *  \brief  Opens the file and reads the PGM header
+		 *  
+		 *  \param[out] col int Number of cols
+		 *  \param[out] row int Number of rows
+		 *  \param[out] max int Maximum grey value
+		 *
+		 *  \return FILE* The file positioned at the pixel data, NULL on failure
+		 */
+		FILE* openHeader(int &col, int &row, int &max);
+
+		/*!
+		 *  \brief  Formats a PGM header
+		 *  
+		 *  \param  cols int Number of cols
+		 *  \param  rows int Number of rows
+		 *  \param  max int Maximum grey value
+		 *  \param[out] header char[32] The header text
+		 *
+		 *  \return size_t Length of the header
+		 */
+		static size_t formatHeader(int cols, int rows, int max, char header[32]);
+
+		/*!
+		 *  \brief  Writes an encoded file in one write
+		 *  
+		 *  \param  data const std::vector<uint8_t> The encoded file
+		 *
+		 *  \return bool True on success
+		 */
+		bool writeEncoded(const std::vector<uint8_t> &data);
+
 		/* ====================  DATA MEMBERS  ======================================= */
 		const char* m_fN; /**< Filename */
 
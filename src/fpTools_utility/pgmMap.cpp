@@ -0,0 +1,219 @@
+/*!
+ *    \file  pgmMap.cpp
+ *   \brief  Implimentation of memory-mapped PGM reader
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstdio>
+#include <cstring>
+#include <climits>
+
+//POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/pgmMap.h"
+
+namespace fpTools{
+
+//PGM whitespace
+static inline bool isSpace(uint8_t c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+//Constructor
+pgmMap::pgmMap(const char* fN) :
+	m_fd(-1), m_map(NULL), m_mapSize(0), m_pixels(NULL), m_rows(0), m_cols(0), m_max(0)
+{
+	open(fN);
+}
+
+//Parse header
+bool pgmMap::parseHeader(const uint8_t *buf, size_t size, int &cols, int &rows, int &max, size_t &offset)
+{
+	//Magic number
+	if( size < 2 || buf[0] != 'P' || buf[1] != '5' ) return false;
+	size_t pos = 2;
+
+	//Width, height and maximum grey value
+	long long fields[3];
+	for(int f = 0; f < 3; f++)
+	{
+		//Whitespace and comments before each field, at least one separator
+		size_t start = pos;
+		while( pos < size )
+		{
+			if( isSpace(buf[pos]) )
+			{
+				pos++;
+			}else if( buf[pos] == '#' )
+			{
+				while( pos < size && buf[pos] != '\n' ) pos++;
+			}else
+			{
+				break;
+			}
+		}
+		if( pos == start || pos >= size ) return false;
+
+		//Decimal value
+		if( buf[pos] < '0' || buf[pos] > '9' ) return false;
+		long long value = 0;
+		while( pos < size && buf[pos] >= '0' && buf[pos] <= '9' )
+		{
+			value = 10*value + (buf[pos] - '0');
+			if( value > INT_MAX ) return false;
+			pos++;
+		}
+		fields[f] = value;
+	}
+
+	//A comment may run up to the single whitespace before the data
+	if( pos < size && buf[pos] == '#' )
+	{
+		while( pos < size && buf[pos] != '\n' ) pos++;
+	}
+	if( pos >= size || !isSpace(buf[pos]) ) return false;
+	pos++;
+
+	cols = static_cast<int>(fields[0]);
+	rows = static_cast<int>(fields[1]);
+	max = static_cast<int>(fields[2]);
+	offset = pos;
+
+	return cols > 0 && rows > 0 && max > 0 && max <= 65535;
+}
+
+//Map file
+bool pgmMap::open(const char* fN)
+{
+	close();
+
+	//Open and size
+	m_fd = ::open(fN, O_RDONLY);
+	if( m_fd < 0 )
+	{
+		std::fprintf(stderr, "Unable to open file %s\n", fN);
+		return false;
+	}
+
+	struct stat info;
+	if( fstat(m_fd, &info) != 0 || info.st_size <= 0 )
+	{
+		std::fprintf(stderr, "Unable to size file %s\n", fN);
+		close();
+		return false;
+	}
+	m_mapSize = static_cast<size_t>(info.st_size);
+
+	//Private, so 16-bit data can be swapped in place without touching the file
+	m_map = mmap(NULL, m_mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_fd, 0);
+	if( m_map == MAP_FAILED )
+	{
+		m_map = NULL;
+		std::fprintf(stderr, "Unable to map file %s\n", fN);
+		close();
+		return false;
+	}
+	uint8_t *bytes = static_cast<uint8_t*>(m_map);
+
+	//Header
+	size_t offset;
+	if( !parseHeader(bytes, m_mapSize, m_cols, m_rows, m_max, offset) )
+	{
+		std::fprintf(stderr, "Unknown file type %s\n", fN);
+		close();
+		return false;
+	}
+
+	size_t count = static_cast<size_t>(m_rows)*m_cols;
+	if( m_mapSize - offset < count*bytesPerPixel() )
+	{
+		std::fprintf(stderr, "Truncated PGM data %s\n", fN);
+		close();
+		return false;
+	}
+
+	if( bytesPerPixel() == 2 )
+	{
+		//Big-endian on disk, move back a byte if needed so the pixels are aligned
+		size_t aligned = offset & ~static_cast<size_t>(1);
+		const uint16_t probe = 1;
+		bool little = *reinterpret_cast<const uint8_t*>(&probe) == 1;
+
+		uint16_t *out = reinterpret_cast<uint16_t*>(bytes + aligned);
+		if( aligned == offset )
+		{
+			if( little )
+			{
+				for(size_t k = 0; k < count; k++)
+				{
+					out[k] = static_cast<uint16_t>((out[k] >> 8) | (out[k] << 8));
+				}
+			}
+		}else
+		{
+			//Each pixel is read before its bytes are overwritten
+			const uint8_t *in = bytes + offset;
+			for(size_t k = 0; k < count; k++)
+			{
+				uint8_t h = in[2*k];
+				uint8_t l = in[2*k+1];
+				out[k] = static_cast<uint16_t>((h << 8) | l);
+			}
+		}
+		offset = aligned;
+	}
+
+	//Nothing writes to the pixels from here
+	mprotect(m_map, m_mapSize, PROT_READ);
+	m_pixels = bytes + offset;
+
+	return true;
+}
+
+//Unmap file
+void pgmMap::close()
+{
+	if( m_map != NULL ) munmap(m_map, m_mapSize);
+	if( m_fd >= 0 ) ::close(m_fd);
+
+	m_fd = -1;
+	m_map = NULL;
+	m_mapSize = 0;
+	m_pixels = NULL;
+	m_rows = 0;
+	m_cols = 0;
+	m_max = 0;
+}
+
+//8-bit view
+Eigen::Map<const image8u> pgmMap::image8() const
+{
+	if( !isOpen() || bytesPerPixel() != 1 ) return Eigen::Map<const image8u>(NULL, 0, 0);
+	return Eigen::Map<const image8u>(m_pixels, m_rows, m_cols);
+}
+
+//16-bit view
+Eigen::Map<const image16u> pgmMap::image16() const
+{
+	if( !isOpen() || bytesPerPixel() != 2 ) return Eigen::Map<const image16u>(NULL, 0, 0);
+	return Eigen::Map<const image16u>(reinterpret_cast<const uint16_t*>(m_pixels), m_rows, m_cols);
+}
+
+} // End namespace fpTools
@@ -0,0 +1,161 @@
+/*!
+ *    \file  pgmMap.h
+ *   \brief  Memory-mapped reader for PGM images
+ *
+ *  \author David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ *
+ */
+
+//STL
+#include <cstddef>
+#include <stdint.h>
+
+//Eigen3
+#include <Eigen/Core>
+
+//fpTools
+#include "fpTools_utility/imageTypes.h"
+
+#ifndef PGMMAP_H
+#define PGMMAP_H
+
+namespace fpTools{
+
+/*!
+ *  \brief  Class to read a P5 PGM image by mapping the file into memory
+ *
+ *  The pixels are used where they sit in the mapping, nothing is copied. 8-bit files are
+ *  mapped read-only. 16-bit files are mapped copy-on-write and byte swapped in place
+ *  once, so only the pages of the pixel data are copied. The file stays mapped until
+ *  close() or destruction, views returned by image8()/image16() are invalid after.
+ */
+class pgmMap
+{
+	public:
+		/* ====================  LIFECYCLE     ======================================= */
+
+		/*!
+		 *  \brief  Default constructor, nothing mapped
+		 */
+		pgmMap() : m_fd(-1), m_map(NULL), m_mapSize(0), m_pixels(NULL), m_rows(0), m_cols(0), m_max(0) {}
+
+		/*!
+		 *  \brief  Constructor, maps a file
+		 *
+		 *  \param  fN const char* The file path, check isOpen() for success
+		 */
+		pgmMap (const char* fN);                             /* constructor */
+
+		/*!
+		 *  \brief  Destructor, unmaps the file
+		 */
+		~pgmMap () {close();}                                /* destructor */
+
+		/* ====================  ACCESSORS     ======================================= */
+
+		/*!
+		 *  \brief  Check a file is mapped
+		 */
+		bool isOpen() const {return m_pixels != NULL;}
+
+		/*!
+		 *  \brief  Get number of rows
+		 */
+		int rows() const {return m_rows;}
+
+		/*!
+		 *  \brief  Get number of cols
+		 */
+		int cols() const {return m_cols;}
+
+		/*!
+		 *  \brief  Get maximum grey value from the header
+		 */
+		int getMaxVal() const {return m_max;}
+
+		/*!
+		 *  \brief  Get bytes per pixel, 1 for maximum grey values up to 255, else 2
+		 */
+		int bytesPerPixel() const {return (m_max > 255) ? 2 : 1;}
+
+		/*!
+		 *  \brief  View of an 8-bit image
+		 *
+		 *  \return Eigen::Map<const image8u> The pixels, empty if nothing is mapped or the file is 16-bit
+		 */
+		Eigen::Map<const image8u> image8() const;
+
+		/*!
+		 *  \brief  View of a 16-bit image in native byte order
+		 *
+		 *  \return Eigen::Map<const image16u> The pixels, empty if nothing is mapped or the file is 8-bit
+		 */
+		Eigen::Map<const image16u> image16() const;
+
+		/* ====================  MUTATORS      ======================================= */
+
+		/*!
+		 *  \brief  Map a file, unmapping any file mapped before
+		 *
+		 *  \param  fN const char* The file path
+		 *
+		 *  \return bool True if the file is a valid P5 PGM and was mapped
+		 */
+		bool open(const char* fN);
+
+		/*!
+		 *  \brief  Unmap the file
+		 */
+		void close();
+
+		/* ====================  OPERATORS     ======================================= */
+
+		/*!
+		 *  \brief  Parse a P5 header
+		 *
+		 *  \param[in]  buf const uint8_t* Start of the file
+		 *  \param  size size_t Bytes available
+		 *  \param[out] cols int Number of cols
+		 *  \param[out] rows int Number of rows
+		 *  \param[out] max int Maximum grey value
+		 *  \param[out] offset size_t Offset of the pixel data
+		 *
+		 *  \return bool True if the header is complete and valid
+		 *
+		 *  Fields may be separated by any whitespace, and comments from '#' to the end
+		 *  of the line may appear between any of them. A single whitespace character
+		 *  follows the maximum grey value.
+		 */
+		static bool parseHeader(const uint8_t *buf, size_t size, int &cols, int &rows, int &max, size_t &offset);
+
+	protected:
+		/* ====================  METHODS       ======================================= */
+
+		/* ====================  DATA MEMBERS  ======================================= */
+
+	private:
+		/* ====================  METHODS       ======================================= */
+
+		//Not copyable, the mapping is owned
+		pgmMap ( const pgmMap &other );
+		pgmMap& operator = ( const pgmMap &other );
+
+		/* ====================  DATA MEMBERS  ======================================= */
+		int m_fd; /**< Open file, kept for the life of the mapping */
+		void *m_map; /**< Start of the mapping */
+		size_t m_mapSize; /**< Length of the mapping */
+		const uint8_t *m_pixels; /**< Start of the pixel data in the mapping */
+		int m_rows; /**< Rows of the image */
+		int m_cols; /**< Cols of the image */
+		int m_max; /**< Maximum grey value */
+
+}; /* -----  end of class pgmMap  ----- */
+
+} // End namespace fpTools
+
+#endif //PGMMAP_H
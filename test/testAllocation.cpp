@@ -0,0 +1,198 @@
+/*!
+ *    \file  testAllocation.cpp
+ *   \brief  Test that the workspace paths do not allocate once warmed up
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ */
+
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+//Eigen
+#include <Eigen/Core>
+
+//fpTools
+#include <fpTools_utility/imageTypes.h>
+#include <fpTools_utility/bitImage.h>
+#include <fpTools/lineRegistration.h>
+#include <fpTools/minutiaeExtraction.h>
+#include <fpTools/orientationField.h>
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void *ptr, size_t size);
+
+static bool counting = false; /**< Count the allocations made */
+static long allocations = 0; /**< Allocations counted */
+
+//Count every allocation, Eigen and the STL both end up here
+extern "C" void* malloc(size_t size)
+{
+	if( counting ) allocations++;
+	return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+	if( counting ) allocations++;
+	return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void *ptr, size_t size)
+{
+	if( counting ) allocations++;
+	return __libc_realloc(ptr, size);
+}
+#endif
+
+/*!
+ *  \brief  Rings of ridges around two centres, so some ridges end and split where they meet
+ *
+ *  \param[out] image fpTools::image8u The print, resized to rows x cols
+ *  \param  rows int Rows of the print
+ *  \param  cols int Columns of the print
+ */
+static void syntheticPrint(fpTools::image8u &image, int rows, int cols)
+{
+	image.resize(rows, cols);
+	for(int r = 0; r < rows; r++)
+	{
+		for(int c = 0; c < cols; c++)
+		{
+			double first = std::sqrt((r - 0.4*rows)*(r - 0.4*rows) + (c - 0.5*cols)*(c - 0.5*cols));
+			double second = std::sqrt((r - 0.8*rows)*(r - 0.8*rows) + (c - 0.3*cols)*(c - 0.3*cols));
+			double ridge = (first < 0.75*second) ? std::sin(first/1.4) : std::sin(second/1.6);
+			image(r, c) = static_cast<uint8_t>(128 + 100*ridge);
+		}
+	}
+}
+
+/*!
+ *  \brief  Check that a step allocated nothing, and report it
+ *
+ *  \param  name const char* The step
+ *  \param  counted long Allocations made by the step
+ *
+ *  \return bool True if nothing was allocated
+ */
+static bool report(const char *name, long counted)
+{
+	std::printf("%s: %ld allocations\n", name, counted);
+	return counted == 0;
+}
+
+/*!
+ *  \brief  Run each workspace path until warmed up, then count what it allocates
+ */
+int main()
+{
+#ifndef __GLIBC__
+	std::printf("Allocations can only be counted with glibc\n");
+	return 77;
+#else
+	const int lengthOfScan = 16;
+	const int lines = 36;
+	const int width = 400;
+
+	//Overlapping scanlines of a print, each drifting a little in X
+	fpTools::image8u print;
+	syntheticPrint(print, lines*lengthOfScan, width + 8);
+	fpTools::image8u stacked(lines*lengthOfScan, width);
+	for(int k = 0; k < lines; k++)
+	{
+		int row = k*(lengthOfScan - 3);
+		stacked.block(k*lengthOfScan, 0, lengthOfScan, width) = print.block(row, (k*3) % 7, lengthOfScan, width);
+	}
+
+	//Threads are started per call, so only one thread runs without allocating
+	fpTools::lineRegistration registration(lengthOfScan);
+	registration.setNumThreads(1);
+	fpTools::lineRegistration::workspace registrationWork;
+	fpTools::registeredImage8u view;
+	fpTools::image8u registered;
+
+	fpTools::minutiaeExtraction extraction;
+	extraction.setNumThreads(1);
+	fpTools::minutiaeExtraction::workspace extractionWork;
+	fpTools::bitImage ridges;
+	fpTools::minutiaeSet minutiae;
+	fpTools::image8u skeleton;
+
+	fpTools::orientationField field;
+	field.setNumThreads(1);
+
+	bool passed = true;
+	const fpTools::thresholdMethod methods[2] = {fpTools::THRESH_OTSU, fpTools::THRESH_SAUVOLA};
+	for(int m = 0; m < 2; m++)
+	{
+		extraction.setThresholdMethod(methods[m]);
+		for(int pass = 0; pass < 3; pass++)
+		{
+			//The first pass sizes every buffer
+			bool warm = (pass > 0);
+
+			allocations = 0;
+			counting = warm;
+			bool registeredWell = registration.registerLines(stacked, view, registrationWork);
+			view.materialize(registered);
+			counting = false;
+			long registerCount = allocations;
+			if( !registeredWell )
+			{
+				std::printf("Registration failed\n");
+				return EXIT_FAILURE;
+			}
+
+			allocations = 0;
+			counting = warm;
+			extraction.binarize(registered, ridges, extractionWork);
+			counting = false;
+			long binarizeCount = allocations;
+
+			allocations = 0;
+			counting = warm;
+			ridges.close(2);
+			counting = false;
+			long morphologyCount = allocations;
+
+			allocations = 0;
+			counting = warm;
+			bool computed = field.compute(registered);
+			counting = false;
+			long fieldCount = allocations;
+			if( !computed )
+			{
+				std::printf("Orientation field failed\n");
+				return EXIT_FAILURE;
+			}
+
+			skeleton = registered;
+			allocations = 0;
+			counting = warm;
+			extraction.extractMinutiae(skeleton, minutiae, extractionWork);
+			counting = false;
+			long extractCount = allocations;
+
+			if( warm )
+			{
+				std::printf("Threshold method %d, pass %d, %d minutiae\n", m, pass, minutiae.size());
+				passed &= report("  registerLines and materialize", registerCount);
+				passed &= report("  binarize", binarizeCount);
+				passed &= report("  close", morphologyCount);
+				passed &= report("  orientation field", fieldCount);
+				passed &= report("  extractMinutiae", extractCount);
+			}
+		}
+	}
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+#endif
+}
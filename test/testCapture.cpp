@@ -0,0 +1,326 @@
+/*!
+ *    \file  testCapture.cpp
+ *   \brief  Test the capture codec, and the container reader and writer
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ */
+
+//STL
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+//fpTools
+#include <fpTools_utility/imageTypes.h>
+#include <fpTools_utility/captureFormat.h>
+#include <fpTools_utility/captureCodec.h>
+#include <fpTools_utility/captureReader.h>
+#include <fpTools_utility/captureWriter.h>
+
+/*!
+ *  \brief  Report a check that failed
+ *
+ *  \param  ok bool The check
+ *  \param  what const char* What was checked
+ *
+ *  \return bool The check
+ */
+static bool check(bool ok, const char *what)
+{
+	if( !ok ) std::printf("FAILED: %s\n", what);
+	return ok;
+}
+
+/*!
+ *  \brief  Read a whole file
+ */
+static std::string readFile(const char *fN)
+{
+	std::ifstream in(fN, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/*!
+ *  \brief  Write a whole file
+ */
+static void writeFile(const char *fN, const std::string &data)
+{
+	std::ofstream out(fN, std::ios::binary | std::ios::trunc);
+	out.write(data.data(), data.size());
+}
+
+/*!
+ *  \brief  A container whose trailer is changed must not open
+ *
+ *  \param  good std::string A valid container
+ *  \param  field size_t Offset of the field in the trailer
+ *  \param  value uint64_t The value written over it
+ *
+ *  \return bool True if the reader rejected the file
+ */
+static bool rejectsTrailer(const std::string &good, size_t field, uint64_t value)
+{
+	const char *path = "testCapture_corrupt.fpc";
+	std::string bad = good;
+	std::memcpy(&bad[bad.size() - sizeof(fpTools::captureFileTrailer) + field], &value, sizeof(value));
+	writeFile(path, bad);
+
+	fpTools::captureReader reader(path);
+	bool rejected = !reader.isOpen();
+	std::remove(path);
+	return rejected;
+}
+
+/*!
+ *  \brief  Check that corrupt trailers are rejected
+ */
+static bool testCorruptTrailer()
+{
+	const char *path = "testCapture_trailer.fpc";
+	fpTools::image8u image(4*8, 24);
+	for(int r = 0; r < image.rows(); r++)
+		for(int c = 0; c < image.cols(); c++) image(r, c) = static_cast<uint8_t>(r*7 + c);
+
+	fpTools::captureWriter writer(path);
+	bool ok = check(writer.addCapture(image, 8) && writer.close(), "write container");
+	std::string good = readFile(path);
+	std::remove(path);
+	if( !ok ) return false;
+
+	fpTools::captureFileTrailer trailer;
+	std::memcpy(&trailer, &good[good.size() - sizeof(trailer)], sizeof(trailer));
+	ok &= check(trailer.numCaptures == 1 && trailer.numChunks == 4, "trailer counts");
+
+	//Counts so large the size of the index wraps around to the right total
+	uint64_t wrap = static_cast<uint64_t>(1) << 60;
+	ok &= check(rejectsTrailer(good, offsetof(fpTools::captureFileTrailer, numChunks), trailer.numChunks + wrap),
+			"wrapped chunk count rejected");
+	ok &= check(rejectsTrailer(good, offsetof(fpTools::captureFileTrailer, numCaptures), trailer.numCaptures + wrap),
+			"wrapped capture count rejected");
+	ok &= check(rejectsTrailer(good, offsetof(fpTools::captureFileTrailer, numChunks), trailer.numChunks + 1),
+			"short index rejected");
+	ok &= check(rejectsTrailer(good, offsetof(fpTools::captureFileTrailer, indexOffset), trailer.indexOffset + 4),
+			"unaligned index rejected");
+
+	return ok;
+}
+
+/*!
+ *  \brief  Pixels whose differences to the previous pixel are the given bytes, as the codec codes them
+ *
+ *  \param[in]  deltas std::vector<uint8_t> Differences, the first to 0
+ *  \param[out] pixels std::vector<uint8_t> The pixels
+ */
+static void fromDeltas(const std::vector<uint8_t> &deltas, std::vector<uint8_t> &pixels)
+{
+	pixels.resize(deltas.size());
+	uint8_t prev = 0;
+	for(size_t k = 0; k < deltas.size(); k++)
+	{
+		prev = static_cast<uint8_t>(prev + deltas[k]);
+		pixels[k] = prev;
+	}
+}
+
+/*!
+ *  \brief  Encode and decode 8-bit pixels
+ *
+ *  \param[in]  pixels std::vector<uint8_t> The pixels
+ *  \param  what const char* The case
+ *
+ *  \return bool True if the pixels decode as they were, and not from a truncated chunk
+ */
+static bool roundTrip(const std::vector<uint8_t> &pixels, const char *what)
+{
+	std::vector<uint8_t> coded;
+	fpTools::encodeChunk(pixels.data(), pixels.size(), coded);
+
+	std::vector<uint8_t> decoded(pixels.size(), 0);
+	bool ok = fpTools::decodeChunk(coded.data(), coded.size(), decoded.data(), decoded.size()) && decoded == pixels;
+	if( !coded.empty() ) ok &= !fpTools::decodeChunk(coded.data(), coded.size() - 1, decoded.data(), decoded.size());
+	return check(ok, what);
+}
+
+/*!
+ *  \brief  Encode and decode 16-bit pixels
+ *
+ *  \param[in]  pixels std::vector<uint16_t> The pixels
+ *  \param  what const char* The case
+ *
+ *  \return bool True if the pixels decode as they were, and not from a truncated chunk
+ */
+static bool roundTrip(const std::vector<uint16_t> &pixels, const char *what)
+{
+	std::vector<uint8_t> coded;
+	fpTools::encodeChunk(pixels.data(), pixels.size(), coded);
+
+	std::vector<uint16_t> decoded(pixels.size(), 0);
+	bool ok = fpTools::decodeChunk(coded.data(), coded.size(), decoded.data(), decoded.size()) && decoded == pixels;
+	if( !coded.empty() ) ok &= !fpTools::decodeChunk(coded.data(), coded.size() - 1, decoded.data(), decoded.size());
+	return check(ok, what);
+}
+
+/*!
+ *  \brief  Check runs and literals at and around their longest, and the boundaries between them
+ *
+ *  \param  rng std::mt19937 Random numbers for the literals
+ */
+static bool testCodec(std::mt19937 &rng)
+{
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::vector<uint8_t> deltas, pixels;
+	bool ok = true;
+
+	ok &= roundTrip(std::vector<uint8_t>(), "empty chunk");
+
+	//Runs either side of the shortest coded run and the longest run
+	const size_t runs[10] = {1, 2, 3, 4, 129, 130, 131, 132, 260, 1000};
+	for(int r = 0; r < 10; r++)
+	{
+		deltas.assign(runs[r], 7);
+		fromDeltas(deltas, pixels);
+		ok &= roundTrip(pixels, "run of differences");
+	}
+
+	//Literals either side of the longest literal, where no two neighbours match
+	const size_t literals[6] = {1, 127, 128, 129, 256, 257};
+	for(int l = 0; l < 6; l++)
+	{
+		deltas.resize(literals[l]);
+		for(size_t k = 0; k < deltas.size(); k++) deltas[k] = static_cast<uint8_t>(k % 2 ? 1 + k % 200 : 201 + k % 50);
+		fromDeltas(deltas, pixels);
+		ok &= roundTrip(pixels, "literal differences");
+	}
+
+	//Literals broken by runs of 2, which stay literal, and of 3, which do not
+	for(int length = 2; length <= 3; length++)
+	{
+		deltas.clear();
+		for(int k = 0; k < 300; k++)
+		{
+			deltas.push_back(static_cast<uint8_t>(byte(rng)));
+			if( k % 17 == 0 ) deltas.insert(deltas.end(), length, static_cast<uint8_t>(byte(rng)));
+		}
+		fromDeltas(deltas, pixels);
+		ok &= roundTrip(pixels, "runs between literals");
+	}
+
+	//Noise, a flat background and a mix of both
+	pixels.resize(4000);
+	for(size_t k = 0; k < pixels.size(); k++) pixels[k] = static_cast<uint8_t>(byte(rng));
+	ok &= roundTrip(pixels, "noise");
+	for(size_t k = 1000; k < 3000; k++) pixels[k] = 255;
+	ok &= roundTrip(pixels, "noise around a flat background");
+
+	//16-bit, whose high bytes form a plane of their own
+	std::uniform_int_distribution<int> word(0, 65535);
+	std::vector<uint16_t> wide(3000);
+	for(size_t k = 0; k < wide.size(); k++) wide[k] = static_cast<uint16_t>(word(rng));
+	ok &= roundTrip(wide, "16-bit noise");
+	for(size_t k = 0; k < wide.size(); k++) wide[k] = static_cast<uint16_t>(k*37);
+	ok &= roundTrip(wide, "16-bit ramp across the high byte");
+	for(size_t k = 0; k < wide.size(); k++) wide[k] = static_cast<uint16_t>(4000 + byte(rng)/16);
+	ok &= roundTrip(wide, "16-bit values in one high byte");
+	for(size_t k = 0; k < wide.size(); k++) wide[k] = static_cast<uint16_t>((k % 400 < 200) ? 65535 : 0);
+	ok &= roundTrip(wide, "16-bit steps between the extremes");
+
+	return ok;
+}
+
+/*!
+ *  \brief  Captures written by the writer must read back as they were
+ *
+ *  \param  rng std::mt19937 Random numbers for the captures
+ */
+static bool testContainer(std::mt19937 &rng)
+{
+	const char *path = "testCapture_container.fpc";
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::uniform_int_distribution<int> word(0, 65535);
+
+	//Scanlines of noise, which stay raw, and of a flat background, which are coded
+	fpTools::image8u noisy(5*8, 37);
+	for(int k = 0; k < noisy.size(); k++) noisy.data()[k] = static_cast<uint8_t>(byte(rng));
+	noisy.block(16, 0, 16, 37).setConstant(200);
+	fpTools::image16u deep(3*12, 29);
+	for(int k = 0; k < deep.size(); k++) deep.data()[k] = static_cast<uint16_t>(word(rng));
+	deep.block(12, 0, 12, 29).setConstant(1024);
+
+	//Added a scanline at a time, and without compression
+	fpTools::captureWriter writer(path);
+	bool ok = check(writer.addCapture(noisy, 8) && writer.addCapture(deep, 12), "write captures");
+	ok &= check(writer.beginCapture(4, 37, 8), "begin capture");
+	for(int line = 0; line < 3; line++)
+	{
+		fpTools::image8u scan = noisy.block(4*line, 0, 4, 37);
+		ok &= check(writer.addScanline(scan), "add scanline");
+	}
+	ok &= check(writer.close(), "close writer");
+
+	fpTools::captureWriter rawWriter("testCapture_raw.fpc", false);
+	ok &= check(rawWriter.addCapture(deep, 12) && rawWriter.close(), "write uncompressed capture");
+
+	fpTools::captureReader reader(path);
+	ok &= check(reader.isOpen() && reader.numCaptures() == 3, "open container");
+	if( !ok )
+	{
+		std::remove(path);
+		std::remove("testCapture_raw.fpc");
+		return false;
+	}
+
+	const fpTools::captureEntry &entry = reader.getCapture(1);
+	ok &= check(entry.lengthOfScan == 12 && entry.cols == 29 && entry.scanLines == 3 && entry.bitDepth == 16, "capture entry");
+	ok &= check(reader.getChunk(0, 0).codec == fpTools::CODEC_RAW, "noise stays raw");
+	ok &= check(reader.getChunk(0, 2).codec == fpTools::CODEC_DELTA_RLE, "flat background is coded");
+
+	for(int threads = 1; threads <= 3; threads += 2)
+	{
+		fpTools::image8u read8;
+		fpTools::image16u read16;
+		ok &= check(reader.readCapture(0, read8, threads) && read8 == noisy, "8-bit capture");
+		ok &= check(reader.readCapture(0, read16, threads) && read16 == noisy.cast<uint16_t>(), "8-bit capture widened");
+		ok &= check(!reader.readCapture(1, read8, threads), "16-bit capture refused as 8-bit");
+		ok &= check(reader.readCapture(1, read16, threads) && read16 == deep, "16-bit capture");
+		ok &= check(reader.readCapture(2, read8, threads) && read8 == noisy.topRows(12), "capture added by scanline");
+	}
+
+	fpTools::image16u scan;
+	ok &= check(reader.readScanline(1, 2, scan) && scan == deep.bottomRows(12), "16-bit scanline");
+
+	fpTools::captureReader rawReader("testCapture_raw.fpc");
+	fpTools::image16u rawDeep;
+	ok &= check(rawReader.isOpen() && rawReader.getChunk(0, 1).codec == fpTools::CODEC_RAW &&
+			rawReader.readCapture(0, rawDeep) && rawDeep == deep, "uncompressed capture");
+
+	std::remove(path);
+	std::remove("testCapture_raw.fpc");
+	return ok;
+}
+
+/*!
+ *  \brief  Run every test of the capture container
+ */
+int main()
+{
+	std::mt19937 rng(13);
+
+	bool passed = true;
+	passed &= testCodec(rng);
+	passed &= testContainer(rng);
+	passed &= testCorruptTrailer();
+
+	std::printf("%s\n", passed ? "Passed" : "Failed");
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
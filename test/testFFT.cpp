@@ -0,0 +1,108 @@
+/*!
+ *    \file  testFFT.cpp
+ *   \brief  Test the 2d FFT of the workspace against Eigen::FFT
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ */
+
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <random>
+
+//Eigen
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+//fpTools
+#include <fpTools/fftWorkspace.h>
+
+/*!
+ *  \brief  Largest error allowed, relative to the largest value compared
+ */
+static const float tolerance = 1e-5f;
+
+/*!
+ *  \brief  Half spectrum of a real matrix by full complex transforms along the rows then cols
+ *
+ *  \param[in]  mat fpTools::rowMatrixXf The real matrix
+ *  \param[out] spectrum Eigen::MatrixXcf The half spectrum, rows x (cols/2 + 1)
+ */
+static void referenceForward(const fpTools::rowMatrixXf &mat, Eigen::MatrixXcf &spectrum)
+{
+	int rows = static_cast<int>(mat.rows());
+	int cols = static_cast<int>(mat.cols());
+	Eigen::FFT<float> fft;
+
+	Eigen::MatrixXcf full(rows, cols);
+	Eigen::VectorXcf in, out;
+	for(int r = 0; r < rows; r++)
+	{
+		in = mat.row(r).transpose().cast<std::complex<float> >();
+		fft.fwd(out, in);
+		full.row(r) = out.transpose();
+	}
+	for(int c = 0; c < cols; c++)
+	{
+		in = full.col(c);
+		fft.fwd(out, in);
+		full.col(c) = out;
+	}
+	spectrum = full.leftCols(cols/2 + 1);
+}
+
+/*!
+ *  \brief  Compare the workspace with the reference at one size
+ *
+ *  \param  rows int Rows, the length of the column transforms
+ *  \param  cols int Cols
+ *  \param  rng std::mt19937 Random numbers for the input
+ *
+ *  \return bool True if the forward and inverse transforms are within tolerance
+ */
+static bool testSize(int rows, int cols, std::mt19937 &rng)
+{
+	std::uniform_real_distribution<float> value(0, 255);
+	fpTools::rowMatrixXf mat(rows, cols);
+	for(int k = 0; k < mat.size(); k++) mat.data()[k] = value(rng);
+
+	fpTools::fftWorkspace workspace(rows, cols);
+	Eigen::MatrixXcf spectrum(rows, workspace.spectrumCols());
+	Eigen::MatrixXcf expected;
+	workspace.forward(mat, spectrum);
+	referenceForward(mat, expected);
+	float forwardError = (spectrum - expected).cwiseAbs().maxCoeff()/expected.cwiseAbs().maxCoeff();
+
+	//The inverse of the reference spectrum is the input again
+	Eigen::MatrixXf restored(rows, cols);
+	workspace.inverse(expected, restored);
+	float inverseError = (restored - Eigen::MatrixXf(mat)).cwiseAbs().maxCoeff()/mat.cwiseAbs().maxCoeff();
+
+	bool ok = forwardError <= tolerance && inverseError <= tolerance;
+	std::printf("%s: %d x %d, forward error %g, inverse error %g\n", ok ? "ok" : "FAILED", rows, cols,
+			forwardError, inverseError);
+	return ok;
+}
+
+/*!
+ *  \brief  Run every size with a fixed transform, and one without
+ */
+int main()
+{
+	std::mt19937 rng(17);
+	const int lengths[5] = {4, 8, 16, 32, 12};
+	const int widths[2] = {96, 50};
+
+	bool passed = true;
+	for(int l = 0; l < 5; l++)
+		for(int w = 0; w < 2; w++) passed &= testSize(lengths[l], widths[w], rng);
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,305 @@
+/*!
+ *    \file  testGallery.cpp
+ *   \brief  Test enrolling into, reopening and searching a template gallery
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ */
+
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+//POSIX
+#include <unistd.h>
+#include <sys/stat.h>
+
+//fpTools
+#include <fpTools/minutiaeSet.h>
+#include <fpTools/minutiaeMatcher.h>
+#include <fpTools/cylinderTemplate.h>
+#include <fpTools/galleryFormat.h>
+#include <fpTools/templateGallery.h>
+
+/*!
+ *  \brief  The gallery with the layout and vote counting open to the tests
+ */
+class galleryAccess : public fpTools::templateGallery
+{
+	public:
+		using fpTools::templateGallery::segmentLayout;
+		using fpTools::templateGallery::countVotes;
+};
+
+/*!
+ *  \brief  Gallery file the tests write
+ */
+static const char *galleryPath = "testGallery.fpg";
+
+/*!
+ *  \brief  Report a check that failed
+ *
+ *  \param  ok bool The check
+ *  \param  what const char* What was checked
+ *
+ *  \return bool The check
+ */
+static bool check(bool ok, const char *what)
+{
+	if( !ok ) std::printf("FAILED: %s\n", what);
+	return ok;
+}
+
+/*!
+ *  \brief  Bytes in a file
+ */
+static uint64_t fileSize(const char *fN)
+{
+	struct stat info;
+	return (stat(fN, &info) == 0) ? static_cast<uint64_t>(info.st_size) : 0;
+}
+
+/*!
+ *  \brief  Random minutiae of a print
+ *
+ *  \param[out] minutiae fpTools::minutiaeSet The minutiae
+ *  \param  rng std::mt19937 Random numbers
+ */
+static void randomPrint(fpTools::minutiaeSet &minutiae, std::mt19937 &rng)
+{
+	std::uniform_int_distribution<int> x(40, 360);
+	std::uniform_int_distribution<int> y(40, 460);
+	std::uniform_real_distribution<float> angle(-static_cast<float>(M_PI), static_cast<float>(M_PI));
+	minutiae = fpTools::minutiaeSet();
+	for(int k = 0; k < 40; k++) minutiae.add(x(rng), y(rng), angle(rng), fpTools::MINUTIA_ENDING, 100);
+}
+
+/*!
+ *  \brief  Enroll a batch of random prints
+ *
+ *  \param  gallery fpTools::templateGallery The open gallery
+ *  \param  matcher fpTools::minutiaeMatcher Encodes the prints
+ *  \param  count int Number of prints
+ *  \param  rng std::mt19937 Random numbers
+ *  \param[in,out] prints std::vector<fpTools::minutiaeSet> Every print enrolled, by id
+ *
+ *  \return bool True if the batch was enrolled
+ */
+static bool enrollBatch(fpTools::templateGallery &gallery, const fpTools::minutiaeMatcher &matcher, int count,
+		std::mt19937 &rng, std::vector<fpTools::minutiaeSet> &prints)
+{
+	std::vector<fpTools::cylinderTemplate> batch(count);
+	prints.resize(gallery.size());
+	for(int k = 0; k < count; k++)
+	{
+		fpTools::minutiaeSet minutiae;
+		randomPrint(minutiae, rng);
+		matcher.encode(minutiae, batch[k]);
+		prints.push_back(minutiae);
+	}
+	return gallery.enroll(batch);
+}
+
+/*!
+ *  \brief  Search for some of the prints, each moved by a pixel, and expect each as the best result
+ *
+ *  \param  gallery fpTools::templateGallery The open gallery
+ *  \param  matcher fpTools::minutiaeMatcher Encodes the queries and scores the candidates
+ *  \param[in]  prints std::vector<fpTools::minutiaeSet> Every print enrolled, by id
+ *
+ *  \return bool True if every print searched for is found first
+ */
+static bool findsPrints(const fpTools::templateGallery &gallery, const fpTools::minutiaeMatcher &matcher,
+		const std::vector<fpTools::minutiaeSet> &prints)
+{
+	bool ok = true;
+	std::vector<fpTools::matchResult> results;
+	for(size_t id = 0; id < prints.size(); id += 7)
+	{
+		const fpTools::minutiaeSet &print = prints[id];
+		fpTools::minutiaeSet moved;
+		for(int k = 0; k < print.size(); k++)
+		{
+			moved.add(print.x()[k] + 1, print.y()[k], print.angle()[k], fpTools::MINUTIA_ENDING, 100);
+		}
+
+		fpTools::cylinderTemplate query;
+		matcher.encode(moved, query);
+		gallery.search(matcher, query, 3, results);
+		ok &= !results.empty() && results[0].id == static_cast<int>(id);
+	}
+	return ok;
+}
+
+/*!
+ *  \brief  Enroll in two batches, reopen and search, then tear the last segment and enroll again
+ *
+ *  \param  rng std::mt19937 Random numbers
+ */
+static bool testEnroll(std::mt19937 &rng)
+{
+	fpTools::minutiaeMatcher matcher;
+	std::vector<fpTools::minutiaeSet> prints;
+	bool ok = true;
+
+	{
+		fpTools::templateGallery gallery;
+		ok &= check(gallery.create(galleryPath, matcher.getRadius()), "create gallery");
+		ok &= check(enrollBatch(gallery, matcher, 40, rng, prints), "enroll first batch");
+	}
+	uint64_t firstSize = fileSize(galleryPath);
+	{
+		fpTools::templateGallery gallery(galleryPath);
+		ok &= check(enrollBatch(gallery, matcher, 30, rng, prints), "enroll second batch");
+	}
+	if( !ok ) return false;
+
+	//Reopened, the file is searched where it sits
+	fpTools::templateGallery gallery(galleryPath);
+	ok &= check(gallery.isOpen() && gallery.size() == 70 && gallery.numSegments() == 2, "reopen gallery");
+	ok &= check(findsPrints(gallery, matcher, prints), "search reopened gallery");
+	gallery.close();
+
+	//A second segment cut short, as by a crash, is ignored
+	uint64_t fullSize = fileSize(galleryPath);
+	ok &= check(truncate(galleryPath, static_cast<off_t>(firstSize + (fullSize - firstSize)/2)) == 0, "tear segment");
+	gallery.open(galleryPath);
+	ok &= check(gallery.isOpen() && gallery.size() == 40 && gallery.numSegments() == 1, "torn segment ignored");
+	prints.resize(40);
+	ok &= check(findsPrints(gallery, matcher, prints), "search without torn segment");
+
+	//And cut off by the next enrollment, whose segment follows the first
+	ok &= check(enrollBatch(gallery, matcher, 20, rng, prints), "enroll after torn segment");
+	gallery.open(galleryPath);
+	ok &= check(gallery.isOpen() && gallery.size() == 60 && gallery.numSegments() == 2, "torn segment replaced");
+	ok &= check(findsPrints(gallery, matcher, prints), "search after torn segment");
+
+	return ok;
+}
+
+/*!
+ *  \brief  A segment whose offsets leave its arrays must not be searched
+ *
+ *  \param  array int Array of the segment, as ordered by segmentLayout
+ *  \param  entry size_t Byte offset into the array
+ *  \param  value uint32_t The value written there
+ *
+ *  \return bool True if the segment was rejected
+ */
+static bool rejectsSegment(int array, size_t entry, uint32_t value)
+{
+	std::ifstream in(galleryPath, std::ios::binary);
+	std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	in.close();
+
+	//The first segment follows the file header
+	size_t offset = sizeof(fpTools::galleryFileHeader);
+	fpTools::gallerySegmentHeader header;
+	std::memcpy(&header, &file[offset], sizeof(header));
+	size_t starts[8];
+	galleryAccess::segmentLayout(header, starts);
+	std::memcpy(&file[offset + starts[array] + entry], &value, sizeof(value));
+
+	const char *path = "testGallery_corrupt.fpg";
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out.write(file.data(), file.size());
+	out.close();
+
+	fpTools::templateGallery gallery(path);
+	bool rejected = gallery.isOpen() && gallery.numSegments() == 0 && gallery.size() == 0;
+	std::remove(path);
+	return rejected;
+}
+
+/*!
+ *  \brief  Check that segments with out-of-range offsets are rejected
+ */
+static bool testCorruptSegment()
+{
+	fpTools::templateGallery gallery(galleryPath);
+	bool ok = check(gallery.isOpen() && gallery.numSegments() > 0, "open gallery");
+	gallery.close();
+	if( !ok ) return false;
+
+	//A key of a template past the end of the segment
+	ok &= check(rejectsSegment(6, offsetof(fpTools::galleryKey, index), 40), "key index past the templates rejected");
+	ok &= check(rejectsSegment(6, sizeof(fpTools::galleryKey) + offsetof(fpTools::galleryKey, index), 0xFFFFFFFFu),
+			"huge key index rejected");
+
+	//Cylinder starts out of order, and a directory past the keys
+	ok &= check(rejectsSegment(0, 4*sizeof(uint32_t), 0xFFFFFFu), "cylinder starts out of order rejected");
+	ok &= check(rejectsSegment(7, 0, 1), "directory not starting at 0 rejected");
+	ok &= check(rejectsSegment(7, sizeof(uint32_t), 0xFFFFFFu), "directory past the keys rejected");
+
+	return ok;
+}
+
+/*!
+ *  \brief  Counting votes over sorted hits and in an array must give the same votes
+ *
+ *  \param  rng std::mt19937 Random numbers for the hits
+ */
+static bool testVotes(std::mt19937 &rng)
+{
+	const uint64_t numTemplates = 5000;
+	std::uniform_int_distribution<uint32_t> id(0, numTemplates - 1);
+
+	//Mostly scattered hits, and one template with more than a uint16_t can count
+	std::vector<uint32_t> found;
+	for(int k = 0; k < 20000; k++) found.push_back(id(rng));
+	found.insert(found.end(), 70000, 1234);
+	std::shuffle(found.begin(), found.end(), rng);
+	int most = static_cast<int>(std::count(found.begin(), found.end(), 1234u));
+
+	std::vector<uint32_t> sparseFound = found;
+	std::vector<std::pair<int, uint32_t> > sparse, dense;
+	galleryAccess::countVotes(sparseFound, numTemplates, true, sparse);
+	galleryAccess::countVotes(found, numTemplates, false, dense);
+
+	std::sort(sparse.begin(), sparse.end());
+	std::sort(dense.begin(), dense.end());
+	bool ok = check(sparse == dense, "sparse and dense votes agree");
+	ok &= check(!dense.empty() && dense[0].first == -most && dense[0].second == 1234u, "most votes counted in full");
+
+	//The shortlist taken from either is the same
+	std::vector<std::pair<int, uint32_t> > sparseShort = sparse, denseShort = dense;
+	std::nth_element(sparseShort.begin(), sparseShort.begin() + 100, sparseShort.end());
+	std::nth_element(denseShort.begin(), denseShort.begin() + 100, denseShort.end());
+	sparseShort.resize(100);
+	denseShort.resize(100);
+	std::sort(sparseShort.begin(), sparseShort.end());
+	std::sort(denseShort.begin(), denseShort.end());
+	ok &= check(sparseShort == denseShort, "sparse and dense shortlists agree");
+
+	return ok;
+}
+
+/*!
+ *  \brief  Run every gallery test
+ */
+int main()
+{
+	std::mt19937 rng(19);
+
+	bool passed = true;
+	passed &= testEnroll(rng);
+	passed &= testCorruptSegment();
+	passed &= testVotes(rng);
+	std::remove(galleryPath);
+
+	std::printf("%s\n", passed ? "Passed" : "Failed");
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+/*!
+ *    \file  testHistogram.cpp
+ *   \brief  Test the threaded histogram and binarizing out-of-range MatrixXi values
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ */
+
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <random>
+
+//Eigen
+#include <Eigen/Core>
+
+//fpTools
+#include <fpTools_utility/imageTypes.h>
+#include <fpTools/minutiaeExtraction.h>
+
+/*!
+ *  \brief  The histogram on several threads must be the one counted a pixel at a time
+ *
+ *  \param  rng std::mt19937 Random numbers for the image
+ *
+ *  \return bool True if every thread count gives the serial histogram
+ */
+static bool testParallelHistogram(std::mt19937 &rng)
+{
+	//Rows that do not split evenly over the threads
+	std::uniform_int_distribution<int> value(0, 255);
+	fpTools::image8u image(101, 67);
+	for(int k = 0; k < image.size(); k++) image.data()[k] = static_cast<uint8_t>(value(rng));
+
+	std::vector<int> serial(256, 0);
+	for(int k = 0; k < image.size(); k++) serial[image.data()[k]]++;
+
+	bool ok = true;
+	const int threads[4] = {1, 2, 3, 8};
+	for(int t = 0; t < 4; t++)
+	{
+		fpTools::minutiaeExtraction extraction;
+		extraction.setNumThreads(threads[t]);
+
+		//Added to what the histogram already holds
+		std::vector<int> histogram(256, 1);
+		extraction.accumulateHistogram(image, histogram);
+		for(int b = 0; b < 256; b++) histogram[b]--;
+
+		bool same = (histogram == serial);
+		std::printf("%s: histogram on %d threads\n", same ? "ok" : "FAILED", threads[t]);
+		ok &= same;
+	}
+	return ok;
+}
+
+/*!
+ *  \brief  Values below 0 and above 255 binarize as if saturated to 8 bits
+ *
+ *  \param  rng std::mt19937 Random numbers for the image
+ *
+ *  \return bool True for every method and thread count
+ */
+static bool testOutOfRange(std::mt19937 &rng)
+{
+	//Mostly 8-bit values, with negative and 16-bit ones mixed in
+	std::uniform_int_distribution<int> value(0, 255);
+	std::uniform_int_distribution<int> wide(-70000, 70000);
+	Eigen::MatrixXi image(96, 83);
+	for(int k = 0; k < image.size(); k++) image.data()[k] = (k % 5 == 0) ? wide(rng) : value(rng);
+
+	fpTools::image8u saturated = image.cwiseMax(0).cwiseMin(255).cast<uint8_t>();
+
+	bool ok = true;
+	const fpTools::thresholdMethod methods[2] = {fpTools::THRESH_OTSU, fpTools::THRESH_SAUVOLA};
+	const int threads[2] = {1, 4};
+	for(int m = 0; m < 2; m++)
+	{
+		for(int t = 0; t < 2; t++)
+		{
+			fpTools::minutiaeExtraction extraction;
+			extraction.setThresholdMethod(methods[m]);
+			extraction.setNumThreads(threads[t]);
+
+			Eigen::MatrixXi binary = image;
+			extraction.binarize(binary);
+			fpTools::image8u expected = saturated;
+			extraction.binarize(expected);
+
+			bool same = (binary == expected.cast<int>());
+			std::printf("%s: out-of-range values, method %d on %d threads\n", same ? "ok" : "FAILED", m, threads[t]);
+			ok &= same;
+		}
+	}
+	return ok;
+}
+
+/*!
+ *  \brief  Run every histogram test
+ */
+int main()
+{
+	std::mt19937 rng(3);
+
+	bool passed = true;
+	passed &= testParallelHistogram(rng);
+	passed &= testOutOfRange(rng);
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
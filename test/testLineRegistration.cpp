@@ -0,0 +1,284 @@
+/*!
+ *    \file  testLineRegistration.cpp
+ *   \brief  Test the shifts found between scanlines by each engine
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ */
+
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <random>
+
+//Eigen
+#include <Eigen/Core>
+
+//fpTools
+#include <fpTools_utility/imageTypes.h>
+#include <fpTools/lineRegistration.h>
+
+/*!
+ *  \brief  Rows per scanline
+ */
+static const int lengthOfScan = 16;
+
+/*!
+ *  \brief  Smooth random texture, so every shift has one clear best match
+ *
+ *  \param[out] texture Eigen::MatrixXf The texture, 0 to 255
+ *  \param  rows int Rows
+ *  \param  cols int Cols
+ *  \param  rng std::mt19937 Random numbers
+ */
+static void randomTexture(Eigen::MatrixXf &texture, int rows, int cols, std::mt19937 &rng)
+{
+	std::uniform_real_distribution<float> value(0, 1);
+	Eigen::MatrixXf noise(rows, cols);
+	for(int k = 0; k < noise.size(); k++) noise.data()[k] = value(rng);
+
+	//Blur by a 3 x 3 box twice
+	texture = noise;
+	for(int pass = 0; pass < 2; pass++)
+	{
+		for(int r = 1; r + 1 < rows; r++)
+			for(int c = 1; c + 1 < cols; c++) texture(r, c) = noise.block(r - 1, c - 1, 3, 3).sum()/9;
+		noise = texture;
+	}
+
+	float low = texture.minCoeff();
+	float high = texture.maxCoeff();
+	texture = (texture.array() - low)*(255/(high - low));
+}
+
+/*!
+ *  \brief  Stack scanlines cut from a texture, each moved from the one before by a known shift
+ *
+ *  \param[in]  texture Eigen::MatrixXf The texture
+ *  \param  steps std::vector<Eigen::Vector2i> Move of each scanline from the one before, x then y
+ *  \param  cols int Cols of each scanline
+ *  \param[out] stacked image8u The stacked scanlines
+ */
+static void stackScanlines(const Eigen::MatrixXf &texture, const std::vector<Eigen::Vector2i> &steps, int cols,
+		fpTools::image8u &stacked)
+{
+	//Start where no step can leave the texture
+	int x = static_cast<int>(texture.cols() - cols)/2;
+	int y = static_cast<int>(texture.rows() - lengthOfScan)/2;
+	stacked.resize((steps.size() + 1)*lengthOfScan, cols);
+	for(size_t k = 0; k <= steps.size(); k++)
+	{
+		if( k > 0 )
+		{
+			x += steps[k-1](0);
+			y += steps[k-1](1);
+		}
+		stacked.block(k*lengthOfScan, 0, lengthOfScan, cols) =
+			texture.block(y, x, lengthOfScan, cols).array().round().cast<uint8_t>();
+	}
+}
+
+/*!
+ *  \brief  Shifts of stacked scanlines by one engine
+ *
+ *  \param[in]  stacked image8u The scanlines
+ *  \param  engine fpTools::registrationEngine The engine
+ *  \param  maxShift int Largest shift in X
+ *  \param  numThreads int Threads
+ *  \param[out] shifts std::vector<fpTools::lineShift> The shifts found
+ *
+ *  \return bool True if the registration succeeded
+ */
+static bool findShifts(const fpTools::image8u &stacked, fpTools::registrationEngine engine, int maxShift,
+		int numThreads, std::vector<fpTools::lineShift> &shifts)
+{
+	fpTools::lineRegistration registration(lengthOfScan);
+	registration.setEngine(engine);
+	registration.setMaxShift(maxShift);
+	registration.setPyramidLevels(0);
+	registration.setNumThreads(numThreads);
+
+	fpTools::registeredImage8u view;
+	if( !registration.registerLines(stacked, view) ) return false;
+	shifts = registration.getShifts();
+	return true;
+}
+
+/*!
+ *  \brief  The direct and FFT engines must find the same integer shifts, up to the largest allowed
+ *
+ *  \param  rng std::mt19937 Random numbers for the texture
+ *  \param  maxShift int Largest shift in X, at least 12
+ *
+ *  \return bool True if both find every step
+ */
+static bool testEngines(std::mt19937 &rng, int maxShift)
+{
+	const int cols = 160;
+
+	//Steps in X out to 12 each way. Steps in Y stay clear of half a scanline,
+	//where the circular correlation of the FFT cannot tell a step up from a step down
+	const int stepX[12] = {0, 3, -5, 11, -11, 12, -12, 12, -1, 7, -12, 2};
+	const int stepY[12] = {6, 1, -6, 4, 0, 6, -3, 2, 5, -6, 5, 3};
+	std::vector<Eigen::Vector2i> steps;
+	for(int k = 0; k < 12; k++) steps.push_back(Eigen::Vector2i(stepX[k], stepY[k]));
+
+	Eigen::MatrixXf texture;
+	randomTexture(texture, 200, cols + 2*12*12, rng);
+	fpTools::image8u stacked;
+	stackScanlines(texture, steps, cols, stacked);
+
+	std::vector<fpTools::lineShift> direct, fft;
+	if( !findShifts(stacked, fpTools::ENGINE_DIRECT, maxShift, 1, direct) ||
+			!findShifts(stacked, fpTools::ENGINE_FFT, maxShift, 1, fft) )
+	{
+		std::printf("FAILED: registration\n");
+		return false;
+	}
+
+	bool ok = true;
+	for(size_t k = 0; k < steps.size(); k++)
+	{
+		bool same = direct[k].x == fft[k].x && direct[k].y == fft[k].y;
+		bool found = direct[k].x == steps[k](0) && direct[k].y == steps[k](1);
+		std::printf("%s: max shift %d, step (%d, %d), direct (%g, %g), fft (%g, %g)\n", (same && found) ? "ok" : "FAILED",
+				maxShift, steps[k](0), steps[k](1), direct[k].x, direct[k].y, fft[k].x, fft[k].y);
+		ok &= same && found;
+	}
+	return ok;
+}
+
+/*!
+ *  \brief  With phase correlation, refining through the pyramid must find the shifts the
+ *  		exhaustive search of the finest level does, down to the sub-pixel fit
+ *
+ *  \param  rng std::mt19937 Random numbers for the texture
+ *
+ *  \return bool True if every shift agrees
+ */
+static bool testPhasePyramid(std::mt19937 &rng)
+{
+	const int cols = 256;
+	const int stepX[8] = {0, 9, -4, 17, -20, 2, 13, -7};
+	const int stepY[8] = {3, -2, 0, 5, -6, 1, -1, 4};
+	std::vector<Eigen::Vector2i> steps;
+	for(int k = 0; k < 8; k++) steps.push_back(Eigen::Vector2i(stepX[k], stepY[k]));
+
+	Eigen::MatrixXf texture;
+	randomTexture(texture, 2*6*8 + lengthOfScan, cols + 2*20*8, rng);
+	fpTools::image8u stacked;
+	stackScanlines(texture, steps, cols, stacked);
+
+	std::vector<fpTools::lineShift> shifts[2];
+	for(int p = 0; p < 2; p++)
+	{
+		fpTools::lineRegistration registration(lengthOfScan);
+		registration.setEngine(fpTools::ENGINE_FFT);
+		registration.setMaxShift(24);
+		registration.setPhaseCorrelation(true);
+		registration.setPyramidLevels(2*p);
+
+		fpTools::registeredImage8u view;
+		if( !registration.registerLines(stacked, view) )
+		{
+			std::printf("FAILED: registration\n");
+			return false;
+		}
+		shifts[p] = registration.getShifts();
+	}
+
+	bool ok = true;
+	for(size_t k = 0; k < steps.size(); k++)
+	{
+		bool same = std::fabs(shifts[0][k].x - shifts[1][k].x) < 1e-3f && std::fabs(shifts[0][k].y - shifts[1][k].y) < 1e-3f;
+		std::printf("%s: phase step (%d, %d), exhaustive (%g, %g), pyramid (%g, %g)\n", same ? "ok" : "FAILED",
+				steps[k](0), steps[k](1), shifts[0][k].x, shifts[0][k].y, shifts[1][k].x, shifts[1][k].y);
+		ok &= same;
+	}
+	return ok;
+}
+
+/*!
+ *  \brief  Shifts on several threads must be exactly those found on one
+ *
+ *  \param  rng std::mt19937 Random numbers for the texture and the steps
+ *
+ *  \return bool True for every line count, engine and thread count
+ */
+static bool testThreads(std::mt19937 &rng)
+{
+	const int cols = 128;
+	std::uniform_int_distribution<int> stepX(-8, 8);
+	std::uniform_int_distribution<int> stepY(-6, 6);
+
+	bool ok = true;
+	const int lineCounts[3] = {7, 13, 22};
+	const fpTools::registrationEngine engines[2] = {fpTools::ENGINE_FFT, fpTools::ENGINE_DIRECT};
+	const int threads[3] = {2, 3, 5};
+	for(int n = 0; n < 3; n++)
+	{
+		std::vector<Eigen::Vector2i> steps;
+		for(int k = 1; k < lineCounts[n]; k++) steps.push_back(Eigen::Vector2i(stepX(rng), stepY(rng)));
+
+		Eigen::MatrixXf texture;
+		randomTexture(texture, 2*6*lineCounts[n] + lengthOfScan, cols + 2*8*lineCounts[n], rng);
+		fpTools::image8u stacked;
+		stackScanlines(texture, steps, cols, stacked);
+
+		for(int e = 0; e < 2; e++)
+		{
+			//Sub-pixel shifts, so any difference in the arithmetic shows
+			fpTools::lineRegistration registration(lengthOfScan);
+			registration.setEngine(engines[e]);
+			registration.setMaxShift(10);
+			registration.setPhaseCorrelation(true);
+			fpTools::registeredImage8u view;
+
+			registration.setNumThreads(1);
+			bool registered = registration.registerLines(stacked, view);
+			std::vector<fpTools::lineShift> serial = registration.getShifts();
+
+			for(int t = 0; t < 3; t++)
+			{
+				registration.setNumThreads(threads[t]);
+				registered &= registration.registerLines(stacked, view);
+				const std::vector<fpTools::lineShift> &parallel = registration.getShifts();
+
+				bool same = registered && parallel.size() == serial.size();
+				for(size_t k = 0; same && k < serial.size(); k++)
+				{
+					same = parallel[k].x == serial[k].x && parallel[k].y == serial[k].y &&
+						parallel[k].confidence == serial[k].confidence;
+				}
+				std::printf("%s: %d scanlines, engine %d, %d threads\n", same ? "ok" : "FAILED", lineCounts[n],
+						static_cast<int>(engines[e]), threads[t]);
+				ok &= same;
+			}
+		}
+	}
+	return ok;
+}
+
+/*!
+ *  \brief  Run every registration test
+ */
+int main()
+{
+	std::mt19937 rng(11);
+
+	bool passed = true;
+	passed &= testEngines(rng, 12);
+
+	//Wider than the scanlines, the direct window keeps to lags that overlap
+	passed &= testEngines(rng, 500);
+	passed &= testPhasePyramid(rng);
+	passed &= testThreads(rng);
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
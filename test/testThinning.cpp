@@ -0,0 +1,152 @@
+/*!
+ *    \file  testThinning.cpp
+ *   \brief  Test the packed thinning against a per-pixel Zhang-Suen reference
+ *
+ *  \author  David Nilosek (drn), david.nilosek@gmail.com
+ *
+ *  \internal
+ *       Created:  10/17/2026
+ *      Revision:  none
+ *      Compiler:  gcc
+ */
+
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+//fpTools
+#include <fpTools_utility/bitImage.h>
+#include <fpTools/minutiaeExtraction.h>
+
+/*!
+ *  \brief  Zhang-Suen thinning a pixel at a time, pixels outside the image are clear
+ *
+ *  \param[in,out] pixels std::vector<char> The set pixels, row by row
+ *  \param  rows int Rows
+ *  \param  cols int Cols
+ */
+static void referenceThin(std::vector<char> &pixels, int rows, int cols)
+{
+	std::vector<int> remove;
+	bool changed = true;
+	while( changed )
+	{
+		changed = false;
+		for(int step = 0; step < 2; step++)
+		{
+			remove.clear();
+			for(int r = 0; r < rows; r++)
+			{
+				for(int c = 0; c < cols; c++)
+				{
+					if( !pixels[r*cols + c] ) continue;
+
+					//Neighbours clockwise from north
+					const int dr[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+					const int dc[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+					int p[8];
+					for(int k = 0; k < 8; k++)
+					{
+						int nr = r + dr[k];
+						int nc = c + dc[k];
+						p[k] = (nr >= 0 && nc >= 0 && nr < rows && nc < cols) ? pixels[nr*cols + nc] : 0;
+					}
+
+					int set = 0;
+					int transitions = 0;
+					for(int k = 0; k < 8; k++)
+					{
+						set += p[k];
+						transitions += (!p[k] && p[(k + 1) % 8]);
+					}
+					bool side = (step == 0) ? !(p[0] && p[2] && p[4]) && !(p[2] && p[4] && p[6]) :
+						!(p[0] && p[2] && p[6]) && !(p[0] && p[4] && p[6]);
+					if( set >= 2 && set <= 6 && transitions == 1 && side ) remove.push_back(r*cols + c);
+				}
+			}
+			for(size_t k = 0; k < remove.size(); k++) pixels[remove[k]] = 0;
+			if( !remove.empty() ) changed = true;
+		}
+	}
+}
+
+/*!
+ *  \brief  Ridges of a synthetic print, rings around two centres with some noise
+ *
+ *  \param[out] pixels std::vector<char> The set pixels, row by row
+ *  \param  rows int Rows
+ *  \param  cols int Cols
+ *  \param  seed unsigned Seed of the noise
+ */
+static void syntheticRidges(std::vector<char> &pixels, int rows, int cols, unsigned seed)
+{
+	pixels.resize(static_cast<size_t>(rows)*cols);
+	for(int r = 0; r < rows; r++)
+	{
+		for(int c = 0; c < cols; c++)
+		{
+			double first = std::sqrt((r - 0.4*rows)*(r - 0.4*rows) + (c - 0.5*cols)*(c - 0.5*cols));
+			double second = std::sqrt((r - 0.8*rows)*(r - 0.8*rows) + (c - 0.2*cols)*(c - 0.2*cols));
+			double ridge = (first < 0.75*second) ? std::sin(first/2.1) : std::sin(second/2.5);
+			seed = seed*1103515245u + 12345u;
+			double noise = ((seed >> 16) & 255)/1024.0 - 0.125;
+			pixels[r*cols + c] = (ridge + noise > 0.1);
+		}
+	}
+}
+
+/*!
+ *  \brief  Thin one print with both and compare
+ *
+ *  \param  rows int Rows
+ *  \param  cols int Cols
+ *  \param  numThreads int Threads of the packed thinning
+ *
+ *  \return bool True if both thin to the same skeleton
+ */
+static bool testSize(int rows, int cols, int numThreads)
+{
+	std::vector<char> pixels;
+	syntheticRidges(pixels, rows, cols, static_cast<unsigned>(rows*cols));
+
+	fpTools::bitImage ridges(rows, cols);
+	for(int r = 0; r < rows; r++)
+		for(int c = 0; c < cols; c++) ridges.set(r, c, pixels[r*cols + c] != 0);
+
+	referenceThin(pixels, rows, cols);
+	fpTools::minutiaeExtraction extraction;
+	extraction.setNumThreads(numThreads);
+	extraction.thin(ridges);
+
+	int differ = 0;
+	int skeleton = 0;
+	for(int r = 0; r < rows; r++)
+	{
+		for(int c = 0; c < cols; c++)
+		{
+			differ += (ridges.get(r, c) != (pixels[r*cols + c] != 0));
+			skeleton += pixels[r*cols + c];
+		}
+	}
+
+	std::printf("%s: %d x %d on %d threads, %d skeleton pixels, %d differ\n", (differ == 0) ? "ok" : "FAILED",
+			rows, cols, numThreads, skeleton, differ);
+	return differ == 0;
+}
+
+/*!
+ *  \brief  Compare at widths around the word size, on one thread and several
+ */
+int main()
+{
+	const int sizes[7][2] = {{77, 1}, {77, 63}, {77, 65}, {130, 130}, {93, 200}, {301, 333}, {512, 448}};
+	const int threads[2] = {1, 4};
+
+	bool passed = true;
+	for(int s = 0; s < 7; s++)
+		for(int t = 0; t < 2; t++) passed &= testSize(sizes[s][0], sizes[s][1], threads[t]);
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}